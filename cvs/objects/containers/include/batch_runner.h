@@ -46,10 +46,12 @@
 
 #include <string>
 #include <list>
+#include <map>
 #include <memory>
 #include <xercesc/dom/DOMNode.hpp>
 #include "containers/include/iscenario_runner.h"
 class Timer;
+class BatchCSVOutputter;
 
 /*! 
  * \ingroup Objects
@@ -76,6 +78,27 @@ class Timer;
  *          "BatchMode". The name of the configuration file is determined by the
  *          file configuration value "BatchFileName".
  *
+ *          If the boolean configuration value "BatchForkScenarios" is set the
+ *          base input files are parsed only once and each scenario is run in a
+ *          forked copy of the process which only parses the file sets of that
+ *          scenario.  Up to "BatchForkLanes" (default 1) of these processes are
+ *          run concurrently, which is useful for ensembles of many scenarios
+ *          that differ only in parameters.  This is not available on Windows.
+ *          The lanes are separate processes rather than threads since the
+ *          model keeps global state, such as the global scenario pointer and
+ *          the Configuration, which can only describe one scenario at a time.
+ *          Note each lane is a complete model run: the lanes do not share a
+ *          model traversal, state values are not widened to hold one value
+ *          per lane, and each scenario solves on its own.  Evaluating an
+ *          ensemble in a single traversal with per-lane convergence would need
+ *          every STATE Value and the solvers to carry lanes and is not
+ *          supported.  The savings over separate runs are only the shared
+ *          parsing of the base inputs and the use of several cores.
+ *          Each process appends its scenario name to the output files it
+ *          writes, with the exception of the XML database and the batch CSV
+ *          file which are shared and written under a lock file kept next to
+ *          the batch CSV file.  Log files are shared by all processes.
+ *
  *          <b>XML specification for BatchRunner</b>
  *          - XML name: \c BatchRunner
  *          - Contained by: None.
@@ -178,11 +201,26 @@ protected:
     //! The current scenario runner.
     IScenarioRunner* mInternalRunner;
 
+    //! The names of scenarios running in forked processes by process id.
+    std::map<int, std::string> mRunningScenarios;
+
+    //! The name of the file locked by forked processes while writing output.
+    std::string mOutputLockFile;
+
 	BatchRunner();
 	bool runSingleScenario( IScenarioRunner* aScenarioRunner,
                             const Component& aCurrComponent,
                             const int aSinglePeriod,
-                            Timer& aTimer );
+                            Timer& aTimer,
+                            const bool aPrintOutput = true );
+
+    bool startForkedScenario( IScenarioRunner* aScenarioRunner,
+                              const Component& aCurrComponent,
+                              const int aSinglePeriod,
+                              Timer& aTimer,
+                              BatchCSVOutputter& aCSVOutputter );
+
+    bool waitForForkedScenario();
 
     bool XMLParseComponentSet( const xercesc::DOMNode* aNode );
 
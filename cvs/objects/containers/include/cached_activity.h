@@ -0,0 +1,278 @@
+#ifndef _CACHED_ACTIVITY_H_
+#define _CACHED_ACTIVITY_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+ * \file cached_activity.h
+ * \ingroup Objects
+ * \brief The CachedActivity class header file.
+ */
+
+#include <vector>
+#include <atomic>
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/enumerable_thread_specific.h>
+#endif
+
+#include "containers/include/iactivity.h"
+
+class Market;
+
+/*! 
+ * \ingroup Objects
+ * \brief A decorator around an activity which skips recalculating it when none
+ *        of its inputs have changed since it was last calculated.
+ * \details While the wrapped activity is calculated every market price, supply,
+ *          or demand it reads from the marketplace is recorded along with every
+ *          price it sets and supply or demand it adds.  On a subsequent full
+ *          (non-derivative) calculation in the same period, if every value read
+ *          is still within the configured relative tolerance of the recorded value
+ *          and none of the activities it depends on was recalculated in this call
+ *          to World::calc, the recorded writes are simply replayed into the
+ *          marketplace instead of calling the wrapped activity.  Any internal
+ *          state the activity keeps is left from the calculation which produced
+ *          the recording which is consistent with the replayed writes.
+ *
+ *          Partial derivative calculations always call through to the wrapped
+ *          activity and neither use nor update the recording.
+ *
+ *          Caching is enabled with the "activity-cache" configuration Int:
+ *              - 0 Disabled, activities are not wrapped at all.
+ *              - 1 Replay activities whose inputs did not change.
+ *              - 2 Validate, activities are always recalculated but the result
+ *                is compared against what would have been replayed and any
+ *                mismatch is reported in the main log.  This is useful to check
+ *                that an activity does not depend on values which are not read
+ *                through the marketplace.
+ *          The relative tolerance is set with the "activity-cache-tolerance"
+ *          configuration Double and defaults to zero, i.e. inputs must be unchanged.
+ *
+ * \warning Only reads and writes through Marketplace and CachedMarket are tracked.
+ *          Dependencies between activities through other means must be represented
+ *          as edges in the MarketDependencyFinder graph.
+ */
+class CachedActivity : public IActivity
+{
+public:
+    //! The caching modes which can be configured.
+    enum Mode {
+        //! Caching is disabled.
+        DISABLED = 0,
+
+        //! Replay activities whose inputs have not changed.
+        REPLAY = 1,
+
+        //! Always calculate but check against what would have been replayed.
+        VALIDATE = 2
+    };
+
+    //! The type of market value read or written by an activity.
+    enum MarketValue {
+        PRICE,
+        SUPPLY,
+        DEMAND
+    };
+
+    CachedActivity( IActivity* aActivity, const Mode aMode, const double aTolerance );
+    virtual ~CachedActivity();
+
+    // IActivity methods
+    virtual void calc( const int aPeriod );
+
+    virtual std::string getDescription() const;
+
+    void addPredecessor( const CachedActivity* aPredecessor );
+
+    static Mode getConfiguredMode();
+
+    static double getConfiguredTolerance();
+
+    static void startWorldCalc();
+
+    static void invalidateAll();
+
+    static void logStatistics( const int aPeriod );
+
+    /*!
+     * \brief Record a market value read by the activity currently being calculated.
+     * \details Does nothing unless called from within a recording activity on
+     *          this thread.
+     * \param aMarket The market which was read.
+     * \param aType Which value of the market was read.
+     * \param aValue The value which was returned to the caller.
+     */
+    static void recordRead( Market* aMarket, const MarketValue aType, const double aValue ) {
+        if( !sIsEnabled ) {
+            return;
+        }
+        Recording* recording = getActiveRecording();
+        if( recording ) {
+            recording->mReads.push_back( MarketRecord( aMarket, aType, aValue ) );
+        }
+    }
+
+    /*!
+     * \brief Record a value set or added into a market by the activity currently
+     *        being calculated.
+     * \details Does nothing unless called from within a recording activity on
+     *          this thread.
+     * \param aMarket The market which was written.
+     * \param aType Which value of the market was written.
+     * \param aValue The price set or the amount added to the supply or demand.
+     */
+    static void recordWrite( Market* aMarket, const MarketValue aType, const double aValue ) {
+        if( !sIsEnabled ) {
+            return;
+        }
+        Recording* recording = getActiveRecording();
+        if( recording ) {
+            recording->mWrites.push_back( MarketRecord( aMarket, aType, aValue ) );
+        }
+    }
+
+private:
+    //! A single market value read or written.
+    struct MarketRecord {
+        MarketRecord( Market* aMarket, const MarketValue aType, const double aValue )
+        :mMarket( aMarket ), mType( aType ), mValue( aValue ) {}
+
+        //! The market which was accessed.
+        Market* mMarket;
+
+        //! Which value of the market was accessed.
+        MarketValue mType;
+
+        //! The value read or written.
+        double mValue;
+    };
+
+    //! All of the market interactions of a single calculation of an activity.
+    struct Recording {
+        //! Market values read in the order they were read.
+        std::vector<MarketRecord> mReads;
+
+        //! Market values written in the order they were written.
+        std::vector<MarketRecord> mWrites;
+
+        void clear() {
+            mReads.clear();
+            mWrites.clear();
+        }
+    };
+
+    //! The wrapped activity which this class takes ownership of.
+    IActivity* mActivity;
+
+    //! Weak pointers to the activities which must be calculated before this one.
+    std::vector<const CachedActivity*> mPredecessors;
+
+    //! The market interactions from the last time mActivity was calculated.
+    Recording mRecording;
+
+    //! The market interactions of the current calculation used in VALIDATE mode.
+    Recording mValidateRecording;
+
+    //! If mRecording is complete and may be replayed.
+    bool mHasRecording;
+
+    //! The period mRecording was made in.
+    int mRecordedPeriod;
+
+    //! The value of sEpoch when mRecording was made.
+    unsigned int mRecordedEpoch;
+
+    //! The value of sGeneration when mActivity was last calculated.
+    unsigned int mCalcGeneration;
+
+    //! The configured caching mode.
+    const Mode mMode;
+
+    //! The relative tolerance within which inputs are considered unchanged.
+    const double mTolerance;
+
+#if !GCAM_PARALLEL_ENABLED
+    typedef Recording* ActiveRecordingType;
+#else
+    // Activities are calculated concurrently from the flow graph so each worker
+    // thread tracks the activity it is calculating.
+    typedef tbb::enumerable_thread_specific<Recording*> ActiveRecordingType;
+#endif
+
+    //! If any activity has been wrapped, to avoid the thread local lookup otherwise.
+    static bool sIsEnabled;
+
+    //! The recording to append market interactions to on the current thread if any.
+    static ActiveRecordingType sActiveRecording;
+
+    //! Incremented each time World::calc is called.  Partial derivative
+    //! calculations may call World::calc concurrently so this is atomic.
+    static std::atomic<unsigned int> sGeneration;
+
+    //! Incremented to invalidate all recordings such as when a new period begins.
+    static unsigned int sEpoch;
+
+    //! The number of times an activity was calculated in a full calculation.
+    static std::atomic<unsigned long> sNumCalculated;
+
+    //! The number of times an activity was replayed in a full calculation.
+    static std::atomic<unsigned long> sNumReplayed;
+
+    //! The number of replays which would not have matched in VALIDATE mode.
+    static std::atomic<unsigned long> sNumMismatched;
+
+    static Recording* getActiveRecording() {
+#if !GCAM_PARALLEL_ENABLED
+        return sActiveRecording;
+#else
+        return sActiveRecording.local();
+#endif
+    }
+
+    static void setActiveRecording( Recording* aRecording );
+
+    bool canReplay( const int aPeriod ) const;
+
+    void replay() const;
+
+    bool matchesRecording( const Recording& aRecording ) const;
+
+    void calcAndRecord( const int aPeriod, Recording& aRecording );
+};
+
+#endif // _CACHED_ACTIVITY_H_
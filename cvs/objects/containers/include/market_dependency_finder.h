@@ -342,6 +342,8 @@ public:
                                 CalcVertexCountMap& aTotalVisits ) const;
     int markCycles( CalcVertex* aCurrVertex, std::list<CalcVertex*>& aHasVisited, CalcVertexCountMap& aTotalVisits ) const;
     void createTrialsForItem( CItemIterator aItemToReset, CalcVertexCountMap& aNumDependencies );
+    void breakCyclesOptimally( CalcVertexCountMap& aNumDependencies );
+    void wrapCachedActivities();
 };
 
 #endif // _MARKET_DEPENDENCY_FINDER_H_
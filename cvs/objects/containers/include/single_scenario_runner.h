@@ -67,6 +67,12 @@ class XMLDBOutputter;
  *             file.
  *          -# Scenario components passed into the function, in the order they
  *             are passed in.
+ *          -# Parameter values listed in the configuration file followed by
+ *             those in any scenario components which are CSV files, see
+ *             SetDataHelper.
+ *          The first two steps may be done ahead of time with parseBaseScenario
+ *          in which case the next setupScenarios call will only parse the last
+ *          two.
  *
  *          setupScenarios must be called before runScenarios. runScenarios may
  *          be called multiple times, as in the case when total policy costs are
@@ -112,6 +118,10 @@ public:
 
     XMLDBOutputter* getXMLDBOutputter() const;
 
+    static bool parseBaseScenario();
+
+    static void clearBaseScenario();
+
 protected:    
     SingleScenarioRunner();
     static const std::string& getXMLNameStatic();
@@ -122,5 +132,10 @@ protected:
     //! it around in case we want to do additional processing once GCAM
     //! is done running.
     mutable XMLDBOutputter* mXMLDBOutputter;
+
+    //! A scenario with only the base input file and configuration scenario
+    //! components parsed which the next call to setupScenarios will take
+    //! ownership of rather than parsing those files again.
+    static std::auto_ptr<Scenario> sBaseScenario;
 };
 #endif // _SINGLE_SCENARIO_RUNNER_H_
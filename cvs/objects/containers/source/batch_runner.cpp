@@ -43,6 +43,7 @@
 
 #include "util/base/include/definitions.h"
 #include <string>
+#include <vector>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 #include "containers/include/batch_runner.h"
@@ -51,9 +52,21 @@
 #include "util/base/include/xml_helper.h"
 #include "util/base/include/configuration.h"
 #include "util/logger/include/ilogger.h"
+#include "util/logger/include/logger_factory.h"
 #include "containers/include/scenario.h"
+#include "containers/include/single_scenario_runner.h"
 #include "reporting/include/batch_csv_outputter.h"
 
+#if !defined(_WIN32)
+#include <cerrno>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 using namespace xercesc;
 
@@ -137,6 +150,46 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
     bool shouldExit = false;
     bool success = true;
     BatchCSVOutputter csvOutputter;
+
+    // The base input files are the same for every scenario.  When requested
+    // parse them once and run each scenario in a forked copy of this process
+    // so that only the file sets of the scenario need to be parsed.  Up to
+    // numLanes of these processes may run at once.
+    bool shouldFork = Configuration::getInstance()->getBool( "BatchForkScenarios", false, false );
+    const size_t numLanes = max( Configuration::getInstance()->getInt( "BatchForkLanes", 1, false ), 1 );
+#if defined(_WIN32)
+    if( shouldFork ) {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "BatchForkScenarios is not supported on this platform." << endl;
+        shouldFork = false;
+    }
+#endif
+    if( shouldFork ) {
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Parsing base scenario for batch runs." << endl;
+        if( !SingleScenarioRunner::parseBaseScenario() ) {
+            mainLog.setLevel( ILogger::SEVERE );
+            mainLog << "Failed to parse the base scenario." << endl;
+            return false;
+        }
+#if !defined(_WIN32)
+        // Create the file used to serialize writing output between processes
+        // next to the batch CSV file which they share.
+        const string lockFileTemplate = Configuration::getInstance()->getFile( "batchCSVOutputFile", "batch-csv-out.csv" )
+            + ".lock-XXXXXX";
+        vector<char> lockFileName( lockFileTemplate.begin(), lockFileTemplate.end() );
+        lockFileName.push_back( '\0' );
+        const int lockFile = mkstemp( &lockFileName[ 0 ] );
+        if( lockFile == -1 ) {
+            mainLog.setLevel( ILogger::SEVERE );
+            mainLog << "Failed to create the batch output lock file " << lockFileTemplate << "." << endl;
+            return false;
+        }
+        close( lockFile );
+        mOutputLockFile = &lockFileName[ 0 ];
+#endif
+    }
+
     while( !shouldExit ){
         // The data structure containing the current run.
         Component fileSetsToRun;
@@ -149,6 +202,14 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
 
         // Run it using each possible type of IScenarioRunner.
         for( RunnerIterator runner = mScenarioRunners.begin(); runner != mScenarioRunners.end(); ++runner ){
+            if( shouldFork ) {
+                // Wait for a lane to become available.
+                while( mRunningScenarios.size() >= numLanes ) {
+                    success &= waitForForkedScenario();
+                }
+                success &= startForkedScenario( *runner, fileSetsToRun, aSinglePeriod, aTimer, csvOutputter );
+                continue;
+            }
             bool scenarioSuccess = runSingleScenario( *runner, fileSetsToRun, aSinglePeriod, aTimer );
             success &= scenarioSuccess;
             (*runner)->getInternalScenario()->accept( &csvOutputter, -1 );
@@ -175,6 +236,15 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
             }
         }
     }
+    if( shouldFork ) {
+        while( !mRunningScenarios.empty() ) {
+            success &= waitForForkedScenario();
+        }
+        SingleScenarioRunner::clearBaseScenario();
+#if !defined(_WIN32)
+        unlink( mOutputLockFile.c_str() );
+#endif
+    }
     return success;
 }
 
@@ -213,12 +283,15 @@ void BatchRunner::cleanup() {
  * \param aSinglePeriod The model period to run.
  * \param aTimer The timer used to print out the amount of time spent performing
  *        operations.
+ * \param aPrintOutput Whether to print the output of the scenario, otherwise
+ *        it is left to the caller.
  * \return Whether the model run solved successfully.
  */
 bool BatchRunner::runSingleScenario( IScenarioRunner* aScenarioRunner,
                                      const Component& aComponent,
                                      const int aSinglePeriod,
-                                     Timer& aTimer )
+                                     Timer& aTimer,
+                                     const bool aPrintOutput )
 {
     // Set the current scenario runner.
     mInternalRunner = aScenarioRunner;
@@ -259,7 +332,9 @@ bool BatchRunner::runSingleScenario( IScenarioRunner* aScenarioRunner,
     success = mInternalRunner->runScenarios( aSinglePeriod, false, aTimer );
     
     // Print the output.
-    mInternalRunner->printOutput( aTimer );
+    if( aPrintOutput ) {
+        mInternalRunner->printOutput( aTimer );
+    }
     
     // If the run failed, add to the list of failed runs. CHECK ME!
     if( !success ){
@@ -268,6 +343,161 @@ bool BatchRunner::runSingleScenario( IScenarioRunner* aScenarioRunner,
     return success;
 }
 
+/*!
+ * \brief Start running a single scenario created by the BatchRunner in a child
+ *        process.
+ * \details The child process is a copy of this one and so starts with the base
+ *          scenario already parsed by SingleScenarioRunner::parseBaseScenario
+ *          shared copy-on-write.  The child sets up, runs, and writes the output
+ *          for the scenario then exits with a status indicating if it solved.
+ *          Writing output is serialized between children by locking
+ *          mOutputLockFile since several may be running at once.
+ * \param aScenarioRunner The scenario runner to use for the scenario.
+ * \param aComponent A named list of FileSets which is expanded to create the
+ *        list of scenario files to read in.
+ * \param aSinglePeriod The model period to run.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \param aCSVOutputter The batch CSV outputter the child should write to.
+ * \return Whether the child process was started.
+ * \sa runSingleScenario
+ * \sa waitForForkedScenario
+ */
+bool BatchRunner::startForkedScenario( IScenarioRunner* aScenarioRunner,
+                                       const Component& aComponent,
+                                       const int aSinglePeriod,
+                                       Timer& aTimer,
+                                       BatchCSVOutputter& aCSVOutputter )
+{
+#if !defined(_WIN32)
+    // Flush any buffered output so that it is not written by both processes.
+    cout.flush();
+    cerr.flush();
+    LoggerFactory::flushLoggers();
+    aCSVOutputter.flush();
+
+    const pid_t pid = fork();
+    if( pid == -1 ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Could not fork to run scenario " << aComponent.mName << "." << endl;
+        mUnsolvedNames.push_back( aComponent.mName );
+        return false;
+    }
+    if( pid == 0 ) {
+        // In the child process.  Other processes may be running scenarios at
+        // the same time so write to separate output files, except for those
+        // written under the lock file.
+        list<string> sharedFiles;
+        sharedFiles.push_back( "xmldb-location" );
+        sharedFiles.push_back( "batchCSVOutputFile" );
+        Configuration::getInstance()->appendScnToAllFiles( sharedFiles );
+        bool success = runSingleScenario( aScenarioRunner, aComponent, aSinglePeriod, aTimer, false );
+        if( aScenarioRunner->getInternalScenario() ) {
+            // The lock file contains a flag indicating if the CSV header has
+            // already been written by another child.
+            const int lockFile = open( mOutputLockFile.c_str(), O_RDWR );
+            if( lockFile == -1 || flock( lockFile, LOCK_EX ) == -1 ) {
+                // Writing without the lock could interleave with the output of
+                // other processes so the results are not written.
+                ILogger& mainLog = ILogger::getLogger( "main_log" );
+                mainLog.setLevel( ILogger::SEVERE );
+                mainLog << "Could not lock the batch output lock file " << mOutputLockFile << ": "
+                        << strerror( errno ) << ", output for scenario " << aComponent.mName
+                        << " was not written." << endl;
+                success = false;
+            }
+            else {
+                char headerWritten = 0;
+                if( pread( lockFile, &headerWritten, 1, 0 ) == 1 && headerWritten == '1' ) {
+                    aCSVOutputter.skipHeader();
+                }
+                aScenarioRunner->printOutput( aTimer );
+                aScenarioRunner->getInternalScenario()->accept( &aCSVOutputter, -1 );
+                aCSVOutputter.writeDidScenarioSolve( success );
+                headerWritten = '1';
+                if( pwrite( lockFile, &headerWritten, 1, 0 ) != 1 ) {
+                    ILogger& mainLog = ILogger::getLogger( "main_log" );
+                    mainLog.setLevel( ILogger::WARNING );
+                    mainLog << "Could not update the batch output lock file " << mOutputLockFile
+                            << ", the batch CSV header may be repeated." << endl;
+                }
+            }
+            if( lockFile != -1 ) {
+                close( lockFile );
+            }
+        }
+        aScenarioRunner->cleanup();
+        cout.flush();
+        cerr.flush();
+        LoggerFactory::flushLoggers();
+        // Skip static destruction and the flushing of any inherited buffers
+        // which belong to the parent process.
+        _exit( success ? 0 : 1 );
+    }
+    mRunningScenarios[ pid ] = aComponent.mName;
+    return true;
+#else
+    // Forking is disabled in runScenarios on this platform.
+    assert( false );
+    return false;
+#endif
+}
+
+/*!
+ * \brief Wait for any scenario started by startForkedScenario to complete.
+ * \details Only the processes started by startForkedScenario are waited on so
+ *          that the status of any other child process is left alone.  The
+ *          running processes are polled when there are several of them as
+ *          waitpid can only block on one specific process.
+ * \return Whether the completed scenario solved successfully.
+ */
+bool BatchRunner::waitForForkedScenario() {
+#if !defined(_WIN32)
+    assert( !mRunningScenarios.empty() );
+    int status = 0;
+    map<int, string>::iterator scenarioIter = mRunningScenarios.end();
+    while( scenarioIter == mRunningScenarios.end() ) {
+        const int waitOptions = mRunningScenarios.size() == 1 ? 0 : WNOHANG;
+        for( map<int, string>::iterator currIter = mRunningScenarios.begin();
+             currIter != mRunningScenarios.end() && scenarioIter == mRunningScenarios.end(); ++currIter )
+        {
+            pid_t pid;
+            while( ( pid = waitpid( currIter->first, &status, waitOptions ) ) == -1 && errno == EINTR ) {
+            }
+            if( pid == -1 ) {
+                ILogger& mainLog = ILogger::getLogger( "main_log" );
+                mainLog.setLevel( ILogger::SEVERE );
+                mainLog << "Failed waiting for the process running scenario " << currIter->second << "." << endl;
+                abort();
+            }
+            if( pid == currIter->first ) {
+                scenarioIter = currIter;
+            }
+        }
+        if( scenarioIter == mRunningScenarios.end() ) {
+            usleep( 100000 );
+        }
+    }
+    const string name = scenarioIter->second;
+    mRunningScenarios.erase( scenarioIter );
+
+    if( !WIFEXITED( status ) ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Process running scenario " << name << " terminated abnormally." << endl;
+    }
+    const bool success = WIFEXITED( status ) && WEXITSTATUS( status ) == 0;
+    if( !success ) {
+        mUnsolvedNames.push_back( name );
+    }
+    return success;
+#else
+    assert( false );
+    return false;
+#endif
+}
+
 bool BatchRunner::XMLParse( const DOMNode* aRoot ){
     // assume we were passed a valid node.
     assert( aRoot );
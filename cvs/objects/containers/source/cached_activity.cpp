@@ -0,0 +1,313 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+ * \file cached_activity.cpp
+ * \ingroup Objects
+ * \brief The CachedActivity class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include "containers/include/cached_activity.h"
+#include "marketplace/include/marketplace.h"
+#include "marketplace/include/market.h"
+#include "util/base/include/configuration.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+
+bool CachedActivity::sIsEnabled = false;
+CachedActivity::ActiveRecordingType CachedActivity::sActiveRecording( (CachedActivity::Recording*)0 );
+std::atomic<unsigned int> CachedActivity::sGeneration( 0 );
+unsigned int CachedActivity::sEpoch = 0;
+std::atomic<unsigned long> CachedActivity::sNumCalculated( 0 );
+std::atomic<unsigned long> CachedActivity::sNumReplayed( 0 );
+std::atomic<unsigned long> CachedActivity::sNumMismatched( 0 );
+
+/*!
+ * \brief Constructor.
+ * \param aActivity The activity to wrap.  This object takes ownership of it.
+ * \param aMode The caching mode, which should not be DISABLED.
+ * \param aTolerance The relative tolerance within which inputs are considered
+ *                   unchanged.
+ */
+CachedActivity::CachedActivity( IActivity* aActivity, const Mode aMode, const double aTolerance ):
+mActivity( aActivity ),
+mHasRecording( false ),
+mRecordedPeriod( -1 ),
+mRecordedEpoch( 0 ),
+mCalcGeneration( 0 ),
+mMode( aMode ),
+mTolerance( aTolerance )
+{
+    assert( mActivity );
+    assert( mMode != DISABLED );
+    sIsEnabled = true;
+}
+
+//! Destructor
+CachedActivity::~CachedActivity() {
+    delete mActivity;
+}
+
+void CachedActivity::calc( const int aPeriod ) {
+    // Partial derivatives are calculated in scratch state and must not disturb
+    // the recording of the "base" state.
+    if( Marketplace::mIsDerivativeCalc ) {
+        mActivity->calc( aPeriod );
+        return;
+    }
+
+    const bool canReplay = this->canReplay( aPeriod );
+    if( canReplay && mMode == REPLAY ) {
+        replay();
+        ++sNumReplayed;
+        return;
+    }
+
+    if( canReplay ) {
+        // VALIDATE mode, calculate as usual and check the replay would have
+        // produced the same result.
+        ++sNumReplayed;
+        calcAndRecord( aPeriod, mValidateRecording );
+        if( !matchesRecording( mValidateRecording ) ) {
+            ++sNumMismatched;
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Activity " << getDescription() << " in period " << aPeriod
+                    << " produced different results with unchanged inputs." << endl;
+        }
+        swap( mRecording, mValidateRecording );
+    }
+    else {
+        calcAndRecord( aPeriod, mRecording );
+    }
+    mHasRecording = true;
+    mRecordedPeriod = aPeriod;
+    mRecordedEpoch = sEpoch;
+    mCalcGeneration = sGeneration;
+    ++sNumCalculated;
+}
+
+string CachedActivity::getDescription() const {
+    return mActivity->getDescription();
+}
+
+/*!
+ * \brief Add an activity which must be calculated before this one.
+ * \details If any predecessor is recalculated during a call to World::calc this
+ *          activity will be recalculated as well since it may depend on state of
+ *          the predecessor which is not communicated through the marketplace.
+ * \param aPredecessor The activity this one depends on.
+ */
+void CachedActivity::addPredecessor( const CachedActivity* aPredecessor ) {
+    if( find( mPredecessors.begin(), mPredecessors.end(), aPredecessor ) == mPredecessors.end() ) {
+        mPredecessors.push_back( aPredecessor );
+    }
+}
+
+/*!
+ * \brief Get the caching mode set in the configuration.
+ * \return The configured caching mode.
+ */
+CachedActivity::Mode CachedActivity::getConfiguredMode() {
+    const int mode = Configuration::getInstance()->getInt( "activity-cache", DISABLED, false );
+    if( mode < DISABLED || mode > VALIDATE ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Invalid activity-cache mode " << mode << ", activity caching disabled." << endl;
+        return DISABLED;
+    }
+    return static_cast<Mode>( mode );
+}
+
+/*!
+ * \brief Get the relative tolerance set in the configuration.
+ * \return The configured relative tolerance.
+ */
+double CachedActivity::getConfiguredTolerance() {
+    return max( Configuration::getInstance()->getDouble( "activity-cache-tolerance", 0.0, false ), 0.0 );
+}
+
+/*!
+ * \brief Signal that a new call to World::calc is starting.
+ * \details Activities recalculated after this call are marked so that dependent
+ *          activities will not be replayed.
+ */
+void CachedActivity::startWorldCalc() {
+    ++sGeneration;
+}
+
+/*!
+ * \brief Discard all recordings.
+ * \details Must be called whenever model state may have changed outside of
+ *          World::calc, such as when a new period is initialized.
+ */
+void CachedActivity::invalidateAll() {
+    ++sEpoch;
+}
+
+/*!
+ * \brief Write the number of activities replayed and calculated since the last
+ *        call to the main log and reset the counts.
+ * \param aPeriod The model period the counts were collected in.
+ */
+void CachedActivity::logStatistics( const int aPeriod ) {
+    const unsigned long numCalculated = sNumCalculated.exchange( 0 );
+    const unsigned long numReplayed = sNumReplayed.exchange( 0 );
+    const unsigned long numMismatched = sNumMismatched.exchange( 0 );
+    if( numCalculated == 0 && numReplayed == 0 ) {
+        // Caching is not enabled.
+        return;
+    }
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    if( getConfiguredMode() == VALIDATE ) {
+        mainLog << "Period " << aPeriod << ": " << numReplayed << " of " << numCalculated
+                << " activity calculations could have been replayed, " << numMismatched
+                << " of which did not match." << endl;
+    }
+    else {
+        mainLog << "Period " << aPeriod << ": replayed " << numReplayed << " and calculated "
+                << numCalculated << " activities." << endl;
+    }
+}
+
+/*!
+ * \brief Set the recording market interactions are appended to on this thread.
+ * \param aRecording The recording to use or null to stop recording.
+ */
+void CachedActivity::setActiveRecording( Recording* aRecording ) {
+#if !GCAM_PARALLEL_ENABLED
+    sActiveRecording = aRecording;
+#else
+    sActiveRecording.local() = aRecording;
+#endif
+}
+
+/*!
+ * \brief Check if the current recording is valid and all of the values it read
+ *        are unchanged.
+ * \param aPeriod The period being calculated.
+ * \return True if the recording can be replayed in place of calculating.
+ */
+bool CachedActivity::canReplay( const int aPeriod ) const {
+    if( !mHasRecording || mRecordedPeriod != aPeriod || mRecordedEpoch != sEpoch ) {
+        return false;
+    }
+
+    for( auto predecessor : mPredecessors ) {
+        if( predecessor->mCalcGeneration == sGeneration ) {
+            return false;
+        }
+    }
+
+    for( const MarketRecord& read : mRecording.mReads ) {
+        double current;
+        switch( read.mType ) {
+            case PRICE:
+                current = read.mMarket->getPrice();
+                break;
+            case SUPPLY:
+                current = read.mMarket->getSupply();
+                break;
+            default:
+                current = read.mMarket->getDemand();
+                break;
+        }
+        // Written such that NaNs are always considered changed.
+        if( !( fabs( current - read.mValue ) <= mTolerance * max( fabs( current ), fabs( read.mValue ) ) ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Re-apply the prices, supplies, and demands set during the recorded
+ *        calculation.
+ */
+void CachedActivity::replay() const {
+    for( const MarketRecord& write : mRecording.mWrites ) {
+        switch( write.mType ) {
+            case PRICE:
+                write.mMarket->setPrice( write.mValue );
+                break;
+            case SUPPLY:
+                write.mMarket->addToSupply( write.mValue );
+                break;
+            default:
+                write.mMarket->addToDemand( write.mValue );
+                break;
+        }
+    }
+}
+
+/*!
+ * \brief Check if the writes of the given recording match the current recording.
+ * \param aRecording The recording to compare against.
+ * \return True if the same markets were written in the same order with values
+ *         within tolerance.
+ */
+bool CachedActivity::matchesRecording( const Recording& aRecording ) const {
+    if( aRecording.mWrites.size() != mRecording.mWrites.size() ) {
+        return false;
+    }
+    for( size_t i = 0; i < mRecording.mWrites.size(); ++i ) {
+        const MarketRecord& expected = mRecording.mWrites[ i ];
+        const MarketRecord& actual = aRecording.mWrites[ i ];
+        if( expected.mMarket != actual.mMarket || expected.mType != actual.mType ||
+            !( fabs( actual.mValue - expected.mValue ) <= mTolerance * max( fabs( actual.mValue ), fabs( expected.mValue ) ) ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Calculate the wrapped activity while recording its market interactions.
+ * \param aPeriod The period to calculate.
+ * \param aRecording The recording to fill which will be cleared first.
+ */
+void CachedActivity::calcAndRecord( const int aPeriod, Recording& aRecording ) {
+    aRecording.clear();
+    Recording* prevRecording = getActiveRecording();
+    setActiveRecording( &aRecording );
+    mActivity->calc( aPeriod );
+    setActiveRecording( prevRecording );
+}
@@ -49,6 +49,8 @@
 #include "marketplace/include/market.h"
 #include "marketplace/include/linked_market.h"
 #include "containers/include/iactivity.h"
+#include "containers/include/cached_activity.h"
+#include "util/base/include/configuration.h"
 
 #if GCAM_PARALLEL_ENABLED
 #include "parallel/include/gcam_parallel.hpp"
@@ -56,6 +58,676 @@
 
 using namespace std;
 
+namespace {
+    typedef MarketDependencyFinder::CalcVertex CalcVertex;
+    typedef MarketDependencyFinder::DependencyItem DependencyItem;
+    typedef vector<vector<int> > Graph;
+
+    /*!
+     * \brief Label the strongly connected components of a graph.
+     * \details An iterative version of Tarjan's algorithm so that large
+     *          components can not overflow the stack.
+     * \param aGraph The out edges of each vertex.
+     * \param aComponent Set to the component number of each vertex.
+     * \return Whether each component contains a cycle.
+     */
+    vector<bool> labelComponents( const Graph& aGraph, vector<int>& aComponent ) {
+        const int numVertices = static_cast<int>( aGraph.size() );
+        vector<int> index( numVertices, -1 );
+        vector<int> lowLink( numVertices, 0 );
+        vector<bool> onStack( numVertices, false );
+        vector<int> stack;
+        vector<pair<int, size_t> > callStack;
+        vector<bool> hasCycle;
+        aComponent.assign( numVertices, -1 );
+        int maxIndex = 0;
+        for( int root = 0; root < numVertices; ++root ) {
+            if( index[ root ] != -1 ) {
+                continue;
+            }
+            callStack.push_back( make_pair( root, size_t( 0 ) ) );
+            index[ root ] = lowLink[ root ] = maxIndex++;
+            stack.push_back( root );
+            onStack[ root ] = true;
+            while( !callStack.empty() ) {
+                const int curr = callStack.back().first;
+                size_t& edge = callStack.back().second;
+                if( edge < aGraph[ curr ].size() ) {
+                    const int next = aGraph[ curr ][ edge++ ];
+                    if( index[ next ] == -1 ) {
+                        index[ next ] = lowLink[ next ] = maxIndex++;
+                        stack.push_back( next );
+                        onStack[ next ] = true;
+                        callStack.push_back( make_pair( next, size_t( 0 ) ) );
+                    }
+                    else if( onStack[ next ] ) {
+                        lowLink[ curr ] = min( lowLink[ curr ], index[ next ] );
+                    }
+                    continue;
+                }
+                callStack.pop_back();
+                if( !callStack.empty() ) {
+                    const int parent = callStack.back().first;
+                    lowLink[ parent ] = min( lowLink[ parent ], lowLink[ curr ] );
+                }
+                if( lowLink[ curr ] == index[ curr ] ) {
+                    const int component = static_cast<int>( hasCycle.size() );
+                    bool isCycle = stack.back() != curr ||
+                        find( aGraph[ curr ].begin(), aGraph[ curr ].end(), curr ) != aGraph[ curr ].end();
+                    int member;
+                    do {
+                        member = stack.back();
+                        stack.pop_back();
+                        onStack[ member ] = false;
+                        aComponent[ member ] = component;
+                    } while( member != curr );
+                    hasCycle.push_back( isCycle );
+                }
+            }
+        }
+        return hasCycle;
+    }
+
+    //! Check if a graph has no cycles using Kahn's algorithm.
+    bool isAcyclic( const Graph& aGraph ) {
+        const size_t numVertices = aGraph.size();
+        vector<int> numIn( numVertices, 0 );
+        for( size_t i = 0; i < numVertices; ++i ) {
+            for( size_t j = 0; j < aGraph[ i ].size(); ++j ) {
+                ++numIn[ aGraph[ i ][ j ] ];
+            }
+        }
+        vector<int> ready;
+        for( size_t i = 0; i < numVertices; ++i ) {
+            if( numIn[ i ] == 0 ) {
+                ready.push_back( static_cast<int>( i ) );
+            }
+        }
+        size_t numCleared = 0;
+        while( !ready.empty() ) {
+            const int curr = ready.back();
+            ready.pop_back();
+            ++numCleared;
+            for( size_t j = 0; j < aGraph[ curr ].size(); ++j ) {
+                if( --numIn[ aGraph[ curr ][ j ] ] == 0 ) {
+                    ready.push_back( aGraph[ curr ][ j ] );
+                }
+            }
+        }
+        return numCleared == numVertices;
+    }
+
+    /*!
+     * \brief A compact copy of the dependency graph which remains to be sorted
+     *        which is used to plan which items to break before any markets are
+     *        actually reset.
+     * \details Vertices are numbered in the same UID order as the
+     *          CalcVertexCountMap so that plans are reproducible.  Breaking an
+     *          item is modeled the same way as createTrialsForItem: edges from
+     *          demand vertices, other than fixed output, into the item's first
+     *          demand vertex and all edges out of its last price vertex are
+     *          removed and the last price vertex is linked to the first demand
+     *          vertex.
+     */
+    class CycleBreakPlanner {
+    public:
+        CycleBreakPlanner( const MarketDependencyFinder::CalcVertexCountMap& aRemaining,
+                           const MarketDependencyFinder::DependencyItemSet& aItems );
+
+        vector<DependencyItem*> planBreaks( int& aNumExact, int& aNumHeuristic ) const;
+
+        int countGreedyBreaks() const;
+
+    private:
+        //! An item which could be used to break a cycle.
+        struct Candidate {
+            //! The dependency item to reset to trial markets.
+            DependencyItem* mItem;
+
+            //! The vertex number of the first demand vertex or -1 if already sorted.
+            int mFirstDemand;
+
+            //! The vertex number of the first price vertex or -1 if already sorted.
+            int mFirstPrice;
+
+            //! The vertex number of the last price vertex or -1 if already sorted.
+            int mLastPrice;
+        };
+
+        /*!
+         * \brief A strongly connected component renumbered so that trial
+         *        breaks can be checked in time proportional to its size.
+         */
+        struct Component {
+            Graph mOutEdges;
+            vector<bool> mIsCuttable;
+            vector<int> mCandidates;
+            vector<int> mFirstDemand;
+            vector<int> mLastPrice;
+            //! Vertices of items already broken for an earlier component.
+            vector<int> mBrokenFirstDemand;
+            vector<int> mBrokenLastPrice;
+        };
+
+        //! The out edges of each vertex.
+        Graph mOutEdges;
+
+        //! Whether edges out of each vertex are removed when the vertex they lead
+        //! into is a broken first demand vertex.
+        vector<bool> mIsCuttable;
+
+        //! The candidate which each vertex belongs to or -1 if it can not be broken.
+        vector<int> mCandidateOfVertex;
+
+        //! Whether each vertex belongs to an item which may break cycles.
+        vector<bool> mCanBreak;
+
+        //! Items which could be used to break a cycle.
+        vector<Candidate> mCandidates;
+
+        //! Largest number of candidates for which the exact search is attempted.
+        static const size_t MAX_EXACT_CANDIDATES = 24;
+
+        //! Largest number of trial break sets checked by the exact search.
+        static const int MAX_EXACT_TESTS = 100000;
+
+        //! The limit on cycle visits along a path in markCycles.
+        static const int MAX_CYCLE_VISITS = 1000;
+
+        Graph applyBreaks( const Component& aComponent, const vector<bool>& aSelected ) const;
+        vector<int> breakHeuristic( const Component& aComponent ) const;
+        bool breakExact( const Component& aComponent, const size_t aMaxSize, vector<int>& aBest ) const;
+        void breakItem( Graph& aGraph, const Candidate& aCandidate ) const;
+        int markCycles( const Graph& aGraph, const int aVertex, vector<bool>& aOnPath,
+                        vector<int>& aVisits ) const;
+    };
+
+    /*!
+     * \brief Constructor which copies the dependencies amongst the vertices which
+     *        have not yet been sorted.
+     * \param aRemaining The vertices which have not been sorted.
+     * \param aItems All dependency items.
+     */
+    CycleBreakPlanner::CycleBreakPlanner( const MarketDependencyFinder::CalcVertexCountMap& aRemaining,
+                                          const MarketDependencyFinder::DependencyItemSet& aItems )
+    {
+        map<const CalcVertex*, int> vertexNumber;
+        for( auto it = aRemaining.begin(); it != aRemaining.end(); ++it ) {
+            const int number = static_cast<int>( vertexNumber.size() );
+            vertexNumber[ (*it).first ] = number;
+        }
+        const size_t numVertices = vertexNumber.size();
+        mOutEdges.resize( numVertices );
+        mIsCuttable.assign( numVertices, false );
+        mCandidateOfVertex.assign( numVertices, -1 );
+        mCanBreak.assign( numVertices, false );
+        for( auto it = aRemaining.begin(); it != aRemaining.end(); ++it ) {
+            vector<int>& outEdges = mOutEdges[ vertexNumber[ (*it).first ] ];
+            for( auto edgeIt = (*it).first->mOutEdges.begin(); edgeIt != (*it).first->mOutEdges.end(); ++edgeIt ) {
+                auto numberIt = vertexNumber.find( *edgeIt );
+                if( numberIt != vertexNumber.end() ) {
+                    outEdges.push_back( (*numberIt).second );
+                }
+            }
+        }
+
+        for( auto it = aItems.begin(); it != aItems.end(); ++it ) {
+            for( auto vertexIt = (*it)->mDemandVertices.begin(); vertexIt != (*it)->mDemandVertices.end(); ++vertexIt ) {
+                auto numberIt = vertexNumber.find( *vertexIt );
+                if( numberIt != vertexNumber.end() ) {
+                    mIsCuttable[ (*numberIt).second ] =
+                        !boost::algorithm::ends_with( (*vertexIt)->mCalcItem->getDescription(), "-fixed-output" );
+                    mCanBreak[ (*numberIt).second ] = (*it)->mCanBreakCycle;
+                }
+            }
+            for( auto vertexIt = (*it)->mPriceVertices.begin(); vertexIt != (*it)->mPriceVertices.end(); ++vertexIt ) {
+                auto numberIt = vertexNumber.find( *vertexIt );
+                if( numberIt != vertexNumber.end() ) {
+                    mCanBreak[ (*numberIt).second ] = (*it)->mCanBreakCycle;
+                }
+            }
+
+            if( !(*it)->mCanBreakCycle || (*it)->mIsSolved || (*it)->mPriceVertices.empty() ||
+                (*it)->mDemandVertices.empty() )
+            {
+                continue;
+            }
+            Candidate candidate;
+            candidate.mItem = *it;
+            auto numberIt = vertexNumber.find( (*it)->getFirstDemandVertex() );
+            candidate.mFirstDemand = numberIt != vertexNumber.end() ? (*numberIt).second : -1;
+            numberIt = vertexNumber.find( (*it)->getFirstPriceVertex() );
+            candidate.mFirstPrice = numberIt != vertexNumber.end() ? (*numberIt).second : -1;
+            numberIt = vertexNumber.find( (*it)->getLastPriceVertex() );
+            candidate.mLastPrice = numberIt != vertexNumber.end() ? (*numberIt).second : -1;
+            if( candidate.mFirstDemand == -1 && candidate.mLastPrice == -1 ) {
+                continue;
+            }
+            const int candidateNumber = static_cast<int>( mCandidates.size() );
+            mCandidates.push_back( candidate );
+            for( auto vertexIt = (*it)->mDemandVertices.begin(); vertexIt != (*it)->mDemandVertices.end(); ++vertexIt ) {
+                numberIt = vertexNumber.find( *vertexIt );
+                if( numberIt != vertexNumber.end() ) {
+                    mCandidateOfVertex[ (*numberIt).second ] = candidateNumber;
+                }
+            }
+            for( auto vertexIt = (*it)->mPriceVertices.begin(); vertexIt != (*it)->mPriceVertices.end(); ++vertexIt ) {
+                numberIt = vertexNumber.find( *vertexIt );
+                if( numberIt != vertexNumber.end() ) {
+                    mCandidateOfVertex[ (*numberIt).second ] = candidateNumber;
+                }
+            }
+        }
+    }
+
+    /*!
+     * \brief Choose a small set of items to break so that the remaining graph
+     *        has no cycles.
+     * \details Each strongly connected component is handled on its own.  A
+     *          greedy choice followed by the removal of redundant breaks gives an
+     *          upper bound and, for components with few candidates, every smaller
+     *          set is then checked to find a minimum.
+     * \param aNumExact Set to the number of components solved to a minimum.
+     * \param aNumHeuristic Set to the number of components only solved heuristically.
+     * \return The items to break.
+     */
+    vector<DependencyItem*> CycleBreakPlanner::planBreaks( int& aNumExact, int& aNumHeuristic ) const {
+        aNumExact = aNumHeuristic = 0;
+        vector<int> componentOfVertex;
+        const vector<bool> hasCycle = labelComponents( mOutEdges, componentOfVertex );
+        vector<DependencyItem*> toBreak;
+        vector<bool> isBroken( mCandidates.size(), false );
+        for( size_t comp = 0; comp < hasCycle.size(); ++comp ) {
+            if( !hasCycle[ comp ] ) {
+                continue;
+            }
+            // Renumber the vertices of this component.
+            Component component;
+            vector<int> localNumber( mOutEdges.size(), -1 );
+            for( size_t v = 0; v < mOutEdges.size(); ++v ) {
+                if( componentOfVertex[ v ] == static_cast<int>( comp ) ) {
+                    localNumber[ v ] = static_cast<int>( component.mOutEdges.size() );
+                    component.mOutEdges.push_back( vector<int>() );
+                    component.mIsCuttable.push_back( mIsCuttable[ v ] );
+                }
+            }
+            for( size_t v = 0; v < mOutEdges.size(); ++v ) {
+                if( localNumber[ v ] == -1 ) {
+                    continue;
+                }
+                for( size_t j = 0; j < mOutEdges[ v ].size(); ++j ) {
+                    if( localNumber[ mOutEdges[ v ][ j ] ] != -1 ) {
+                        component.mOutEdges[ localNumber[ v ] ].push_back( localNumber[ mOutEdges[ v ][ j ] ] );
+                    }
+                }
+            }
+            for( size_t c = 0; c < mCandidates.size(); ++c ) {
+                const int firstDemand = mCandidates[ c ].mFirstDemand == -1 ? -1 :
+                    localNumber[ mCandidates[ c ].mFirstDemand ];
+                const int lastPrice = mCandidates[ c ].mLastPrice == -1 ? -1 :
+                    localNumber[ mCandidates[ c ].mLastPrice ];
+                if( ( firstDemand != -1 || lastPrice != -1 ) && isBroken[ c ] ) {
+                    component.mBrokenFirstDemand.push_back( firstDemand );
+                    component.mBrokenLastPrice.push_back( lastPrice );
+                }
+                else if( firstDemand != -1 || lastPrice != -1 ) {
+                    component.mCandidates.push_back( static_cast<int>( c ) );
+                    component.mFirstDemand.push_back( firstDemand );
+                    component.mLastPrice.push_back( lastPrice );
+                }
+            }
+
+            vector<int> best = breakHeuristic( component );
+            if( best.empty() ) {
+                // Items broken for earlier components already took care of this one.
+                continue;
+            }
+            if( best.size() > 1 && component.mCandidates.size() <= MAX_EXACT_CANDIDATES ) {
+                if( breakExact( component, best.size() - 1, best ) ) {
+                    ++aNumExact;
+                }
+                else {
+                    ++aNumHeuristic;
+                }
+            }
+            else if( best.size() <= 1 ) {
+                // Nothing smaller than a single break is possible.
+                ++aNumExact;
+            }
+            else {
+                ++aNumHeuristic;
+            }
+            for( size_t i = 0; i < best.size(); ++i ) {
+                isBroken[ component.mCandidates[ best[ i ] ] ] = true;
+                toBreak.push_back( mCandidates[ component.mCandidates[ best[ i ] ] ].mItem );
+            }
+        }
+        return toBreak;
+    }
+
+    /*!
+     * \brief Get the edges of a component after breaking the selected candidates.
+     * \param aComponent The component.
+     * \param aSelected Whether each candidate of the component is broken.
+     * \return The edges after the breaks.
+     */
+    Graph CycleBreakPlanner::applyBreaks( const Component& aComponent, const vector<bool>& aSelected ) const {
+        const size_t numVertices = aComponent.mOutEdges.size();
+        vector<bool> isBrokenDemand( numVertices, false );
+        vector<bool> isBrokenPrice( numVertices, false );
+        vector<int> firstDemand( aComponent.mBrokenFirstDemand );
+        vector<int> lastPrice( aComponent.mBrokenLastPrice );
+        for( size_t c = 0; c < aSelected.size(); ++c ) {
+            if( aSelected[ c ] ) {
+                firstDemand.push_back( aComponent.mFirstDemand[ c ] );
+                lastPrice.push_back( aComponent.mLastPrice[ c ] );
+            }
+        }
+        for( size_t c = 0; c < firstDemand.size(); ++c ) {
+            if( firstDemand[ c ] != -1 ) {
+                isBrokenDemand[ firstDemand[ c ] ] = true;
+            }
+            if( lastPrice[ c ] != -1 ) {
+                isBrokenPrice[ lastPrice[ c ] ] = true;
+            }
+        }
+        Graph graph( numVertices );
+        for( size_t v = 0; v < numVertices; ++v ) {
+            if( isBrokenPrice[ v ] ) {
+                continue;
+            }
+            for( size_t j = 0; j < aComponent.mOutEdges[ v ].size(); ++j ) {
+                const int next = aComponent.mOutEdges[ v ][ j ];
+                if( !isBrokenDemand[ next ] || !aComponent.mIsCuttable[ v ] ) {
+                    graph[ v ].push_back( next );
+                }
+            }
+        }
+        for( size_t c = 0; c < firstDemand.size(); ++c ) {
+            if( firstDemand[ c ] != -1 && lastPrice[ c ] != -1 ) {
+                graph[ lastPrice[ c ] ].push_back( firstDemand[ c ] );
+            }
+        }
+        return graph;
+    }
+
+    /*!
+     * \brief Greedily break the candidate which cuts the most paths through the
+     *        cycles which remain and then drop any break which turns out to be
+     *        redundant.
+     * \details The number of paths cut at a vertex is estimated by the product of
+     *          the edges removed and the edges on the other side of the vertex
+     *          within its strongly connected component, the usual degree
+     *          heuristic for feedback vertex sets.
+     * \param aComponent The component.
+     * \return The index of each candidate in the component to break.
+     */
+    vector<int> CycleBreakPlanner::breakHeuristic( const Component& aComponent ) const {
+        const size_t numCandidates = aComponent.mCandidates.size();
+        const size_t numVertices = aComponent.mOutEdges.size();
+        vector<bool> selected( numCandidates, false );
+        vector<int> order;
+        while( true ) {
+            const Graph graph = applyBreaks( aComponent, selected );
+            vector<int> componentOfVertex;
+            const vector<bool> hasCycle = labelComponents( graph, componentOfVertex );
+            if( find( hasCycle.begin(), hasCycle.end(), true ) == hasCycle.end() ) {
+                break;
+            }
+
+            // Count the edges of each vertex which stay within a cyclic component.
+            vector<int> numIn( numVertices, 0 );
+            vector<int> numCuttableIn( numVertices, 0 );
+            vector<int> numOut( numVertices, 0 );
+            for( size_t v = 0; v < numVertices; ++v ) {
+                for( size_t j = 0; j < graph[ v ].size(); ++j ) {
+                    const int next = graph[ v ][ j ];
+                    if( componentOfVertex[ v ] == componentOfVertex[ next ] && hasCycle[ componentOfVertex[ v ] ] ) {
+                        ++numOut[ v ];
+                        ++numIn[ next ];
+                        if( aComponent.mIsCuttable[ v ] ) {
+                            ++numCuttableIn[ next ];
+                        }
+                    }
+                }
+            }
+
+            int bestCandidate = -1;
+            long bestScore = 0;
+            for( size_t c = 0; c < numCandidates; ++c ) {
+                if( selected[ c ] ) {
+                    continue;
+                }
+                long score = 0;
+                const int firstDemand = aComponent.mFirstDemand[ c ];
+                if( firstDemand != -1 ) {
+                    score += static_cast<long>( numCuttableIn[ firstDemand ] ) * max( numOut[ firstDemand ], 1 );
+                }
+                const int lastPrice = aComponent.mLastPrice[ c ];
+                if( lastPrice != -1 ) {
+                    score += static_cast<long>( numOut[ lastPrice ] ) * max( numIn[ lastPrice ], 1 );
+                }
+                if( score > bestScore ) {
+                    bestScore = score;
+                    bestCandidate = static_cast<int>( c );
+                }
+            }
+            if( bestCandidate == -1 ) {
+                // No candidate can cut what remains, the greedy cycle breaking in
+                // createOrdering will report the problem.
+                break;
+            }
+            selected[ bestCandidate ] = true;
+            order.push_back( bestCandidate );
+        }
+
+        // Later choices may have made earlier ones redundant.
+        for( size_t i = order.size(); i-- > 0; ) {
+            selected[ order[ i ] ] = false;
+            if( isAcyclic( applyBreaks( aComponent, selected ) ) ) {
+                order.erase( order.begin() + i );
+            }
+            else {
+                selected[ order[ i ] ] = true;
+            }
+        }
+        return order;
+    }
+
+    /*!
+     * \brief Search for the smallest set of candidates which breaks every cycle in
+     *        the component.
+     * \param aComponent The component.
+     * \param aMaxSize The largest set size to try.
+     * \param aBest Set to the smallest set found if any.
+     * \return Whether the search completed so that aBest is a minimum.
+     */
+    bool CycleBreakPlanner::breakExact( const Component& aComponent, const size_t aMaxSize,
+                                        vector<int>& aBest ) const
+    {
+        const size_t numCandidates = aComponent.mCandidates.size();
+        int numTests = 0;
+        for( size_t size = 1; size <= aMaxSize; ++size ) {
+            // Step through each combination of the given size in lexicographic order.
+            vector<int> combination( size );
+            for( size_t i = 0; i < size; ++i ) {
+                combination[ i ] = static_cast<int>( i );
+            }
+            while( true ) {
+                if( ++numTests > MAX_EXACT_TESTS ) {
+                    return false;
+                }
+                vector<bool> selected( numCandidates, false );
+                for( size_t i = 0; i < size; ++i ) {
+                    selected[ combination[ i ] ] = true;
+                }
+                if( isAcyclic( applyBreaks( aComponent, selected ) ) ) {
+                    aBest = combination;
+                    return true;
+                }
+                size_t pos = size;
+                while( pos > 0 && combination[ pos - 1 ] == static_cast<int>( numCandidates - size + pos - 1 ) ) {
+                    --pos;
+                }
+                if( pos == 0 ) {
+                    break;
+                }
+                ++combination[ pos - 1 ];
+                for( size_t i = pos; i < size; ++i ) {
+                    combination[ i ] = combination[ i - 1 ] + 1;
+                }
+            }
+        }
+        // Every smaller set has been ruled out.
+        return true;
+    }
+
+    //! Apply the edge changes of createTrialsForItem for a candidate.
+    void CycleBreakPlanner::breakItem( Graph& aGraph, const Candidate& aCandidate ) const {
+        if( aCandidate.mFirstDemand != -1 ) {
+            for( size_t v = 0; v < aGraph.size(); ++v ) {
+                if( mIsCuttable[ v ] ) {
+                    auto edgeIt = find( aGraph[ v ].begin(), aGraph[ v ].end(), aCandidate.mFirstDemand );
+                    if( edgeIt != aGraph[ v ].end() ) {
+                        aGraph[ v ].erase( edgeIt );
+                    }
+                }
+            }
+        }
+        if( aCandidate.mLastPrice != -1 ) {
+            aGraph[ aCandidate.mLastPrice ].clear();
+            if( aCandidate.mFirstDemand != -1 ) {
+                aGraph[ aCandidate.mLastPrice ].push_back( aCandidate.mFirstDemand );
+            }
+        }
+    }
+
+    //! The same search as MarketDependencyFinder::markCycles on the planner graph.
+    int CycleBreakPlanner::markCycles( const Graph& aGraph, const int aVertex, vector<bool>& aOnPath,
+                                       vector<int>& aVisits ) const
+    {
+        if( aVisits[ aVertex ] < 0 ) {
+            return 0;
+        }
+        if( aOnPath[ aVertex ] ) {
+            return ++aVisits[ aVertex ];
+        }
+        aOnPath[ aVertex ] = true;
+        int cycleVisits = 0;
+        for( size_t j = 0; j < aGraph[ aVertex ].size() && cycleVisits < MAX_CYCLE_VISITS; ++j ) {
+            cycleVisits = max( cycleVisits, markCycles( aGraph, aGraph[ aVertex ][ j ], aOnPath, aVisits ) );
+        }
+        aOnPath[ aVertex ] = false;
+        if( cycleVisits ) {
+            ++aVisits[ aVertex ];
+        }
+        return cycleVisits;
+    }
+
+    /*!
+     * \brief Count the items the greedy cycle breaking in createOrdering would
+     *        have broken on this graph.
+     * \details Repeats the topological sort, always breaking the item with the
+     *          most cycle visits when the sort gets stuck.
+     * \return The number of items broken or -1 if the greedy choice would have
+     *         been an item this planner can not model.
+     */
+    int CycleBreakPlanner::countGreedyBreaks() const {
+        const int numVertices = static_cast<int>( mOutEdges.size() );
+        Graph graph( mOutEdges );
+        vector<bool> isRemaining( numVertices, true );
+        int numRemaining = numVertices;
+        // Vertices which are in a cycle have a visit count, all others are -1.
+        vector<int> visits( numVertices, -1 );
+        bool hasCycleVertices = false;
+        int numBreaks = 0;
+        while( numRemaining > 0 ) {
+            vector<int> numIn( numVertices, 0 );
+            for( int v = 0; v < numVertices; ++v ) {
+                if( isRemaining[ v ] ) {
+                    for( size_t j = 0; j < graph[ v ].size(); ++j ) {
+                        ++numIn[ graph[ v ][ j ] ];
+                    }
+                }
+            }
+            vector<int> justRemoved;
+            for( int v = 0; v < numVertices; ++v ) {
+                if( isRemaining[ v ] && numIn[ v ] == 0 ) {
+                    justRemoved.push_back( v );
+                }
+            }
+            if( !justRemoved.empty() ) {
+                for( size_t i = 0; i < justRemoved.size(); ++i ) {
+                    isRemaining[ justRemoved[ i ] ] = false;
+                    visits[ justRemoved[ i ] ] = -1;
+                }
+                numRemaining -= static_cast<int>( justRemoved.size() );
+                continue;
+            }
+
+            if( !hasCycleVertices ) {
+                hasCycleVertices = true;
+                Graph remainingGraph( numVertices );
+                for( int v = 0; v < numVertices; ++v ) {
+                    if( isRemaining[ v ] ) {
+                        for( size_t j = 0; j < graph[ v ].size(); ++j ) {
+                            if( isRemaining[ graph[ v ][ j ] ] ) {
+                                remainingGraph[ v ].push_back( graph[ v ][ j ] );
+                            }
+                        }
+                    }
+                }
+                vector<int> componentOfVertex;
+                labelComponents( remainingGraph, componentOfVertex );
+                vector<int> componentSize( numVertices, 0 );
+                for( int v = 0; v < numVertices; ++v ) {
+                    ++componentSize[ componentOfVertex[ v ] ];
+                }
+                for( int v = 0; v < numVertices; ++v ) {
+                    if( isRemaining[ v ] && componentSize[ componentOfVertex[ v ] ] > 1 ) {
+                        visits[ v ] = 0;
+                    }
+                }
+            }
+            else {
+                for( int v = 0; v < numVertices; ++v ) {
+                    if( visits[ v ] > 0 ) {
+                        visits[ v ] = 0;
+                    }
+                }
+            }
+
+            vector<bool> onPath( numVertices, false );
+            for( int v = 0; v < numVertices; ++v ) {
+                if( visits[ v ] >= 0 ) {
+                    markCycles( graph, v, onPath, visits );
+                }
+            }
+            int maxVisits = 0;
+            int maxVertex = -1;
+            for( int v = 0; v < numVertices; ++v ) {
+                if( mCanBreak[ v ] && visits[ v ] > maxVisits ) {
+                    maxVisits = visits[ v ];
+                    maxVertex = v;
+                }
+            }
+            if( maxVertex == -1 || mCandidateOfVertex[ maxVertex ] == -1 ) {
+                return -1;
+            }
+            const Candidate& candidate = mCandidates[ mCandidateOfVertex[ maxVertex ] ];
+            breakItem( graph, candidate );
+            ++numBreaks;
+            if( candidate.mFirstDemand != -1 ) {
+                visits[ candidate.mFirstDemand ] = -1;
+            }
+            if( candidate.mFirstPrice != -1 ) {
+                visits[ candidate.mFirstPrice ] = -1;
+            }
+        }
+        return numBreaks;
+    }
+}
+
 /*!
  * \brief Constructor.
  * \param aMarketplace The marketplace object in which this object is contained.
@@ -578,6 +1250,10 @@ void MarketDependencyFinder::createOrdering() {
     // performing the topological sort.
     CalcVertexCountMap totalVisits;
 
+    // Optionally plan all of the cycle breaks at once the first time a cycle is
+    // found.  Anything that plan misses falls through to the greedy choice below.
+    bool shouldPlanBreaks = Configuration::getInstance()->getBool( "optimize-cycle-breaking", false, false );
+
     // Create a global ordering by performing a topological sort on the graph.
     // Cycles will be broken when they are no longer possible to avoid.
     while( !numDependencies.empty() ) {
@@ -613,6 +1289,12 @@ void MarketDependencyFinder::createOrdering() {
             depLog.setLevel( ILogger::WARNING );
             depLog << "Cycle detected attempting to break it." << endl;
 
+            if( shouldPlanBreaks ) {
+                shouldPlanBreaks = false;
+                breakCyclesOptimally( numDependencies );
+                continue;
+            }
+
             list<CalcVertex*> hasVisited;
             if( totalVisits.empty() ) {
                 // We will need to create the list of possible vertices to use to break the
@@ -705,7 +1387,10 @@ void MarketDependencyFinder::createOrdering() {
         }
     }
     
-    // All vertices are now cleared and we have a global ordering.
+    // All vertices are now cleared and we have a global ordering.  Optionally
+    // wrap the activities so they are only recalculated when their inputs change.
+    wrapCachedActivities();
+
     depLog.setLevel( ILogger::DEBUG );
     depLog << "Global Ordering:" << endl;
     for( vector<IActivity*>::iterator it = mGlobalOrdering.begin(); it != mGlobalOrdering.end(); ++it ) {
@@ -713,6 +1398,46 @@ void MarketDependencyFinder::createOrdering() {
     }
 }
 
+/*!
+ * \brief Break all of the cycles which remain in the graph by resetting as few
+ *        items as possible to trial markets.
+ * \details Each reset item adds a price and demand market to the solver so
+ *          fewer breaks keep the Jacobian smaller.  The items are chosen by a
+ *          CycleBreakPlanner and the number of solved markets saved compared to
+ *          the greedy choice made in createOrdering is logged.
+ * \param aNumDependencies The current count of dependencies on each activity which
+ *                         have not yet been sorted.
+ */
+void MarketDependencyFinder::breakCyclesOptimally( CalcVertexCountMap& aNumDependencies ) {
+    CycleBreakPlanner planner( aNumDependencies, mDependencyItems );
+    int numExact = 0;
+    int numHeuristic = 0;
+    const vector<DependencyItem*> toBreak = planner.planBreaks( numExact, numHeuristic );
+    const int numGreedy = planner.countGreedyBreaks();
+
+    ILogger& depLog = ILogger::getLogger( "dependency_finder_log" );
+    depLog.setLevel( ILogger::WARNING );
+    // Items in multiple regions of the same market can only be reset once.
+    set<int> resetMarkets;
+    int numBroken = 0;
+    for( vector<DependencyItem*>::const_iterator it = toBreak.begin(); it != toBreak.end(); ++it ) {
+        if( !resetMarkets.insert( (*it)->mLinkedMarket ).second ) {
+            continue;
+        }
+        depLog << "The following item has been chosen to break the cycle: "
+               << (*it)->mName << " in " << (*it)->mLocatedInRegion << endl;
+        createTrialsForItem( mDependencyItems.find( *it ), aNumDependencies );
+        ++numBroken;
+    }
+
+    depLog << "Broke cycles in " << ( numExact + numHeuristic ) << " strongly connected components ("
+           << numExact << " minimal) by creating trial markets for " << numBroken << " items." << endl;
+    if( numGreedy >= 0 ) {
+        depLog << "The greedy choice would have created trial markets for " << numGreedy
+               << " items, solved markets saved: " << 2 * ( numGreedy - numBroken ) << endl;
+    }
+}
+
 /*!
  * \brief An implementation of Tarjan's strongly connected components algorithm which
  *        is used to identify vertices that are part of a cycle.
@@ -911,3 +1636,48 @@ void MarketDependencyFinder::createTrialsForItem( CItemIterator aItemToReset, Ca
     }
 }
 
+/*!
+ * \brief Wrap the activity of every vertex in a CachedActivity if activity caching
+ *        has been enabled in the configuration.
+ * \details The global ordering is updated to refer to the wrapped activities and
+ *          each wrapper is told about the activities which it depends on so that
+ *          it will be recalculated if any of those are.
+ * \pre The global ordering has been created.
+ * \sa CachedActivity
+ */
+void MarketDependencyFinder::wrapCachedActivities() {
+    const CachedActivity::Mode mode = CachedActivity::getConfiguredMode();
+    if( mode == CachedActivity::DISABLED ) {
+        return;
+    }
+    const double tolerance = CachedActivity::getConfiguredTolerance();
+
+    VertexList allVertices;
+    for( CItemIterator it = mDependencyItems.begin(); it != mDependencyItems.end(); ++it ) {
+        allVertices.insert( allVertices.end(), (*it)->mPriceVertices.begin(), (*it)->mPriceVertices.end() );
+        allVertices.insert( allVertices.end(), (*it)->mDemandVertices.begin(), (*it)->mDemandVertices.end() );
+    }
+
+    map<IActivity*, IActivity*> wrappedActivities;
+    for( CVertexIterator it = allVertices.begin(); it != allVertices.end(); ++it ) {
+        CachedActivity* cachedActivity = new CachedActivity( (*it)->mCalcItem, mode, tolerance );
+        wrappedActivities[ (*it)->mCalcItem ] = cachedActivity;
+        (*it)->mCalcItem = cachedActivity;
+    }
+
+    // Implied in edges are followed in the same direction as out edges, see
+    // findVerticesToCalculate.
+    for( CVertexIterator it = allVertices.begin(); it != allVertices.end(); ++it ) {
+        const CachedActivity* predecessor = static_cast<CachedActivity*>( (*it)->mCalcItem );
+        for( CVertexIterator depIter = (*it)->mOutEdges.begin(); depIter != (*it)->mOutEdges.end(); ++depIter ) {
+            static_cast<CachedActivity*>( (*depIter)->mCalcItem )->addPredecessor( predecessor );
+        }
+        for( set<CalcVertex*>::const_iterator depIter = (*it)->mImpliedInEdges.begin(); depIter != (*it)->mImpliedInEdges.end(); ++depIter ) {
+            static_cast<CachedActivity*>( (*depIter)->mCalcItem )->addPredecessor( predecessor );
+        }
+    }
+
+    for( vector<IActivity*>::iterator it = mGlobalOrdering.begin(); it != mGlobalOrdering.end(); ++it ) {
+        *it = wrappedActivities[ *it ];
+    }
+}
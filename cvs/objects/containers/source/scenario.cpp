@@ -63,8 +63,12 @@
 #include "solution/solvers/include/solver_factory.h"
 #include "solution/solvers/include/bisection_nr_solver.h"
 #include "solution/util/include/solution_info_param_parser.h" 
+#include "solution/util/include/solver_telemetry.h"
+#include "solution/util/include/edfun_recorder.h"
 #include "containers/include/imodel_feedback_calc.h"
 #include "util/base/include/manage_state_variables.hpp"
+#include "containers/include/cached_activity.h"
+#include "emissions/include/aghg.h"
 #include "util/base/include/supply_demand_curve_saver.h"
 
 #if GCAM_PARALLEL_ENABLED && PARALLEL_DEBUG
@@ -406,7 +410,14 @@ bool Scenario::calculatePeriod( const int aPeriod,
     // Set up the state data for the current period.
     delete mManageStateVars;
     mManageStateVars = new ManageStateVariables( aPeriod );
+    // Any activity results recorded so far are no longer valid.
+    CachedActivity::invalidateAll();
     
+    // Emissions which do not add to a market can not affect the solution so they
+    // are skipped while solving and calculated once the period has solved.
+    const bool isLazyEmissions = Configuration::getInstance()->getBool( "lazy-emissions", true, false );
+    AGHG::mIsLazyCalc = isLazyEmissions;
+
     // Be sure to clear out any supplies and demands in the marketplace before making our
     // initial call to world.calc.  There may already be values in there if for instance
     // they got set from a restart file.
@@ -471,6 +482,17 @@ bool Scenario::calculatePeriod( const int aPeriod,
     
     
     bool success = solve( aPeriod ); // solution uses Bisect and NR routine to clear markets
+    CachedActivity::logStatistics( aPeriod );
+
+    // Calculate the model once more at the solved prices including all emissions
+    // for reporting and the climate model.  The recorded activities do not
+    // include the skipped emissions so must not be replayed.
+    if( isLazyEmissions ) {
+        AGHG::mIsLazyCalc = false;
+        CachedActivity::invalidateAll();
+        mMarketplace->nullSuppliesAndDemands( aPeriod );
+        mWorld->calc( aPeriod );
+    }
 
     mWorld->postCalc( aPeriod );
         
@@ -699,6 +721,8 @@ bool Scenario::solve( const int period ){
     if( !success ) {
         mUnsolvedPeriods.push_back( period );
     }
+    SolverTelemetry::getInstance().flush();
+    EDFunRecorder::getInstance().flush();
     
     return success;
 }
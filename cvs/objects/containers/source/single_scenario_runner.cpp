@@ -48,6 +48,7 @@
 #include "util/base/include/timer.h"
 #include "util/base/include/configuration.h"
 #include "util/base/include/auto_file.h"
+#include "util/base/include/set_data_helper.hpp"
 #include "util/logger/include/ilogger.h"
 #include "util/logger/include/logger_factory.h"
 #include "reporting/include/xml_db_outputter.h"
@@ -58,6 +59,8 @@ using namespace xercesc;
 extern Scenario* scenario;
 extern ofstream outFile;
 
+auto_ptr<Scenario> SingleScenarioRunner::sBaseScenario;
+
 // Function Prototypes. These need a helper class. 
 extern void createMCvarid();
 extern void closeDB();
@@ -100,25 +103,47 @@ bool SingleScenarioRunner::setupScenarios( Timer& timer,
         mainLog << "Early warning Java checks failed and database output was requested" << endl;
         abort();
     }
-    // Ensure that a new scenario is created for each run.
-    mScenario.reset( new Scenario );
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    list<string> scenComponents;
+    if( sBaseScenario.get() ) {
+        // The base inputs have already been parsed so only the scenario
+        // components passed in need to be.
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Using previously parsed base scenario." << endl;
+        mScenario = sBaseScenario;
+        scenario = mScenario.get();
+
+        // Parameter values files were not set into the base scenario.
+        const list<string>& confComponents = conf->getScenarioComponents();
+        for( list<string>::const_iterator currComp = confComponents.begin();
+             currComp != confComponents.end(); ++currComp )
+        {
+            if( SetDataHelper::isCSVFile( *currComp ) ) {
+                scenComponents.push_back( *currComp );
+            }
+        }
+    }
+    else {
+        // Ensure that a new scenario is created for each run.
+        mScenario.reset( new Scenario );
 
-    // Set the global scenario pointer.
-    // TODO: Remove global scenario pointer.
-    scenario = mScenario.get();
+        // Set the global scenario pointer.
+        // TODO: Remove global scenario pointer.
+        scenario = mScenario.get();
 
-    // Parse the input file.
-    bool success =
-        XMLHelper<void>::parseXML( conf->getFile( "xmlInputFileName" ),
-                                   mScenario.get() );
-    
-    // Check if parsing succeeded.
-    if( !success ){
-        return false;
-    }
+        // Parse the input file.
+        bool success =
+            XMLHelper<void>::parseXML( conf->getFile( "xmlInputFileName" ),
+                                       mScenario.get() );
 
-    // Fetch the listing of Scenario Components.
-    list<string> scenComponents = conf->getScenarioComponents();
+        // Check if parsing succeeded.
+        if( !success ){
+            return false;
+        }
+
+        // Fetch the listing of Scenario Components.
+        scenComponents = conf->getScenarioComponents();
+    }
 
     // Add on any scenario components that were passed in.
     for( list<string>::const_iterator curr = aScenComponents.begin();
@@ -127,15 +152,24 @@ bool SingleScenarioRunner::setupScenarios( Timer& timer,
         scenComponents.push_back( *curr );
     }
     
+    // Parameter values from the configuration and any parameter values files
+    // are set once all of the XML scenario components have been parsed.
+    SetDataHelper setParameterValues( conf->getParameterValues() );
+
     // Iterate over the vector.
     typedef list<string>::const_iterator ScenCompIter;
-    ILogger& mainLog = ILogger::getLogger( "main_log" );
     for( ScenCompIter currComp = scenComponents.begin();
 		 currComp != scenComponents.end(); ++currComp )
 	{
+        if( SetDataHelper::isCSVFile( *currComp ) ) {
+            if( !setParameterValues.parseCSV( *currComp ) ) {
+                return false;
+            }
+            continue;
+        }
         mainLog.setLevel( ILogger::NOTICE );
         mainLog << "Parsing " << *currComp << " scenario component." << endl;
-        success = XMLHelper<void>::parseXML( *currComp, mScenario.get() );
+        bool success = XMLHelper<void>::parseXML( *currComp, mScenario.get() );
         
         // Check if parsing succeeded.
         if( !success ){
@@ -152,6 +186,12 @@ bool SingleScenarioRunner::setupScenarios( Timer& timer,
     mainLog.setLevel( ILogger::NOTICE );
     mainLog << "XML parsing complete." << endl;
 
+    if( !setParameterValues.run( mScenario.get() ) ) {
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Failed to set all of the parameter values." << endl;
+        return false;
+    }
+
     // Add to all loggers that a new scenario is starting so that users may more
     // easily parse which scenario the messages pertain to.
     LoggerFactory::logNewScenarioStarting( overrideName );
@@ -254,6 +294,54 @@ void SingleScenarioRunner::cleanup() {
     }
 }
 
+/*!
+ * \brief Parse the base input file and the scenario components listed in the
+ *        configuration into a scenario which the next call to setupScenarios
+ *        on any SingleScenarioRunner will use.
+ * \details This allows a scenario runner which runs many scenarios that share
+ *          the same base inputs, such as the BatchRunner, to pay the cost of
+ *          parsing them only once when each scenario is run in a process which
+ *          is a copy of one that has the base scenario parsed.
+ * \return Whether parsing succeeded.
+ */
+bool SingleScenarioRunner::parseBaseScenario() {
+    const Configuration* conf = Configuration::getInstance();
+    auto_ptr<Scenario> baseScenario( new Scenario );
+
+    // The global scenario pointer must be set during parsing.
+    scenario = baseScenario.get();
+    bool success = XMLHelper<void>::parseXML( conf->getFile( "xmlInputFileName" ),
+                                              baseScenario.get() );
+
+    const list<string> scenComponents = conf->getScenarioComponents();
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    for( list<string>::const_iterator currComp = scenComponents.begin();
+         success && currComp != scenComponents.end(); ++currComp )
+    {
+        // Parameter values files are set into each scenario run instead.
+        if( SetDataHelper::isCSVFile( *currComp ) ) {
+            continue;
+        }
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Parsing " << *currComp << " scenario component." << endl;
+        success = XMLHelper<void>::parseXML( *currComp, baseScenario.get() );
+    }
+    scenario = 0;
+
+    if( success ) {
+        sBaseScenario = baseScenario;
+    }
+    return success;
+}
+
+/*!
+ * \brief Delete the base scenario created by parseBaseScenario if it has not
+ *        been used.
+ */
+void SingleScenarioRunner::clearBaseScenario() {
+    sBaseScenario.reset( 0 );
+}
+
 Scenario* SingleScenarioRunner::getInternalScenario(){
 	return mScenario.get();
 }
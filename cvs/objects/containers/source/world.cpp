@@ -77,6 +77,7 @@
 #include "containers/include/market_dependency_finder.h"
 #include "technologies/include/global_technology_database.h"
 #include "containers/include/iactivity.h"
+#include "containers/include/cached_activity.h"
 
 #if GCAM_PARALLEL_ENABLED
 #include "parallel/include/gcam_parallel.hpp"
@@ -317,6 +318,7 @@ void World::calc( const int aPeriod, const std::vector<IActivity*>& aItemsToCalc
     
     // Increment the world.calc count based on the number of items to solve. 
     mCalcCounter->incrementCount( static_cast<double>( aItemsToCalc.size() ) / static_cast<double>( mGlobalOrdering.size() ) );
+    CachedActivity::startWorldCalc();
     
     // Perform calculation on each item to calculate. 
     for( vector<IActivity*>::const_iterator it = aItemsToCalc.begin(); it != aItemsToCalc.end(); ++it ) {
@@ -348,6 +350,7 @@ void World::calc( const int aPeriod, GcamFlowGraph *aWorkGraph, const vector<IAc
 
     // increment the evaulation count by the fraction of the whole model that we're solving
     mCalcCounter->incrementCount( aCalcList ? (double)(aCalcList->size()) / (double) mGlobalOrdering.size() : 1.0 );
+    CachedActivity::startWorldCalc();
 
     if( !aWorkGraph ) {
         // If a work graph was not provided just use the global flow graph and set the
@@ -834,9 +837,11 @@ void World::accept( IVisitor* aVisitor, const int aPeriod ) const {
     // Visit the climate model.
     mClimateModel->accept( aVisitor, aPeriod );
 
-    // loop for regions
-    for( CRegionIterator currRegion = mRegions.begin(); currRegion != mRegions.end(); ++currRegion ){
-        (*currRegion)->accept( aVisitor, aPeriod );
+    // loop for regions unless the visitor will visit them itself
+    if( !aVisitor->visitRegions( mRegions, aPeriod ) ) {
+        for( CRegionIterator currRegion = mRegions.begin(); currRegion != mRegions.end(); ++currRegion ){
+            (*currRegion)->accept( aVisitor, aPeriod );
+        }
     }
 
     aVisitor->endVisitWorld( this, aPeriod );
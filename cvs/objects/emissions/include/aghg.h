@@ -171,6 +171,12 @@ public:
     
     double getEmission( const int aPeriod ) const;
 
+    bool isSolutionEmission() const;
+
+    //! Flag indicating whether emissions which can not affect the solution are
+    //! skipped by the next call to world->calc()
+    static bool mIsLazyCalc;
+
     virtual void accept( IVisitor* aVisitor, const int aPeriod ) const;
     
     virtual void doInterpolations( const int aYear, const int aPreviousYear,
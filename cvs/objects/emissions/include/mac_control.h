@@ -48,6 +48,7 @@
 
 #include "emissions/include/aemissions_control.h"
 #include "util/base/include/time_vector.h"
+#include "util/base/include/copy_on_write.h"
 
 class PointSetCurve;
 
@@ -75,6 +76,8 @@ public:
                            const NonCO2Emissions* aParentGHG,
                            const int aPeriod );
 
+    PointSetCurve* getMutableMacCurve();
+
 protected:
     MACControl( const MACControl& aOther );
     MACControl& operator=( const MACControl& aOther );
@@ -93,7 +96,7 @@ protected:
         //! Boolean indicating whether reductions should occur at a zero carbon price
         DEFINE_VARIABLE( SIMPLE, "no-zero-cost-reductions", mNoZeroCostReductions, bool ),
         
-        //! The underlying Curve (as read in)
+        //! The underlying Curve (as read in), which is owned by mSharedMacCurve
         DEFINE_VARIABLE( CONTAINER, "mac-reduction", mMacCurve, PointSetCurve* ),
         
         //! Length of time in years to phase in no-cost MAC reductions
@@ -110,7 +113,13 @@ protected:
     // Note ideally this would be included for GCAMFusion with the following definition however it is
     // not currently able to handle smart pointers.
     // DEFINE_VARIABLE( ARRAY, "tech-change", mTechChange, std::shared_ptr<objects::PeriodVector<double> > ),
-    std::shared_ptr<objects::PeriodVector<double> > mTechChange;
+    // The rates are shared with copies of this control until either copy parses
+    // new values.
+    objects::CopyOnWrite<objects::PeriodVector<double> > mTechChange;
+
+    //! The storage for mMacCurve which is shared with copies of this control
+    //! until either copy parses additional points.
+    objects::CopyOnWrite<PointSetCurve, objects::CloneMethodClone<PointSetCurve> > mSharedMacCurve;
 
 private:
     void copy( const MACControl& other );
@@ -49,6 +49,7 @@
 #include "emissions/include/aemissions_control.h"
 #include "util/base/include/value.h"
 #include "util/base/include/time_vector.h"
+#include "util/base/include/copy_on_write.h"
 
 /*! 
  * \ingroup Objects
@@ -98,7 +99,9 @@ protected:
     // Note ideally this would be included for GCAMFusion with the following definition however it is
     // not currently able to handle smart pointers.
     // DEFINE_VARIABLE( ARRAY, "future-emiss-factor", mFutureEmissionsFactors, std::shared_ptr<objects::PeriodVector<double> > ),
-    std::shared_ptr<objects::PeriodVector<double> > mFutureEmissionsFactors;
+    // The factors are shared with copies of this control until either copy parses
+    // new values.
+    objects::CopyOnWrite<objects::PeriodVector<double> > mFutureEmissionsFactors;
 
     void copy( const ReadInControl& aOther );
 };
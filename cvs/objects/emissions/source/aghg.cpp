@@ -62,6 +62,8 @@ using namespace xercesc;
 
 extern Scenario* scenario;
 
+bool AGHG::mIsLazyCalc = false;
+
 //! Default constructor.
 AGHG::AGHG()
 {
@@ -165,6 +167,21 @@ void AGHG::initCalc( const string& aRegionName, const IInfo* aLocalInfo, const i
     mCachedMarket = scenario->getMarketplace()->locateMarket( getName(), aRegionName, aPeriod );
 }
 
+/*!
+ * \brief Whether the emissions must be calculated during the solution.
+ * \details The emissions of a gas only affect the solution through the demand
+ *          of its market in the region, such as a policy or constraint market.
+ *          Gases without one are only needed for reporting and the climate
+ *          model so may be skipped while solving when mIsLazyCalc is set.
+ *          Note that the price of the gas, if any, is still included in the
+ *          cost of the technology.
+ * \pre initCalc has located the market for the period.
+ * \return True if calcEmission must be called during the solution.
+ */
+bool AGHG::isSolutionEmission() const {
+    return !mIsLazyCalc || mCachedMarket->hasMarket();
+}
+
 /*!
  * \brief Sets the emissions as the demand side of the gas market.
  * \param aRegionName the region to set
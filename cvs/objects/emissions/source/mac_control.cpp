@@ -69,19 +69,21 @@ mTechChange( new objects::PeriodVector<double>( 0.0 ) ),
 mZeroCostPhaseInTime( 25 ),
 mCovertPriceValue( 1 ),
 mPriceMarketName( "CO2" ),
-mMacCurve( new PointSetCurve( new ExplicitPointSet() ) )
+mSharedMacCurve( new PointSetCurve( new ExplicitPointSet() ) )
 {
+    mMacCurve = mSharedMacCurve.getSharedPointer();
 }
 
 //! Default destructor.
 MACControl::~MACControl(){
-    delete mMacCurve;
 }
 
 //! Copy constructor.
 MACControl::MACControl( const MACControl& aOther )
-: AEmissionsControl( aOther ) {
-    mMacCurve = 0;
+: AEmissionsControl( aOther ),
+mTechChange( aOther.mTechChange ),
+mSharedMacCurve( aOther.mSharedMacCurve )
+{
     copy( aOther );
 }
 
@@ -93,10 +95,6 @@ MACControl* MACControl::clone() const {
 //! Assignment operator.
 MACControl& MACControl::operator=( const MACControl& aOther ){
     if( this != &aOther ){
-        // Free memory before copying.  Since this is just a single
-        // variable I am just deleting it directly here.
-        delete mMacCurve;
-        mMacCurve = 0;
         AEmissionsControl::operator=( aOther );
         copy( aOther );
     }
@@ -105,11 +103,10 @@ MACControl& MACControl::operator=( const MACControl& aOther ){
 
 //! Copy helper function.
 void MACControl::copy( const MACControl& aOther ){
-    /*!
-     * \pre mMacCurve should be null otherwise we have a memory leak.
-     */
-    assert( !mMacCurve );
-    mMacCurve = aOther.mMacCurve->clone();
+    // Share the curve rather than cloning it, a private copy will be made
+    // if additional points are parsed.
+    mSharedMacCurve = aOther.mSharedMacCurve;
+    mMacCurve = mSharedMacCurve.getSharedPointer();
     mNoZeroCostReductions = aOther.mNoZeroCostReductions;
     mTechChange = aOther.mTechChange;
     mZeroCostPhaseInTime = aOther.mZeroCostPhaseInTime;
@@ -140,13 +137,14 @@ bool MACControl::XMLDerivedClassParse( const string& aNodeName, const DOMNode* a
         double taxVal = XMLHelper<double>::getAttr( aCurrNode, "tax" );
         double reductionVal = XMLHelper<double>::getValue( aCurrNode );
         XYDataPoint* currPoint = new XYDataPoint( taxVal, reductionVal );
+        mMacCurve = &mSharedMacCurve.getMutable();
         mMacCurve->getPointSet()->addPoint( currPoint );
     }
     else if ( aNodeName == "no-zero-cost-reductions" ){
         mNoZeroCostReductions = true;
     }
     else if ( aNodeName == "tech-change" ){
-        XMLHelper<double>::insertValueIntoVector( aCurrNode, *mTechChange, modeltime );
+        XMLHelper<double>::insertValueIntoVector( aCurrNode, mTechChange.getMutable(), modeltime );
     }
     else if ( aNodeName == "zero-cost-phase-in-time" ){
         mZeroCostPhaseInTime = XMLHelper<int>::getValue( aCurrNode );
@@ -163,6 +161,17 @@ bool MACControl::XMLDerivedClassParse( const string& aNodeName, const DOMNode* a
     return true;
 }
 
+/*!
+ * \brief Get the MAC curve in order to change it.
+ * \details The curve is shared with copies of this control so a private copy
+ *          is made first if needed, which mMacCurve is then pointed to.
+ * \return The curve which only this control references.
+ */
+PointSetCurve* MACControl::getMutableMacCurve() {
+    mMacCurve = &mSharedMacCurve.getMutable();
+    return mMacCurve;
+}
+
 void MACControl::toDebugXMLDerived( const int period, ostream& aOut, Tabs* aTabs ) const {
     const vector<pair<double,double> > pairs = mMacCurve->getSortedPairs();
     typedef vector<pair<double, double> >::const_iterator PairIterator;
@@ -72,7 +72,8 @@ ReadInControl::~ReadInControl(){
 
 //! Copy constructor.
 ReadInControl::ReadInControl( const ReadInControl& aOther )
-: AEmissionsControl( aOther )
+: AEmissionsControl( aOther ),
+mFutureEmissionsFactors( aOther.mFutureEmissionsFactors )
 {
     copy( aOther );
 }
@@ -116,7 +117,7 @@ const string& ReadInControl::getXMLNameStatic(){
 bool ReadInControl::XMLDerivedClassParse( const string& aNodeName, const DOMNode* aCurrNode ){
     const Modeltime* modeltime = scenario->getModeltime();
     if ( aNodeName == "future-emiss-factor" ){
-        XMLHelper<double>::insertValueIntoVector( aCurrNode, *mFutureEmissionsFactors, modeltime );
+        XMLHelper<double>::insertValueIntoVector( aCurrNode, mFutureEmissionsFactors.getMutable(), modeltime );
     }
     else{
         return false;
@@ -107,6 +107,15 @@ public:
                                 const double aCapitalStock,
                                 const double aAlphaZero,
                                 const double aSigma ) const;
+
+    static double calcLevelizedCostFlat( const double* aPrices, const double* aCoefs,
+                                         const size_t aNumInputs, const double aAlphaZero,
+                                         const double aSigma );
+
+    static double calcDemandFlat( const double* aPrices, const double* aCoefs,
+                                  const size_t aNumInputs, const double aOutput,
+                                  const double aOutputPrice, const double aAlphaZero,
+                                  const double aSigma, double* aDemands );
 private:
     double calcCapitalScaler( const InputSet& input, double aAlphaZero, double sigma,
                               double capitalStock, const int aPeriod ) const;
@@ -114,7 +123,7 @@ private:
     double calcIORatio( const InputSet::value_type aInput, const std::string& aRegionName, const int aPeriod,
                                 const double aAlphaZero, const double aParentPrice, const double aSigma ) const;
 
-    inline double pow1( double base, double exp ) const;
+    static inline double pow1( double base, double exp );
 };
 
 #endif // _NESTED_CES_PRODUCTION_FUNCTION_H_
@@ -46,6 +46,7 @@
 */
 
 #include "util/base/include/definitions.h"
+#include <vector>
 
 #include "functions/include/inested_input.h"
 #include "util/base/include/value.h"
@@ -362,11 +363,60 @@ protected:
                            
     //! Hack to avoiding excessive levelized cost calcs to help performance.
     bool mNodePriceSet;
+
+    //! A nested CES node of the flattened nest.
+    struct FlatNestNode {
+        //! The node input.
+        NodeInput* mNode;
+
+        //! The index of the node's first child in the flattened slots.
+        size_t mSlotBegin;
+
+        //! One past the index of the node's last child in the flattened slots.
+        size_t mSlotEnd;
+    };
+
+    //! A child input in the flattened nest.
+    struct FlatNestSlot {
+        //! The child input.
+        INestedInput* mInput;
+
+        //! The child if it is a node of the flattened nest, otherwise null and
+        //! the child calculates its own subtree.
+        NodeInput* mNode;
+    };
+
+    //! The nested CES nodes below and including the root in pre-order so
+    //! that parents come before their children.  Only set for the root.
+    std::vector<FlatNestNode> mFlatNestNodes;
+
+    //! The children of the flattened nodes, contiguous for each node.
+    std::vector<FlatNestSlot> mFlatNestSlots;
+
+    //! The indices of the flattened slots in the order the recursive
+    //! calculation visits them, left to right with each child node's
+    //! subtree directly following it.
+    std::vector<size_t> mFlatNestVisitOrder;
                            
     typedef std::vector<INestedInput*>::iterator NestedInputIterator;
     typedef std::vector<INestedInput*>::const_iterator CNestedInputIterator;
     
     void copy( const NodeInput& aNodeInput );
+
+    bool isNestedCES() const;
+
+    void appendFlatNest( std::vector<FlatNestNode>& aNodes, std::vector<FlatNestSlot>& aSlots,
+                         std::vector<size_t>& aVisitOrder );
+
+    void calcFlatLevelizedCost( const std::string& aRegionName, const std::string& aSectorName,
+        const int aPeriod, const double aAlphaZero );
+
+    double calcFlatInputDemand( const std::string& aRegionName, const std::string& aSectorName,
+        const int aPeriod, const double aPhysicalOutput, const double aUtilityParameterA,
+        const double aAlphaZero );
+
+    double calcFlatNodeDemand( const FlatNestNode& aNode, const std::string& aRegionName,
+        const int aPeriod, const double aPhysicalOutput, const double aAlphaZero, double* aValues );
 };
 
 #endif // _NODE_INPUT_H_
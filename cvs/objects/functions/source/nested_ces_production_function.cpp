@@ -203,6 +203,75 @@ double NestedCESProductionFunction::calcLevelizedCost( const InputSet& aInputs,
     return currLevelizedCost;
 }
 
+/*!
+ * \brief Calculate the levelized cost of a node from contiguous arrays of the
+ *        price paid and coefficient of its inputs.
+ * \details Equivalent to calcLevelizedCost but reads the inputs' values from
+ *          arrays gathered by the caller so that the loop over the inputs
+ *          does not make virtual calls and may be vectorized.
+ * \param aPrices The price paid of each input.
+ * \param aCoefs The coefficient of each input.
+ * \param aNumInputs The number of inputs.
+ * \param aAlphaZero The alpha zero of the node.
+ * \param aSigma The elasticity of substitution of the node.
+ * \return The levelized cost of the node.
+ * \sa NodeInput::calcLevelizedCost
+ */
+double NestedCESProductionFunction::calcLevelizedCostFlat( const double* aPrices, const double* aCoefs,
+                                                           const size_t aNumInputs, const double aAlphaZero,
+                                                           const double aSigma )
+{
+    const double r = 1 - aSigma;
+    double currLevelizedCost = 0.0;
+    for( size_t i = 0; i < aNumInputs; ++i ) {
+        currLevelizedCost += pow1( aPrices[ i ] / aCoefs[ i ], r );
+    }
+    return pow1( currLevelizedCost, 1 / r ) / aAlphaZero;
+}
+
+/*!
+ * \brief Calculate the demands for the inputs of a node from contiguous arrays
+ *        of their price paid and coefficient.
+ * \details Equivalent to calcDemand with a shutdown coefficient of one but
+ *          reads the inputs' values from arrays gathered by the caller and
+ *          writes the demands to an array which the caller must set into the
+ *          inputs.
+ * \param aPrices The price paid of each input.
+ * \param aCoefs The coefficient of each input.
+ * \param aNumInputs The number of inputs.
+ * \param aOutput The output of the node.
+ * \param aOutputPrice The price of the node.
+ * \param aAlphaZero The alpha zero of the node.
+ * \param aSigma The elasticity of substitution of the node.
+ * \param aDemands The array in which to return the demand for each input.
+ * \return The total demand of the inputs.
+ * \sa NodeInput::calcInputDemand
+ */
+double NestedCESProductionFunction::calcDemandFlat( const double* aPrices, const double* aCoefs,
+                                                    const size_t aNumInputs, const double aOutput,
+                                                    const double aOutputPrice, const double aAlphaZero,
+                                                    const double aSigma, double* aDemands )
+{
+    // optimazation to speed up calculations when sigma is zero
+    if( aSigma == 0 ) {
+        for( size_t i = 0; i < aNumInputs; ++i ) {
+            aDemands[ i ] = ( 1 / aCoefs[ i ] ) * aOutput;
+        }
+    }
+    else {
+        for( size_t i = 0; i < aNumInputs; ++i ) {
+            const double ioRatio = pow( aAlphaZero * aCoefs[ i ], aSigma - 1 ) *
+                pow( aOutputPrice / aPrices[ i ], aSigma );
+            aDemands[ i ] = aPrices[ i ] != 0 ? ioRatio * aOutput : 0;
+        }
+    }
+    double totalDemand = 0.0;
+    for( size_t i = 0; i < aNumInputs; ++i ) {
+        totalDemand += aDemands[ i ];
+    }
+    return totalDemand;
+}
+
 double NestedCESProductionFunction::calcUnscaledProfits( const InputSet& aInputs, 
                                 const std::string& aRegionName,
                                 const std::string& aSectorName,
@@ -252,6 +321,6 @@ double NestedCESProductionFunction::calcIORatio( const InputSet::value_type aInp
  * \param exp The power to raise by.
  * \return base ^ exp.
  */
-inline double NestedCESProductionFunction::pow1( double base, double exp ) const {
+inline double NestedCESProductionFunction::pow1( double base, double exp ) {
     return exp != 1 ? pow( base, exp ) : base;
 }
@@ -45,6 +45,7 @@
 
 #include "functions/include/node_input.h"
 #include "functions/include/ifunction.h"
+#include "functions/include/nested_ces_production_function.h"
 #include "functions/include/production_input.h"
 #include "functions/include/demand_input.h"
 #include "functions/include/trade_input.h"
@@ -219,6 +220,62 @@ void NodeInput::initCalc( const string& aRegionName,
     }
     // initialized the hack
     mNodePriceSet = false;
+
+    // Flatten the nested CES nodes below the root so that their levelized costs
+    // and demands are calculated in passes over contiguous arrays rather than
+    // by recursion.
+    mFlatNestNodes.clear();
+    mFlatNestSlots.clear();
+    mFlatNestVisitOrder.clear();
+    if( mName == "root" && isNestedCES() ) {
+        appendFlatNest( mFlatNestNodes, mFlatNestSlots, mFlatNestVisitOrder );
+    }
+}
+
+/*!
+ * \brief Whether this node uses the nested CES function which the flattened
+ *        nest calculations implement.
+ * \return True if the node uses the nested CES function.
+ */
+bool NodeInput::isNestedCES() const {
+    return dynamic_cast<const NestedCESProductionFunction*>( mProdDmdFn ) != 0;
+}
+
+/*!
+ * \brief Append this node and the nested CES nodes below it to the flattened
+ *        nest in pre-order.
+ * \details Children which are not nested CES nodes, such as leaves or building
+ *          nodes, are kept as slots which calculate their own subtree.  The
+ *          children are visited left to right so that the flattened
+ *          calculations have the same order of side effects as the recursive
+ *          ones.
+ * \param aNodes The flattened nodes to append to.
+ * \param aSlots The flattened child slots to append to.
+ * \param aVisitOrder The order in which the recursive calculation visits the
+ *                    slots to append to.
+ */
+void NodeInput::appendFlatNest( vector<FlatNestNode>& aNodes, vector<FlatNestSlot>& aSlots,
+                                vector<size_t>& aVisitOrder )
+{
+    FlatNestNode node;
+    node.mNode = this;
+    node.mSlotBegin = aSlots.size();
+    for( unsigned int i = 0; i < mNestedInputs.size(); ++i ) {
+        NodeInput* childNode = dynamic_cast<NodeInput*>( mNestedInputs[ i ] );
+        FlatNestSlot slot;
+        slot.mInput = mNestedInputs[ i ];
+        slot.mNode = childNode && childNode->isNestedCES() ? childNode : 0;
+        aSlots.push_back( slot );
+    }
+    node.mSlotEnd = aSlots.size();
+    aNodes.push_back( node );
+
+    for( size_t i = node.mSlotBegin; i < node.mSlotEnd; ++i ) {
+        aVisitOrder.push_back( i );
+        if( aSlots[ i ].mNode ) {
+            aSlots[ i ].mNode->appendFlatNest( aNodes, aSlots, aVisitOrder );
+        }
+    }
 }
 
 void NodeInput::copyParam( const IInput* aInput,
@@ -370,6 +427,11 @@ void NodeInput::removeEmptyInputs() {
     const int BASE_PERIOD = modeltime->getBasePeriod();
     double currNodeDemand = 0;
 
+    // The flattened nest may refer to removed inputs and will be rebuilt by initCalc.
+    mFlatNestNodes.clear();
+    mFlatNestSlots.clear();
+    mFlatNestVisitOrder.clear();
+
     for( NestedInputIterator nestedInputIter = mNestedInputs.begin(); 
         nestedInputIter != mNestedInputs.end(); )
     {
@@ -489,29 +551,83 @@ void NodeInput::calcLevelizedCost( const std::string& aRegionName, const std::st
     if( mNodePriceSet ) {
         return;
     }
-    // have children calculate their levelized costs first
-    // the leaves are assumed to already have calculated their appropriate price paid
-    for( NestedInputIterator it = mNestedInputs.begin(); it != mNestedInputs.end(); ++it ) {
-        (*it)->calcLevelizedCost( aRegionName, aSectorName, aPeriod, aAlphaZero );
+    if( !mFlatNestNodes.empty() ) {
+        calcFlatLevelizedCost( aRegionName, aSectorName, aPeriod, aAlphaZero );
     }
+    else {
+        // have children calculate their levelized costs first
+        // the leaves are assumed to already have calculated their appropriate price paid
+        for( NestedInputIterator it = mNestedInputs.begin(); it != mNestedInputs.end(); ++it ) {
+            (*it)->calcLevelizedCost( aRegionName, aSectorName, aPeriod, aAlphaZero );
+        }
 
-    // use the function to calculate our levelized costs
-    double tempPrice = mProdDmdFn->calcLevelizedCost( mChildInputsCache, aRegionName, aSectorName, aPeriod,
-        aAlphaZero, mCurrentSigma );
+        // use the function to calculate our levelized costs
+        double tempPrice = mProdDmdFn->calcLevelizedCost( mChildInputsCache, aRegionName, aSectorName, aPeriod,
+            aAlphaZero, mCurrentSigma );
 
-    setPricePaid( tempPrice, aPeriod );
+        setPricePaid( tempPrice, aPeriod );
+
+        // We need to store the base year price paids since they are require to adjust our coefficients
+        // with new sigmas in the future.  Note this may be inconsistent if the base year was not read in
+        // balanced.
+        if ( aPeriod == 0 ){
+            mBasePricePaid = tempPrice;
+        }
+    }
 
     // we only set the hack for the root so that we don't have to recurse through
     // the nest when it comes time to reset this flag
     if( mName == "root" ) {
         mNodePriceSet = true;
     }
+}
 
-    // We need to store the base year price paids since they are require to adjust our coefficients
-    // with new sigmas in the future.  Note this may be inconsistent if the base year was not read in
-    // balanced.
-    if ( aPeriod == 0 ){
-        mBasePricePaid = tempPrice;
+/*!
+ * \brief Calculate the levelized costs of the flattened nest.
+ * \details Gathers the price paid and coefficient of each child into
+ *          contiguous arrays and calculates the nodes in reverse pre-order so
+ *          that each child node's price is known before its parent's.
+ *          Children which are not flattened calculate their own subtree first
+ *          in the order the recursive calculation would.
+ * \param aRegionName Region name.
+ * \param aSectorName Sector name.
+ * \param aPeriod Model period.
+ * \param aAlphaZero The root's alpha zero.
+ */
+void NodeInput::calcFlatLevelizedCost( const std::string& aRegionName, const std::string& aSectorName,
+        const int aPeriod, const double aAlphaZero )
+{
+    // These are local rather than members since the nest may be calculated
+    // concurrently for different states.
+    const size_t numSlots = mFlatNestSlots.size();
+    vector<double> values( 2 * numSlots );
+    double* prices = values.data();
+    double* coefs = prices + numSlots;
+    for( vector<size_t>::const_iterator it = mFlatNestVisitOrder.begin(); it != mFlatNestVisitOrder.end(); ++it ) {
+        const FlatNestSlot& slot = mFlatNestSlots[ *it ];
+        if( !slot.mNode ) {
+            slot.mInput->calcLevelizedCost( aRegionName, aSectorName, aPeriod, aAlphaZero );
+            prices[ *it ] = slot.mInput->getPricePaid( aRegionName, aPeriod );
+            coefs[ *it ] = slot.mInput->getCoefficient( aPeriod );
+        }
+    }
+
+    for( vector<FlatNestNode>::const_reverse_iterator nodeIter = mFlatNestNodes.rbegin(); nodeIter != mFlatNestNodes.rend(); ++nodeIter ) {
+        for( size_t i = nodeIter->mSlotBegin; i < nodeIter->mSlotEnd; ++i ) {
+            const NodeInput* childNode = mFlatNestSlots[ i ].mNode;
+            if( childNode ) {
+                prices[ i ] = childNode->mPricePaid;
+                coefs[ i ] = childNode->mAlphaCoef;
+            }
+        }
+        NodeInput* node = nodeIter->mNode;
+        double tempPrice = NestedCESProductionFunction::calcLevelizedCostFlat( prices + nodeIter->mSlotBegin,
+            coefs + nodeIter->mSlotBegin, nodeIter->mSlotEnd - nodeIter->mSlotBegin, aAlphaZero, node->mCurrentSigma );
+
+        node->setPricePaid( tempPrice, aPeriod );
+        if ( aPeriod == 0 ){
+            node->mBasePricePaid = tempPrice;
+        }
     }
 }
 
@@ -559,6 +675,11 @@ double NodeInput::calcInputDemand( const std::string& aRegionName, const std::st
         const int aPeriod, const double aPhysicalOutput, const double aUtilityParameterA,
         const double aAlphaZero )
 {
+    if( !mFlatNestNodes.empty() ) {
+        return calcFlatInputDemand( aRegionName, aSectorName, aPeriod, aPhysicalOutput, aUtilityParameterA,
+            aAlphaZero );
+    }
+
     // first calculate the demands for the direct children
     double retDemand = mProdDmdFn->calcDemand( mChildInputsCache, aPhysicalOutput, aRegionName, aSectorName, 1,
         aPeriod, aUtilityParameterA, aAlphaZero, mCurrentSigma, mPricePaid );
@@ -574,6 +695,93 @@ double NodeInput::calcInputDemand( const std::string& aRegionName, const std::st
     return retDemand;
 }
 
+/*!
+ * \brief Calculate the input demands of the flattened nest.
+ * \details Distributes the root's demand to its children and then visits the
+ *          slots in the same left to right pre-order as the recursive
+ *          calculation: a child node distributes its demand to its own
+ *          children when visited and a child which is not flattened
+ *          distributes its demand through its own subtree.  This keeps the
+ *          order in which demands are added to markets, and so the results,
+ *          identical to the recursive calculation.
+ * \param aRegionName Region name.
+ * \param aSectorName Sector name.
+ * \param aPeriod Model period.
+ * \param aPhysicalOutput The output of the root.
+ * \param aUtilityParameterA Utility parameter passed on to children which are
+ *                           not flattened.
+ * \param aAlphaZero The root's alpha zero.
+ * \return The total demand of the root's children.
+ */
+double NodeInput::calcFlatInputDemand( const std::string& aRegionName, const std::string& aSectorName,
+        const int aPeriod, const double aPhysicalOutput, const double aUtilityParameterA,
+        const double aAlphaZero )
+{
+    vector<double> values( 3 * mFlatNestSlots.size() );
+    const double retDemand = calcFlatNodeDemand( mFlatNestNodes.front(), aRegionName, aPeriod, aPhysicalOutput,
+        aAlphaZero, values.data() );
+
+    // Child nodes appear in the visit order in the same pre-order as the
+    // flattened nodes, following the root.
+    vector<FlatNestNode>::const_iterator nodeIter = mFlatNestNodes.begin() + 1;
+    for( vector<size_t>::const_iterator it = mFlatNestVisitOrder.begin(); it != mFlatNestVisitOrder.end(); ++it ) {
+        const FlatNestSlot& slot = mFlatNestSlots[ *it ];
+        if( slot.mNode ) {
+            assert( nodeIter != mFlatNestNodes.end() && nodeIter->mNode == slot.mNode );
+            calcFlatNodeDemand( *nodeIter, aRegionName, aPeriod, slot.mNode->getPhysicalDemand( aPeriod ),
+                aAlphaZero, values.data() );
+            ++nodeIter;
+        }
+        else {
+            slot.mInput->calcInputDemand( aRegionName, aSectorName, aPeriod,
+                slot.mInput->getPhysicalDemand( aPeriod ), aUtilityParameterA, aAlphaZero );
+        }
+    }
+    return retDemand;
+}
+
+/*!
+ * \brief Distribute the demand of one node of the flattened nest to its
+ *        children.
+ * \param aNode The flattened node.
+ * \param aRegionName Region name.
+ * \param aPeriod Model period.
+ * \param aPhysicalOutput The output of the node.
+ * \param aAlphaZero The root's alpha zero.
+ * \param aValues Scratch space of three values per flattened slot.
+ * \return The total demand of the node's children.
+ */
+double NodeInput::calcFlatNodeDemand( const FlatNestNode& aNode, const std::string& aRegionName,
+        const int aPeriod, const double aPhysicalOutput, const double aAlphaZero, double* aValues )
+{
+    const size_t numSlots = mFlatNestSlots.size();
+    double* prices = aValues;
+    double* coefs = prices + numSlots;
+    double* demands = coefs + numSlots;
+    const size_t slotBegin = aNode.mSlotBegin;
+    const size_t slotEnd = aNode.mSlotEnd;
+    for( size_t i = slotBegin; i < slotEnd; ++i ) {
+        const FlatNestSlot& slot = mFlatNestSlots[ i ];
+        if( slot.mNode ) {
+            prices[ i ] = slot.mNode->mPricePaid;
+            coefs[ i ] = slot.mNode->mAlphaCoef;
+        }
+        else {
+            prices[ i ] = slot.mInput->getPricePaid( aRegionName, aPeriod );
+            coefs[ i ] = slot.mInput->getCoefficient( aPeriod );
+        }
+    }
+
+    const NodeInput* node = aNode.mNode;
+    const double totalDemand = NestedCESProductionFunction::calcDemandFlat( prices + slotBegin, coefs + slotBegin,
+        slotEnd - slotBegin, aPhysicalOutput, node->mPricePaid, aAlphaZero, node->mCurrentSigma, demands + slotBegin );
+
+    for( size_t i = slotBegin; i < slotEnd; ++i ) {
+        mFlatNestSlots[ i ].mInput->setPhysicalDemand( demands[ i ], aRegionName, aPeriod );
+    }
+    return totalDemand;
+}
+
 double NodeInput::calcCapitalOutputRatio( const std::string& aRegionName, const std::string& aSectorName,
         const int aPeriod, const double aAlphaZero ) {
     /*
@@ -332,6 +332,22 @@ public:
                                    IDiscreteChoice* aChoiceFnAbove,
                                    const int aPeriod ) = 0;
 
+    /*!
+     * \brief Determine which parts of the tree need their shares recalculated.
+     * \details A leaf has changed if its profit rate or share-weight differ from
+     *          those its share was last calculated with.  A node records whether
+     *          any leaf below it has changed so that calcLandShares can skip the
+     *          subtrees which have not, their shares and node profit rates are
+     *          still those of the last calculation.  All children are visited
+     *          so that every node is updated.
+     * \param aForceChanged Whether to consider every item changed which will
+     *                      force a full recalculation.
+     * \param aPeriod Model period.
+     * \return Whether this item or any item below it has changed.
+     */
+    virtual bool updateChangedSubtree( const bool aForceChanged,
+                                       const int aPeriod ) = 0;
+
     /*!
      * \brief Calculates the land allocation for all items in the land
      *        allocation tree.
@@ -155,6 +155,10 @@ protected:
     )
 
 private:
+    //! Whether shares should only be recalculated for the subtrees in which a
+    //! profit rate or share-weight changed after the calibration periods.
+    bool mIsIncrementalShares;
+
     void calibrateLandAllocator( const std::string& aRegionName, const int aPeriod );
 
     void checkLandArea( const std::string& aRegionName, const int aPeriod );
@@ -110,6 +110,9 @@ public:
                                    IDiscreteChoice* aChoiceFnAbove,
                                    const int aPeriod );
 
+    virtual bool updateChangedSubtree( const bool aForceChanged,
+                                       const int aPeriod );
+
     virtual void calcLandAllocation( const std::string& aRegionName,
                                      const double aLandAllocationAbove,
                                      const int aPeriod );
@@ -181,7 +184,13 @@ protected:
         DEFINE_VARIABLE( ARRAY, "parsed-landAllocation", mReadinLandAllocation, objects::PeriodVector<Value> ),
                             
         //! State value necessary to use Marketplace::addToDemand for CO2 emissions
-        DEFINE_VARIABLE( SIMPLE | STATE, "luc-state", mLastCalcCO2Value, Value )
+        DEFINE_VARIABLE( SIMPLE | STATE, "luc-state", mLastCalcCO2Value, Value ),
+
+        //! The profit rate the share of this leaf was last calculated with.
+        DEFINE_VARIABLE( ARRAY | STATE, "share-profit-rate", mShareProfitRate, objects::PeriodVector<Value> ),
+
+        //! The share-weight the share of this leaf was last calculated with.
+        DEFINE_VARIABLE( ARRAY | STATE, "share-share-weight", mShareShareWeight, objects::PeriodVector<Value> )
     )
 
     double getCarbonSubsidy( const std::string& aRegionName,
@@ -127,6 +127,9 @@ public:
                                    IDiscreteChoice* aChoiceFnAbove,
                                    const int aPeriod );
 
+    virtual bool updateChangedSubtree( const bool aForceChanged,
+                                       const int aPeriod );
+
     virtual void calcLandAllocation( const std::string& aRegionName,
                                      const double aLandAllocationAbove,
                                      const int aPeriod );
@@ -195,7 +198,12 @@ protected:
 
         //! (optional) A carbon calculation which can used when children maybe similar
         //! in terms of switching between them does not mean carbon is emitted per se.
-        DEFINE_VARIABLE( CONTAINER, "node-carbon-calc", mCarbonCalc, NodeCarbonCalc* )
+        DEFINE_VARIABLE( CONTAINER, "node-carbon-calc", mCarbonCalc, NodeCarbonCalc* ),
+
+        //! Whether any leaf below this node has changed since shares were last
+        //! calculated (1) or not (0) as set by updateChangedSubtree.  This is
+        //! state so that each partial derivative tracks its own changes.
+        DEFINE_VARIABLE( SIMPLE | STATE, "has-changed-subtree", mHasChangedSubtree, Value )
     )
 };
 
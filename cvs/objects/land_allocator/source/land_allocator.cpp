@@ -59,7 +59,8 @@ extern Scenario* scenario;
  * \author James Blackwood
  */
 LandAllocator::LandAllocator()
-: LandNode( 0 )
+: LandNode( 0 ),
+mIsIncrementalShares( false )
 {
     mCarbonPriceIncreaseRate.assign( mCarbonPriceIncreaseRate.size(), 0.0 );
     mSoilTimeScale = CarbonModelUtils::getSoilTimeScale();
@@ -152,6 +153,8 @@ void LandAllocator::completeInit( const string& aRegionName,
 
     // Set the soil time scale
     setSoilTimeScale( mSoilTimeScale );
+
+    mIsIncrementalShares = Configuration::getInstance()->getBool( "incremental-land-allocation", true, false );
 }
 
 
@@ -308,6 +311,13 @@ double LandAllocator::calcLandShares( const string& aRegionName,
     // First set value of unmanaged land leaves
     setUnmanagedLandProfitRate( aRegionName, mUnManagedLandValue, aPeriod );
 
+    // Find the subtrees in which a profit rate changed since the last
+    // calculation so that only those are recalculated.  During calibration
+    // share-weights are being set so always recalculate everything.
+    const bool isIncremental = mIsIncrementalShares &&
+        aPeriod > scenario->getModeltime()->getFinalCalibrationPeriod();
+    updateChangedSubtree( !isIncremental, aPeriod );
+
     LandNode::calcLandShares( aRegionName, aChoiceFnAbove, aPeriod );
  
     // This is the root node so its share is 100%.
@@ -434,9 +434,22 @@ double LandLeaf::calcLandShares( const string& aRegionName,
     // result should be > 0 if we have a non-zero share-weight (it is -infinity when zero)
     assert( mShareWeight[ aPeriod ] == 0.0 || unnormalizedShare >= 0.0 );
 
+    // Remember what the share was calculated with so that we can tell if it
+    // will need to be recalculated.
+    mShareProfitRate[ aPeriod ] = mProfitRate[ aPeriod ];
+    mShareShareWeight[ aPeriod ] = mShareWeight[ aPeriod ];
+
     return unnormalizedShare; 
 }
 
+bool LandLeaf::updateChangedSubtree( const bool aForceChanged,
+                                     const int aPeriod )
+{
+    return aForceChanged || !mShareProfitRate[ aPeriod ].isInited()
+        || mShareProfitRate[ aPeriod ] != mProfitRate[ aPeriod ]
+        || mShareShareWeight[ aPeriod ] != mShareWeight[ aPeriod ];
+}
+
 
 /*!
 * \brief Calculates the land allocated to a particular type
@@ -70,7 +70,8 @@ LandNode::LandNode( const ALandAllocatorItem* aParent )
 mChoiceFn( 0 ),
 mUnManagedLandValue( 0.0 ),
 mLandUseHistory( 0 ),
-mCarbonCalc( 0 )
+mCarbonCalc( 0 ),
+mHasChangedSubtree( 1.0 )
 {
 }
 
@@ -340,6 +341,12 @@ double LandNode::calcLandShares( const string& aRegionName,
                                  IDiscreteChoice* aChoiceFnAbove,
                                  const int aPeriod )
 {
+    // Nothing below this node has changed so the shares of the children and
+    // the node profit rate from the last calculation still hold, skip directly
+    // to Step 4.
+    if( mHasChangedSubtree == 0.0 ) {
+        return aChoiceFnAbove->calcUnnormalizedShare( mShareWeight[ aPeriod ], mProfitRate[ aPeriod ], aPeriod );
+    }
 
     vector<double> unnormalizedShares( mChildren.size() );
 
@@ -374,6 +381,20 @@ double LandNode::calcLandShares( const string& aRegionName,
     return unnormalizedShareAbove; // the unnormalized share of this node.
 }
 
+bool LandNode::updateChangedSubtree( const bool aForceChanged,
+                                     const int aPeriod )
+{
+    bool hasChanged = aForceChanged;
+    for ( unsigned int i = 0; i < mChildren.size(); i++ ) {
+        // Note all children must be updated.
+        if( mChildren[ i ]->updateChangedSubtree( aForceChanged, aPeriod ) ) {
+            hasChanged = true;
+        }
+    }
+    mHasChangedSubtree = hasChanged ? 1.0 : 0.0;
+    return hasChanged;
+}
+
 void LandNode::calculateShareWeights( const string& aRegionName, 
                                       IDiscreteChoice* aChoiceFnAbove,
                                       const int aPeriod,
@@ -75,6 +75,21 @@
 #include "util/logger/include/logger_factory.h"
 #include "util/base/include/timer.h"
 #include "util/base/include/version.h"
+#include "containers/include/single_scenario_runner.h"
+#include "containers/include/batch_runner.h"
+#include "util/base/include/set_data_helper.hpp"
+#include "util/base/include/util.h"
+#include "reporting/include/batch_csv_outputter.h"
+
+#if !defined(_WIN32)
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 using namespace xercesc;
@@ -87,8 +102,12 @@ ofstream outFile;
 // Declared outside Main to make global.
 Scenario* scenario; // model scenario info
 
-void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFacArg );
+void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFacArg, string& paramArg, bool& serverArg );
 void printUsageMessage( unsigned int argc, char* argv[] );
+int runServer( IScenarioRunner* aRunner, Timer& aTimer );
+#if !defined(_WIN32)
+void writeServerResponse( const int aFD, const string& aResponse );
+#endif
 
 //! Main program. 
 int main( int argc, char *argv[] ) {
@@ -96,8 +115,10 @@ int main( int argc, char *argv[] ) {
     // identify default file names for control input and logging controls
     string configurationArg = "configuration.xml";
     string loggerFactoryArg = "log_conf.xml";
+    string parameterValuesArg;
+    bool serverArg = false;
     // Parse any command line arguments.  Can override defaults with command lone args
-    parseArgs( argc, argv, configurationArg, loggerFactoryArg );
+    parseArgs( argc, argv, configurationArg, loggerFactoryArg, parameterValuesArg, serverArg );
 
     // Add OS dependent prefixes to the arguments.
     const string configurationFileName = configurationArg;
@@ -167,6 +188,17 @@ int main( int argc, char *argv[] ) {
         return 1;
     }
 
+    // Add any parameter values to set into each scenario given on the command line.
+    if( !parameterValuesArg.empty() ) {
+        list<pair<string, double> > parameterValues;
+        if( !SetDataHelper::readCSV( parameterValuesArg, parameterValues ) ) {
+            return 1;
+        }
+        for( auto currParam : parameterValues ) {
+            conf->addParameterValue( currParam.first, currParam.second );
+        }
+    }
+
     // Create an empty exclusion list so that any type of IScenarioRunner can be
     // created.
     list<string> exclusionList;
@@ -174,6 +206,11 @@ int main( int argc, char *argv[] ) {
     // Create an auto_ptr to the scenario runner. This will automatically
     // deallocate memory.
     auto_ptr<IScenarioRunner> runner = ScenarioRunnerFactory::createDefault( exclusionList );
+
+    // In server mode the scenarios to run are read from requests instead.
+    if( serverArg ) {
+        return runServer( runner.get(), timer );
+    }
     
     // Setup the scenario.
     success = runner->setupScenarios( timer );
@@ -209,9 +246,11 @@ int main( int argc, char *argv[] ) {
 * \param argv List of arguments.
 * \param confArg [out] Name of the configuration file.
 * \param logFacArg [out] Name of the log configuration file.
+* \param paramArg [out] Name of a CSV file of parameter values to set.
+* \param serverArg [out] Whether to run as a server.
 * \todo Allow a space between the flags and the file names.
 */
-void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFacArg ) {
+void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFacArg, string& paramArg, bool& serverArg ) {
     for( unsigned int i = 1; i < argc; ){
         string temp( argv[ i ] );
         if( temp == "-C" ) {
@@ -240,6 +279,23 @@ void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFac
             logFacArg = temp.substr( 2, temp.length() );
             ++i;
         }
+        else if( temp == "-P" ) {
+            if( ( i + 1 ) == argc ) {
+                cout << "Not enough arguments" << endl;
+                printUsageMessage( argc, argv );
+                abort();
+            }
+            paramArg = string( argv[ i + 1 ] );
+            i += 2;
+        }
+        else if( temp.compare(0,2,"-P" ) == 0 ){
+            paramArg = temp.substr( 2, temp.length() );
+            ++i;
+        }
+        else if( temp == "--server" ) {
+            serverArg = true;
+            ++i;
+        }
         else if( temp == "--version" ) {
             cout << "GCAM version " << __ObjECTS_VER__ << " Revision: " << __REVISION_NUMBER__ << endl;
             exit( 0 );
@@ -262,10 +318,218 @@ void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFac
  * \param argv List of arguments.
  */
 void printUsageMessage( unsigned int argc, char* argv[] ) {
-    cout << "Usage: " << argv[ 0 ] << " [-CconfigurationFileName ][ -LloggerFactoryFileName ]" << endl;
+    cout << "Usage: " << argv[ 0 ] << " [-CconfigurationFileName ][ -LloggerFactoryFileName ][ -PparameterValuesFileName ][ --server ]" << endl;
     cout << "OR" << endl;
     cout << "Usage: " << argv[ 0 ] << " --version" << endl;
     cout << "OR" << endl;
     cout << "Usage: " << argv[ 0 ] << " --versionID" << endl;
 }
 
+/*!
+ * \brief Keep the parsed base model resident and run scenarios on request.
+ * \details The base input file and the configuration scenario components are
+ *          parsed once.  Requests are then read one per line from standard input:
+ *              - run <name> <periods> [<add-on XML file> ...]
+ *                Run a scenario named by appending <name> to the configured
+ *                scenario name, with the add-on files parsed on top of the base
+ *                inputs.  <periods> is a comma separated list of the periods
+ *                to return results for, or -1 for all periods.  The model is
+ *                solved through the last of them since each period depends on
+ *                the ones before it.  Add-on files ending in .csv are instead
+ *                read as parameter values to set directly, see SetDataHelper.
+ *              - quit
+ *                Exit the server.
+ *          Each run is performed in a forked copy of the server so the parsed
+ *          base model is shared copy-on-write and is never modified.  The
+ *          scenario name is appended to every output file, as for the
+ *          concurrent runs of the BatchRunner, so each request writes its own
+ *          files.  The exception is the solver policy, which is meant to be
+ *          shared between runs.  The results selected by the BatchCSVOutputter
+ *          are written for the requested periods to the batchCSVOutputFile of
+ *          the request.
+ *
+ *          Responses are written to standard output, one line per request:
+ *          "gcam-server: <ok|failed> <name> [<results file>]" once a run
+ *          completes or "gcam-server: error <name>" if it could not be run.
+ *          Standard output is reserved for the responses, anything else such
+ *          as console logging is written to standard error instead.
+ *
+ *          Note that completeInit and the construction of the dependency graph
+ *          still occur for each run since the add-on files may change the
+ *          structure of the model.
+ *
+ *          The runner must set up its scenario through a SingleScenarioRunner
+ *          so that the parsed base scenario is used.  The BatchRunner creates
+ *          its scenarios from the batch file instead and so is rejected.
+ * \param aRunner The scenario runner used for each run.
+ * \param aTimer The global timer.
+ * \return The exit code for the program.
+ */
+int runServer( IScenarioRunner* aRunner, Timer& aTimer ) {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+#if !defined(_WIN32)
+    if( dynamic_cast<BatchRunner*>( aRunner ) ) {
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Server mode can not be used with BatchMode." << endl;
+        return 1;
+    }
+
+    // Keep the original standard output for responses and send everything
+    // else written to it to standard error.
+    cout.flush();
+    const int responseFD = dup( STDOUT_FILENO );
+    if( responseFD == -1 || dup2( STDERR_FILENO, STDOUT_FILENO ) == -1 ) {
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Could not set up the server response channel." << endl;
+        return 1;
+    }
+
+    if( !SingleScenarioRunner::parseBaseScenario() ) {
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Failed to parse the base scenario for the server." << endl;
+        close( responseFD );
+        return 1;
+    }
+    writeServerResponse( responseFD, "gcam-server: ready" );
+
+    string line;
+    while( getline( cin, line ) ) {
+        istringstream request( line );
+        string command;
+        request >> command;
+        if( command.empty() ) {
+            continue;
+        }
+        else if( command == "quit" ) {
+            break;
+        }
+
+        string name;
+        string periodList;
+        if( command != "run" || !( request >> name >> periodList ) ) {
+            writeServerResponse( responseFD, "gcam-server: error invalid request: " + line );
+            continue;
+        }
+
+        // Parse the periods, an empty list selects all of them.
+        vector<int> periods;
+        bool isValid = true;
+        istringstream periodStream( periodList );
+        string period;
+        while( isValid && getline( periodStream, period, ',' ) ) {
+            istringstream periodValue( period );
+            int currPeriod;
+            isValid = periodValue >> currPeriod && periodValue.eof() &&
+                ( currPeriod >= 0 || ( currPeriod == Scenario::RUN_ALL_PERIODS && periodList == period ) );
+            if( isValid && currPeriod != Scenario::RUN_ALL_PERIODS ) {
+                periods.push_back( currPeriod );
+            }
+        }
+        if( !isValid ) {
+            writeServerResponse( responseFD, "gcam-server: error invalid periods: " + line );
+            continue;
+        }
+        const int stopPeriod = periods.empty() ? Scenario::RUN_ALL_PERIODS :
+                               *max_element( periods.begin(), periods.end() );
+
+        list<string> addOnFiles;
+        string addOnFile;
+        while( request >> addOnFile ) {
+            addOnFiles.push_back( addOnFile );
+        }
+
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Server running scenario " << name << "." << endl;
+        // Flush any buffered output so that it is not written by both processes.
+        cout.flush();
+        cerr.flush();
+        LoggerFactory::flushLoggers();
+        const pid_t pid = fork();
+        if( pid == -1 ) {
+            writeServerResponse( responseFD, "gcam-server: error " + name );
+            continue;
+        }
+        if( pid == 0 ) {
+            // In the child process which has a copy of the base scenario.  Write
+            // to separate output files so that the results of previous requests
+            // are kept.
+            list<string> sharedFiles;
+            sharedFiles.push_back( "solver-policy" );
+            Configuration* conf = Configuration::getInstance();
+            conf->appendScnToAllFiles( sharedFiles );
+            bool success = aRunner->setupScenarios( aTimer, name, addOnFiles );
+            string response = "gcam-server: failed " + name;
+            if( success ) {
+                XMLHelper<void>::cleanupParser();
+                success = aRunner->runScenarios( stopPeriod, false, aTimer );
+                aRunner->printOutput( aTimer );
+                {
+                    BatchCSVOutputter resultsOutputter;
+                    resultsOutputter.setPeriodsToWrite( periods );
+                    aRunner->getInternalScenario()->accept( &resultsOutputter, -1 );
+                    resultsOutputter.writeDidScenarioSolve( success );
+                }
+                response = string( "gcam-server: " ) + ( success ? "ok " : "failed " ) + name;
+                if( conf->shouldWriteFile( "batchCSVOutputFile" ) ) {
+                    response += " " + util::appendScenarioToFileName(
+                        conf->getFile( "batchCSVOutputFile", "batch-csv-out.csv" ) );
+                }
+            }
+            aRunner->cleanup();
+            cout.flush();
+            cerr.flush();
+            LoggerFactory::flushLoggers();
+            writeServerResponse( responseFD, response );
+            // Skip static destruction and the flushing of any inherited
+            // buffers which belong to the server process.
+            _exit( success ? 0 : 1 );
+        }
+
+        int status = 0;
+        while( waitpid( pid, &status, 0 ) == -1 && errno == EINTR ) {
+        }
+        if( !WIFEXITED( status ) ) {
+            // The run did not get the chance to respond.
+            writeServerResponse( responseFD, "gcam-server: error " + name );
+        }
+    }
+
+    SingleScenarioRunner::clearBaseScenario();
+    XMLHelper<void>::cleanupParser();
+    mainLog.setLevel( ILogger::WARNING );
+    mainLog << "Server exiting." << endl;
+    close( responseFD );
+    return 0;
+#else
+    mainLog.setLevel( ILogger::SEVERE );
+    mainLog << "Server mode is not supported on this platform." << endl;
+    return 1;
+#endif
+}
+
+#if !defined(_WIN32)
+/*!
+ * \brief Write a response line from the server.
+ * \details The response is written directly to the file descriptor so that it
+ *          is not buffered in either the server or a forked run.
+ * \param aFD The file descriptor of the response channel.
+ * \param aResponse The response without the trailing newline.
+ */
+void writeServerResponse( const int aFD, const string& aResponse ) {
+    const string responseLine = aResponse + '\n';
+    size_t written = 0;
+    while( written < responseLine.size() ) {
+        const ssize_t result = write( aFD, responseLine.data() + written, responseLine.size() - written );
+        if( result == -1 ) {
+            if( errno == EINTR ) {
+                continue;
+            }
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::SEVERE );
+            mainLog << "Could not write the server response: " << aResponse << endl;
+            return;
+        }
+        written += result;
+    }
+}
+#endif
@@ -0,0 +1,358 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*! 
+* \file replay_solver.cpp
+* \ingroup Solution
+* \brief A standalone driver which runs solvers against recorded model evaluations.
+* \details Reads a recording written by the EDFunRecorder and, for each segment,
+*          runs the LogBroyden or LogNRbt solver component against a ReplayEDFun
+*          surrogate starting from the recorded initial guess.  The component
+*          settings may be read from a solver configuration file so that solver
+*          configurations can be compared without building and running the full
+*          model.
+*/
+
+#include "util/base/include/definitions.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <xercesc/dom/DOMNode.hpp>
+#include <xercesc/dom/DOMNodeList.hpp>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "solution/util/include/replay_edfun.hpp"
+#include "solution/util/include/functor-subs.hpp"
+#include "solution/util/include/fdjac.hpp"
+#include "solution/util/include/jacobian-precondition.hpp"
+#include "solution/util/include/calc_counter.h"
+#include "solution/solvers/include/solver_component.h"
+#include "solution/solvers/include/logbroyden.hpp"
+#include "solution/solvers/include/lognrbt.hpp"
+#include "util/base/include/iparsable.h"
+#include "util/base/include/xml_helper.h"
+#include "util/logger/include/logger_factory.h"
+#include "util/base/include/timer.h"
+
+using namespace std;
+using namespace xercesc;
+
+#define UBVECTOR boost::numeric::ublas::vector<double>
+#define UBMATRIX boost::numeric::ublas::matrix<double>
+
+// Globals which the model library expects the executable to define.
+ofstream outFile;
+Scenario* scenario = 0;
+
+namespace {
+    //! Options for the replay.
+    struct ReplayOptions {
+        string mSegmentFile;
+        bool mUseBroyden;
+        string mConfigFile;
+        int mConfigYear;
+        string mLogConfFile;
+        double mFTOL;
+        int mMaxIter;
+    };
+
+    //! Statistics from a single replayed solve.
+    struct ReplayResult {
+        int mStatus;
+        int mEvaluations;
+        double mMaxF;
+    };
+
+    double maxAbs( const UBVECTOR& aVec ) {
+        double maxVal = 0.0;
+        for( size_t i = 0; i < aVec.size(); ++i ) {
+            maxVal = max( maxVal, fabs( aVec[ i ] ) );
+        }
+        return maxVal;
+    }
+
+    //! LogBroyden with its solve routine exposed so it can be run without a model.
+    class ReplayLogBroyden : public LogBroyden {
+    public:
+        ReplayLogBroyden( CalcCounter* aCalcCounter ):LogBroyden( 0, 0, aCalcCounter ) {}
+
+        int solveFrom( VecFVec<double,double>& aF, UBVECTOR& aX, UBVECTOR& aFX, UBMATRIX& aJ,
+                       int& aNeval )
+        {
+            return bsolve( aF, aX, aFX, aJ, aNeval );
+        }
+
+        void setLimits( const double aFTOL, const int aMaxIter ) {
+            if( aFTOL > 0.0 ) {
+                mFTOL = aFTOL;
+            }
+            if( aMaxIter > 0 ) {
+                mMaxIter = aMaxIter;
+            }
+        }
+
+        bool isLogPrice() const {
+            return mLogPricep;
+        }
+    };
+
+    //! LogNRbt with its solve routine exposed so it can be run without a model.
+    class ReplayLogNRbt : public LogNRbt {
+    public:
+        ReplayLogNRbt( CalcCounter* aCalcCounter ):LogNRbt( 0, 0, aCalcCounter ) {}
+
+        int solveFrom( VecFVec<double,double>& aF, UBVECTOR& aX, UBVECTOR& aFX, UBMATRIX& aJ,
+                       int& aNeval )
+        {
+            return nrsolve( aF, aX, aFX, aJ, aNeval );
+        }
+
+        void setLimits( const double aFTOL, const int aMaxIter ) {
+            if( aFTOL > 0.0 ) {
+                mFTOL = aFTOL;
+            }
+            if( aMaxIter > 0 ) {
+                mMaxIter = aMaxIter;
+            }
+        }
+
+        bool isLogPrice() const {
+            return mLogPricep;
+        }
+    };
+
+    /*!
+     * \brief Parses the settings of one solver component out of a solver
+     *        configuration file.
+     * \details Uses the user-configurable-solver in effect for the given year,
+     *          i.e. the last one at or before it, or the first one if no year
+     *          was given.  The first matching component within that solver is
+     *          parsed.
+     */
+    class ReplaySolverConfig : public IParsable {
+    public:
+        ReplaySolverConfig( SolverComponent* aComponent, const int aYear ):
+            mComponent( aComponent ), mYear( aYear ) {}
+
+        virtual bool XMLParse( const DOMNode* aNode ) {
+            const DOMNode* solverNode = 0;
+            int solverYear = 0;
+            DOMNodeList* nodeList = aNode->getChildNodes();
+            for( unsigned int i = 0; i < nodeList->getLength(); ++i ) {
+                const DOMNode* curr = nodeList->item( i );
+                if( XMLHelper<string>::safeTranscode( curr->getNodeName() ) != "user-configurable-solver" ) {
+                    continue;
+                }
+                const int year = XMLHelper<int>::getAttr( curr, "year" );
+                if( mYear == -1 ? !solverNode : year <= mYear && ( !solverNode || year >= solverYear ) ) {
+                    solverNode = curr;
+                    solverYear = year;
+                }
+            }
+            if( !solverNode ) {
+                cout << "No user-configurable-solver found for the requested year." << endl;
+                return false;
+            }
+
+            nodeList = solverNode->getChildNodes();
+            for( unsigned int i = 0; i < nodeList->getLength(); ++i ) {
+                const DOMNode* curr = nodeList->item( i );
+                if( XMLHelper<string>::safeTranscode( curr->getNodeName() ) == mComponent->getXMLName() ) {
+                    return mComponent->XMLParse( curr );
+                }
+            }
+            cout << "No " << mComponent->getXMLName() << " found in the solver for year "
+                 << solverYear << "." << endl;
+            return false;
+        }
+
+    private:
+        //! The component to configure.
+        SolverComponent* mComponent;
+
+        //! The year to select the solver for, or -1 for the first solver.
+        const int mYear;
+    };
+
+    /*!
+     * \brief Run the solver component against a segment the same way its
+     *        solve method would run against the model.
+     * \return Result statistics, status 0 indicates success.
+     */
+    template<class SolverType>
+    ReplayResult replaySolve( SolverType& aSolver, ReplayEDFun& aF ) {
+        ReplayResult result = { -1, 0, 0.0 };
+        UBVECTOR x( aF.getStartingPoint() );
+        UBVECTOR fx( aF.nrtn() );
+        UBMATRIX J( aF.narg(), aF.nrtn() );
+
+        aF( x, fx );
+        fdjac( aF, x, fx, J, true );
+        jacobian_precondition( x, fx, J, aF, 0, aSolver.isLogPrice() );
+        result.mStatus = aSolver.solveFrom( aF, x, fx, J, result.mEvaluations );
+        result.mMaxF = maxAbs( fx );
+        return result;
+    }
+
+    //! Replay every segment with the configured solver and report how it did.
+    template<class SolverType>
+    int replaySegments( const ReplayOptions& aOptions, const vector<EDFunSegment>& aSegments ) {
+        CalcCounter calcCounter;
+        SolverType solver( &calcCounter );
+        if( !aOptions.mConfigFile.empty() ) {
+            ReplaySolverConfig config( &solver, aOptions.mConfigYear );
+            if( !XMLHelper<void>::parseXML( aOptions.mConfigFile, &config ) ) {
+                cout << "Error reading solver configuration " << aOptions.mConfigFile << endl;
+                return 1;
+            }
+        }
+        solver.setLimits( aOptions.mFTOL, aOptions.mMaxIter );
+        solver.init();
+
+        cout << "segment\tperiod\tmarkets\tanchors\tstatus\tevals\tmax|F|\ttime(s)" << endl;
+        int numFailed = 0;
+        int numSkipped = 0;
+        for( size_t s = 0; s < aSegments.size(); ++s ) {
+            if( aSegments[ s ].mFullX.empty() ) {
+                ++numSkipped;
+                continue;
+            }
+            Timer timer;
+            timer.start();
+            ReplayEDFun F( aSegments[ s ] );
+            const ReplayResult result = replaySolve( solver, F );
+            timer.stop();
+            if( result.mStatus != 0 ) {
+                ++numFailed;
+            }
+            cout << s << "\t" << aSegments[ s ].mPeriod << "\t" << F.narg() << "\t"
+                 << F.getNumAnchors() << "\t" << result.mStatus << "\t" << result.mEvaluations
+                 << "\t" << setprecision( 4 ) << result.mMaxF << "\t"
+                 << timer.getTotalTimeDifference() << endl;
+        }
+        cout << aSegments.size() - numFailed - numSkipped << " of " << aSegments.size()
+             << " segments solved, " << numSkipped << " skipped without evaluations." << endl;
+
+        return numFailed == 0 ? 0 : 1;
+    }
+
+    void printUsageMessage( const char* aProgram ) {
+        cout << "Usage: " << aProgram << " --segment recordingFile [ --solver broyden|newton ]"
+             << " [ --config solverConfigFile [ --config-year year ] ] [ --log-conf loggerConfigFile ]"
+             << " [ --ftol tolerance ][ --max-iter iterations ]" << endl;
+    }
+
+    bool parseArgs( int argc, char* argv[], ReplayOptions& aOptions ) {
+        for( int i = 1; i < argc; i += 2 ) {
+            const string arg( argv[ i ] );
+            if( i + 1 == argc ) {
+                cout << "Not enough arguments" << endl;
+                return false;
+            }
+            const string value( argv[ i + 1 ] );
+            if( arg == "--segment" ) {
+                aOptions.mSegmentFile = value;
+            }
+            else if( arg == "--solver" && ( value == "broyden" || value == "newton" ) ) {
+                aOptions.mUseBroyden = value == "broyden";
+            }
+            else if( arg == "--config" ) {
+                aOptions.mConfigFile = value;
+            }
+            else if( arg == "--config-year" ) {
+                aOptions.mConfigYear = atoi( value.c_str() );
+            }
+            else if( arg == "--log-conf" ) {
+                aOptions.mLogConfFile = value;
+            }
+            else if( arg == "--ftol" ) {
+                aOptions.mFTOL = atof( value.c_str() );
+            }
+            else if( arg == "--max-iter" ) {
+                aOptions.mMaxIter = atoi( value.c_str() );
+            }
+            else {
+                cout << "Invalid argument: " << arg << " " << value << endl;
+                return false;
+            }
+        }
+        return !aOptions.mSegmentFile.empty();
+    }
+}
+
+//! Replay every segment in a recording and report how the solver did.
+int main( int argc, char* argv[] ) {
+    ReplayOptions options;
+    options.mUseBroyden = true;
+    options.mConfigYear = -1;
+    // The tolerance and iteration limit default to the solver's own.
+    options.mFTOL = -1.0;
+    options.mMaxIter = -1;
+    if( !parseArgs( argc, argv, options ) ) {
+        printUsageMessage( argv[ 0 ] );
+        return 1;
+    }
+
+    // The loggers are cleaned up when the wrapper goes out of scope.
+    LoggerFactoryWrapper loggerFactoryWrapper;
+    if( !options.mLogConfFile.empty() ) {
+        if( !XMLHelper<void>::parseXML( options.mLogConfFile, &loggerFactoryWrapper ) ) {
+            return 1;
+        }
+    }
+
+    vector<EDFunSegment> segments;
+    string error;
+    if( !EDFunSegment::readSegments( options.mSegmentFile, segments, error ) ) {
+        cout << "Error reading " << options.mSegmentFile << ": " << error << endl;
+        // Replay anything that was read before the problem.
+        if( segments.empty() ) {
+            return 1;
+        }
+    }
+
+    const int status = options.mUseBroyden ? replaySegments<ReplayLogBroyden>( options, segments )
+                                           : replaySegments<ReplayLogNRbt>( options, segments );
+
+    if( !options.mLogConfFile.empty() || !options.mConfigFile.empty() ) {
+        XMLHelper<void>::cleanupParser();
+    }
+    return status;
+}
@@ -73,6 +73,8 @@ public:
     CachedMarket( const std::string& aGoodName, const std::string& aRegionName, const int aPeriod, Market* aLocatedMarket );
     ~CachedMarket();
 
+    bool hasMarket() const;
+
     void setPrice( const std::string& aGoodName, const std::string& aRegionName, const double aValue,
                    const int aPeriod, bool aMustExist = true );
     
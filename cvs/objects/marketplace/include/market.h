@@ -115,6 +115,7 @@ class Market: public IYeared, public IVisitable, private boost::noncopyable
 {
     friend class XMLDBOutputter;
     friend class PriceMarket;
+    friend class ManageStateVariables;
 public:
     Market( const MarketContainer* aContainer );
     virtual ~Market();
@@ -239,6 +240,8 @@ protected:
     */
     virtual void toDebugXMLDerived( std::ostream& out, Tabs* tabs ) const = 0;
     
+    virtual const Value& getSolverSupplyState() const;
+    
     IInfo* releaseMarketInfo();
 };
 
@@ -137,6 +137,7 @@ class Marketplace: public IVisitable, private boost::noncopyable
     friend class SolverLibrary;
     friend class MarketDependencyFinder;
     friend class LogEDFun;
+    friend class CachedActivity;
 #if DEBUG_STATE
     friend class ManageStateVariables;
     friend class Value;
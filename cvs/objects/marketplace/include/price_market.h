@@ -91,6 +91,7 @@ protected:
     )
     
     virtual void toDebugXMLDerived( std::ostream& out, Tabs* tabs ) const;
+    virtual const Value& getSolverSupplyState() const;
 private:
     Market* mDemandMarketPointer; //!< A pointer to the companion DemandMarket
 };
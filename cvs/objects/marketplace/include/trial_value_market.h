@@ -92,6 +92,7 @@ protected:
     )
     
     virtual void toDebugXMLDerived( std::ostream& out, Tabs* tabs ) const;
+    virtual const Value& getSolverSupplyState() const;
 };
 
 #endif // _TRIALVALUE_MARKET_H_
@@ -46,6 +46,7 @@
 #include "util/base/include/util.h"
 #include "marketplace/include/marketplace.h"
 #include "containers/include/scenario.h"
+#include "containers/include/cached_activity.h"
 
 using namespace std;
 
@@ -77,6 +78,14 @@ mCachedMarket( aLocatedMarket )
 CachedMarket::~CachedMarket() {
 }
 
+/*!
+ * \brief Whether the market was found when it was located.
+ * \return True if the market exists.
+ */
+bool CachedMarket::hasMarket() const {
+    return mCachedMarket != 0;
+}
+
 /*!
  * \brief Set the market price.
  * \details Mimics the behavior of Marketplace::setPrice.
@@ -115,6 +124,7 @@ void CachedMarket::setPrice( const string& aGoodName, const string& aRegionName,
     
     if ( mCachedMarket ) {
         mCachedMarket->setPrice( aValue );
+        CachedActivity::recordWrite( mCachedMarket, CachedActivity::PRICE, aValue );
     }
     else if( aMustExist ){
         ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -161,8 +171,10 @@ void CachedMarket::addToSupply( const string& aGoodName, const string& aRegionNa
     }
     
     if ( mCachedMarket ) {
-        mCachedMarket->addToSupply( scenario->getMarketplace()->mIsDerivativeCalc ?
-                                    aValue.getDiff() : aValue.get() );
+        const double supply = scenario->getMarketplace()->mIsDerivativeCalc ?
+                              aValue.getDiff() : aValue.get();
+        mCachedMarket->addToSupply( supply );
+        CachedActivity::recordWrite( mCachedMarket, CachedActivity::SUPPLY, supply );
     }
     else if( aMustExist ){
         ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -209,8 +221,10 @@ void CachedMarket::addToDemand( const string& aGoodName, const string& aRegionNa
     }
     
     if ( mCachedMarket ) {
-        mCachedMarket->addToDemand( scenario->getMarketplace()->mIsDerivativeCalc ?
-                                    aValue.getDiff() : aValue.get() );
+        const double demand = scenario->getMarketplace()->mIsDerivativeCalc ?
+                              aValue.getDiff() : aValue.get();
+        mCachedMarket->addToDemand( demand );
+        CachedActivity::recordWrite( mCachedMarket, CachedActivity::DEMAND, demand );
     }
     else if( aMustExist ){
         ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -248,7 +262,9 @@ double CachedMarket::getPrice( const string& aGoodName, const string& aRegionNam
     assert( aPeriod == mPeriod );
     
     if( mCachedMarket ) {
-        return mCachedMarket->getPrice();
+        const double price = mCachedMarket->getPrice();
+        CachedActivity::recordRead( mCachedMarket, CachedActivity::PRICE, price );
+        return price;
     }
     
     if( aMustExist ) {
@@ -287,7 +303,9 @@ double CachedMarket::getSupply( const string& aGoodName, const string& aRegionNa
     assert( aPeriod == mPeriod );
     
     if ( mCachedMarket ) {
-        return mCachedMarket->getSupply();
+        const double supply = mCachedMarket->getSupply();
+        CachedActivity::recordRead( mCachedMarket, CachedActivity::SUPPLY, supply );
+        return supply;
     }
     
     ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -323,7 +341,9 @@ double CachedMarket::getDemand(  const string& aGoodName, const string& aRegionN
     assert( aPeriod == mPeriod );
     
     if ( mCachedMarket ) {
-        return mCachedMarket->getDemand();
+        const double demand = mCachedMarket->getDemand();
+        CachedActivity::recordRead( mCachedMarket, CachedActivity::DEMAND, demand );
+        return demand;
     }
     
     ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -101,6 +101,11 @@ double DemandMarket::getSolverSupply() const {
     return Market::getPrice();
 }
 
+//! The solver supply is the price so the price state is reported.
+const Value& DemandMarket::getSolverSupplyState() const {
+    return mPrice;
+}
+
 double DemandMarket::getSupply() const {
     return Market::getPrice();
 }
@@ -449,6 +449,19 @@ double Market::getSolverSupply() const {
 #endif
 }
 
+/*!
+ * \brief Get the underlying state Value which getSolverSupply reports.
+ * \details This allows ManageStateVariables to lay out the solver supply of
+ *          solvable markets alongside their prices and demands so that the solver
+ *          can read it in bulk without calling getSolverSupply.  Subclasses which
+ *          override getSolverSupply must override this method consistently.
+ * \return The Value which holds the solver supply.
+ * \sa getSolverSupply
+ */
+const Value& Market::getSolverSupplyState() const {
+    return mSupply;
+}
+
 /*! \brief Get the supply.
 * \details Get the supply out of the market.
 * \return Market supply
@@ -63,6 +63,7 @@
 #include "containers/include/iinfo.h"
 #include "marketplace/include/cached_market.h"
 #include "containers/include/market_dependency_finder.h"
+#include "containers/include/cached_activity.h"
 #include "solution/util/include/ublas-helpers.hpp"
 
 using namespace std;
@@ -502,7 +503,9 @@ void Marketplace::setPrice( const string& goodName, const string& regionName, co
 
     const int marketNumber = mMarketLocator->getMarketNumber( regionName, goodName );
     if ( marketNumber != MarketLocator::MARKET_NOT_FOUND ) {
-        mMarkets[ marketNumber ]->getMarket( per )->setPrice( value );
+        Market* market = mMarkets[ marketNumber ]->getMarket( per );
+        market->setPrice( value );
+        CachedActivity::recordWrite( market, CachedActivity::PRICE, value );
     }
     else if( aMustExist ){
         ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -540,7 +543,10 @@ void Marketplace::addToSupply( const string& goodName, const string& regionName,
     const int marketNumber = mMarketLocator->getMarketNumber( regionName, goodName );
 
     if ( marketNumber != MarketLocator::MARKET_NOT_FOUND ) {
-        mMarkets[ marketNumber ]->getMarket( per )->addToSupply( mIsDerivativeCalc ? value.getDiff() : value.get() );
+        Market* market = mMarkets[ marketNumber ]->getMarket( per );
+        const double supply = mIsDerivativeCalc ? value.getDiff() : value.get();
+        market->addToSupply( supply );
+        CachedActivity::recordWrite( market, CachedActivity::SUPPLY, supply );
     }
     else if( aMustExist ){
         ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -577,7 +583,10 @@ void Marketplace::addToDemand( const string& goodName, const string& regionName,
 
     const int marketNumber = mMarketLocator->getMarketNumber( regionName, goodName );
     if ( marketNumber != MarketLocator::MARKET_NOT_FOUND ) {
-        mMarkets[ marketNumber ]->getMarket( per )->addToDemand( mIsDerivativeCalc ? value.getDiff() : value.get() );
+        Market* market = mMarkets[ marketNumber ]->getMarket( per );
+        const double demand = mIsDerivativeCalc ? value.getDiff() : value.get();
+        market->addToDemand( demand );
+        CachedActivity::recordWrite( market, CachedActivity::DEMAND, demand );
     }
     else if( aMustExist ){
         ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -605,7 +614,10 @@ double Marketplace::getPrice( const string& goodName, const string& regionName,
     const int marketNumber = mMarketLocator->getMarketNumber( regionName, goodName );
     
     if( marketNumber != MarketLocator::MARKET_NOT_FOUND ){
-        return mMarkets[ marketNumber ]->getMarket( per )->getPrice();
+        Market* market = mMarkets[ marketNumber ]->getMarket( per );
+        const double price = market->getPrice();
+        CachedActivity::recordRead( market, CachedActivity::PRICE, price );
+        return price;
     }
 
     if( aMustExist ) {
@@ -632,7 +644,10 @@ double Marketplace::getSupply( const string& goodName, const string& regionName,
     const int marketNumber = mMarketLocator->getMarketNumber( regionName, goodName );
 
     if ( marketNumber != MarketLocator::MARKET_NOT_FOUND ) {
-        return mMarkets[ marketNumber ]->getMarket( per )->getSupply();
+        Market* market = mMarkets[ marketNumber ]->getMarket( per );
+        const double supply = market->getSupply();
+        CachedActivity::recordRead( market, CachedActivity::SUPPLY, supply );
+        return supply;
     }
 
     ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -656,7 +671,10 @@ double Marketplace::getDemand(  const string& goodName, const string& regionName
     const int marketNumber = mMarketLocator->getMarketNumber( regionName, goodName );
 
     if ( marketNumber != MarketLocator::MARKET_NOT_FOUND ) {
-        return mMarkets[ marketNumber ]->getMarket( per )->getDemand();
+        Market* market = mMarkets[ marketNumber ]->getMarket( per );
+        const double demand = market->getDemand();
+        CachedActivity::recordRead( market, CachedActivity::DEMAND, demand );
+        return demand;
     }
 
     ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -121,6 +121,11 @@ double PriceMarket::getSolverSupply() const {
     return mPrice;
 }
 
+//! The solver supply is the price so the price state is reported.
+const Value& PriceMarket::getSolverSupplyState() const {
+    return mPrice;
+}
+
 double PriceMarket::getSupply() const {
     return mDemandMarketPointer->getSupply();
 }
@@ -126,6 +126,11 @@ double TrialValueMarket::getSolverSupply() const {
     return Market::getPrice();
 }
 
+//! The solver supply is the price so the price state is reported.
+const Value& TrialValueMarket::getSolverSupplyState() const {
+    return mPrice;
+}
+
 void TrialValueMarket::addToSupply( const double supplyIn ) {
     // TrialValueMarket does not utilize supply instead
     // it is equal to the price thus can not be added to.
@@ -44,6 +44,7 @@
 * \author Pralit Patel
 */
 
+#include <vector>
 #include "util/base/include/default_visitor.h"
 #include "util/base/include/auto_file.h"
 
@@ -63,6 +64,12 @@ public:
 
     void writeDidScenarioSolve( bool aDidSolve );
 
+    void skipHeader();
+
+    void setPeriodsToWrite( const std::vector<int>& aPeriods );
+
+    void flush();
+
     //! IVisitor methods
     void startVisitScenario( const Scenario* aScenario, const int aPeriod );
 
@@ -77,5 +84,10 @@ private:
 
     //! If this is the first scenario to be written
     bool mIsFirstScenario;
+
+    //! The periods to write results for, empty to write all periods
+    std::vector<int> mPeriods;
+
+    bool shouldWritePeriod( const int aPeriod ) const;
 };
 #endif // _BATCH_CSV_OUTPUTTER_H_
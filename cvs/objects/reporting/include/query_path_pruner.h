@@ -0,0 +1,169 @@
+#ifndef _QUERY_PATH_PRUNER_H_
+#define _QUERY_PATH_PRUNER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file query_path_pruner.h
+* \ingroup Objects
+* \brief QueryPathPruner class header file.
+*/
+
+#include <string>
+#include <vector>
+#include <utility>
+
+/*!
+* \ingroup Objects
+* \brief Decides which parts of the XML written by the XMLDBOutputter can be
+*        reached by a given set of ModelInterface queries.
+* \details The XPath of each query is reduced statically to a list of location
+*          steps, each of which tests an element name and optionally the type
+*          attribute which the XMLDBOutputter writes for the base class of an
+*          object.  Queries are relative to the scenario, the world or a region
+*          so they are matched starting at each of those levels.  The outputter
+*          tells the pruner about each element before it writes it so that a
+*          subtree which no query can reach is skipped before any of its values
+*          are formatted.  A subtree which completes a query path is written in
+*          full while elements along a path only write the values a query
+*          selects.
+*
+*          Anything which can not be reduced conservatively, such as an
+*          ancestor axis, disables pruning entirely.  Predicates which refer to
+*          child elements, such as exists(child::keyword), add those children
+*          as extra query paths.
+*
+*          The state of the elements being written is held by value so that a
+*          copy may continue from the point it was taken, which is how regions
+*          written in parallel each get their own pruner.
+*/
+class QueryPathPruner {
+public:
+    QueryPathPruner();
+
+    bool readQueries( const std::string& aFileName );
+
+    void addXPath( const std::string& aXPath );
+
+    //! Whether queries were read which could all be reduced so that pruning is possible.
+    bool isPruning() const {
+        return !mKeepEverything && mNumQueries > 0;
+    }
+
+    bool startElement( const std::string& aName, const std::string& aType );
+
+    bool endElement();
+
+    bool isItemNeeded( const std::string& aName ) const;
+
+    //! Whether the current element is being skipped.
+    bool isSkipping() const {
+        return !mElements.empty() && mElements.back().mIsSkipped;
+    }
+
+    //! The first query which could not be reduced if any.
+    const std::string& getUnreducedXPath() const {
+        return mUnreducedXPath;
+    }
+
+    //! The number of subtrees which have been skipped.
+    unsigned long long getNumSkipped() const {
+        return mNumSkipped;
+    }
+
+    //! The number of elements which have been written.
+    unsigned long long getNumWritten() const {
+        return mNumWritten;
+    }
+
+private:
+    //! A single location step of a query.
+    struct Step {
+        //! The element name to match or * for any element.
+        std::string mName;
+
+        //! The required value of the type attribute or empty for any.
+        std::string mType;
+
+        //! Whether the step may match at any depth below the previous step.
+        bool mIsDescendant;
+    };
+
+    //! The steps of a query path, a match of the last step keeps its subtree.
+    typedef std::vector<Step> Pattern;
+
+    //! A position in a pattern: the pattern index and the next step to match.
+    typedef std::pair<int, int> Position;
+
+    //! An element which is being written or skipped.
+    struct Element {
+        //! Whether the element is within a subtree which is written in full.
+        bool mIsKept;
+
+        //! Whether the element is within a subtree which is skipped.
+        bool mIsSkipped;
+
+        //! Positions children of this element may match.
+        std::vector<Position> mPositions;
+    };
+
+    //! The query paths.
+    std::vector<Pattern> mPatterns;
+
+    //! Set if any query could not be reduced.
+    bool mKeepEverything;
+
+    //! The number of queries read.
+    int mNumQueries;
+
+    //! The first query which could not be reduced.
+    std::string mUnreducedXPath;
+
+    //! The elements which are currently open.
+    std::vector<Element> mElements;
+
+    //! Statistics on the number of elements pruned.
+    unsigned long long mNumSkipped;
+    unsigned long long mNumWritten;
+
+    bool parseStep( const std::string& aStep, Pattern& aPattern, std::vector<Pattern>& aChildPatterns );
+    bool parsePredicate( const std::string& aPredicate, std::string& aType,
+                         std::vector<std::string>& aChildNames ) const;
+    bool matches( const Step& aStep, const std::string& aName, const std::string& aType ) const;
+};
+
+#endif // _QUERY_PATH_PRUNER_H_
@@ -48,6 +48,7 @@
 #include <memory>
 #include <iosfwd>
 #include <boost/iostreams/filtering_stream.hpp>
+#include <boost/shared_ptr.hpp>
 #include "util/base/include/default_visitor.h"
 
 #if( __HAVE_JAVA__ )
@@ -55,6 +56,8 @@
 #include <boost/iostreams/concepts.hpp>
 #endif
 
+class QueryPathPruner;
+
 /*!
 * \ingroup Objects
 * \brief A visitor which writes model results to an XML database.
@@ -79,6 +82,8 @@ public:
     void startVisitWorld( const World* aWorld, const int aPeriod );
     void endVisitWorld( const World* aWorld, const int aPeriod );
 
+    bool visitRegions( const std::vector<Region*>& aRegions, const int aPeriod );
+
     void startVisitRegion( const Region* aRegion, const int aPeriod );
     void endVisitRegion( const Region* aRegion, const int aPeriod );
 
@@ -224,6 +229,8 @@ public:
 
     bool appendData( const std::string& aData, const std::string& aLocation );
 private:
+    XMLDBOutputter( const Tabs& aTabs, const QueryPathPruner* aPruner, std::string& aOutput );
+
     //! A boost iostream which will send output to the DB as it is printed.
     mutable boost::iostreams::filtering_ostream mBuffer;
 
@@ -262,6 +269,14 @@ private:
     //! database.
     std::stack<std::iostream*> mBufferStack;
 
+    //! Decides which elements the configured queries can reach so that the
+    //! rest are skipped, null if all output should be written.
+    boost::shared_ptr<QueryPathPruner> mPruner;
+
+    //! Whether each region should be written concurrently by a separate
+    //! outputter and then appended to mBuffer in order.
+    bool mWriteRegionsInParallel;
+
 #if( __HAVE_JAVA__ )
     /*!
      * \brief Contains all objects necessary to interact with Java.
@@ -313,6 +328,12 @@ private:
         const int aYear );
 
     bool isTechnologyOperating( const int aPeriod );
+
+    bool startElement( const std::string& aName, const std::string& aType = "" );
+
+    bool endElement();
+
+    bool isSkipping() const;
     
     std::iostream* popBufferStack();
     
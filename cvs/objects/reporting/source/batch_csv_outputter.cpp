@@ -52,6 +52,7 @@
 #include "climate/include/iclimate_model.h"
 
 #include <string>
+#include <algorithm>
 
 #include "reporting/include/batch_csv_outputter.h"
 
@@ -85,11 +86,17 @@ void BatchCSVOutputter::startVisitScenario( const Scenario* aScenario, const int
         const Modeltime* modeltime = aScenario->getModeltime();
 
         for( int period = 0; period < modeltime->getmaxper(); ++period ) {
+            if( !shouldWritePeriod( period ) ) {
+                continue;
+            }
             // TODO: hard coding CO2
             const int year = modeltime->getper_to_yr( period );
             mFile << year << ' '<< "CO2 Price" << ',';
         }
         for( int period = 0; period < modeltime->getmaxper(); ++period ) {
+            if( !shouldWritePeriod( period ) ) {
+                continue;
+            }
             // TODO: hard coding CO2
             const int year = modeltime->getper_to_yr( period );
             mFile << year << ' '<< "CO2 Emissions" << ',';
@@ -128,7 +135,9 @@ void BatchCSVOutputter::startVisitScenario( const Scenario* aScenario, const int
 }
 
 void BatchCSVOutputter::startVisitMarket( const Market* aMarket, const int aPeriod ) {
-    if( aMarket->getType() == IMarketType::TAX ) {
+    if( aMarket->getType() == IMarketType::TAX &&
+        shouldWritePeriod( scenario->getModeltime()->getyr_to_per( aMarket->getYear() ) ) )
+    {
         /*!
          * \warninng This is assuming the periods will be visited in appropriate order.
          */
@@ -142,6 +151,9 @@ void BatchCSVOutputter::startVisitMarket( const Market* aMarket, const int aPeri
 void BatchCSVOutputter::startVisitClimateModel( const IClimateModel* aClimateModel, const int aPeriod ) {
     const Modeltime* modeltime = scenario->getModeltime();
     for( int period = 0; period < modeltime->getmaxper(); ++period ) {
+        if( !shouldWritePeriod( period ) ) {
+            continue;
+        }
         const int year = modeltime->getper_to_yr( period );
         mFile << "" << aClimateModel->getEmissions( "CO2", year ) << ',';
     }
@@ -178,3 +190,39 @@ void BatchCSVOutputter::startVisitClimateModel( const IClimateModel* aClimateMod
 void BatchCSVOutputter::writeDidScenarioSolve( bool aDidSolve ) {
     mFile << aDidSolve << endl;
 }
+
+/*!
+ * \brief Do not write the header for subsequent scenarios.
+ * \details Used when the header was already written to the file by another
+ *          process sharing it.
+ */
+void BatchCSVOutputter::skipHeader() {
+    mIsFirstScenario = false;
+}
+
+/*!
+ * \brief Only write the results which are by period for the given periods.
+ * \details The climate results are by year and so are always written.
+ * \param aPeriods The periods to write, empty to write all periods.
+ */
+void BatchCSVOutputter::setPeriodsToWrite( const vector<int>& aPeriods ) {
+    mPeriods = aPeriods;
+}
+
+/*!
+ * \brief Whether results for a period should be written.
+ * \param aPeriod The period.
+ * \return True if the period was selected or no periods were selected.
+ */
+bool BatchCSVOutputter::shouldWritePeriod( const int aPeriod ) const {
+    return mPeriods.empty() || find( mPeriods.begin(), mPeriods.end(), aPeriod ) != mPeriods.end();
+}
+
+/*!
+ * \brief Write any buffered results to the file.
+ * \details Used before forking so that the buffered results are not written
+ *          by both processes.
+ */
+void BatchCSVOutputter::flush() {
+    (*mFile).flush();
+}
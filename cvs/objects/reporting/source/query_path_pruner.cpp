@@ -0,0 +1,576 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file query_path_pruner.cpp
+* \ingroup Objects
+* \brief QueryPathPruner class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cassert>
+
+#include "reporting/include/query_path_pruner.h"
+
+using namespace std;
+
+namespace {
+    //! Characters which may appear in an element name.
+    bool isNameChar( const char aChar ) {
+        return isalnum( static_cast<unsigned char>( aChar ) ) || aChar == '_' || aChar == '-' || aChar == '.';
+    }
+
+    //! Remove leading and trailing white space.
+    string trim( const string& aString ) {
+        const size_t start = aString.find_first_not_of( " \t\r\n" );
+        if( start == string::npos ) {
+            return "";
+        }
+        const size_t end = aString.find_last_not_of( " \t\r\n" );
+        return aString.substr( start, end - start + 1 );
+    }
+
+    //! Replace the predefined XML entities.
+    string unescape( const string& aString ) {
+        const char* entities[][ 2 ] = { { "&apos;", "'" }, { "&quot;", "\"" }, { "&lt;", "<" },
+                                        { "&gt;", ">" }, { "&amp;", "&" } };
+        string result = aString;
+        for( size_t i = 0; i < sizeof( entities ) / sizeof( entities[ 0 ] ); ++i ) {
+            const string entity( entities[ i ][ 0 ] );
+            for( size_t pos = result.find( entity ); pos != string::npos; pos = result.find( entity, pos + 1 ) ) {
+                result.replace( pos, entity.size(), entities[ i ][ 1 ] );
+            }
+        }
+        return result;
+    }
+
+    //! Remove XQuery comments such as (:collapse:).
+    string removeComments( const string& aXPath ) {
+        string result = aXPath;
+        for( size_t start = result.find( "(:" ); start != string::npos; start = result.find( "(:" ) ) {
+            const size_t end = result.find( ":)", start + 2 );
+            result.erase( start, end == string::npos ? string::npos : end + 2 - start );
+        }
+        return result;
+    }
+
+    /*!
+     * \brief Split a string on a separator which is not within brackets,
+     *        parentheses or quotes.
+     */
+    vector<string> splitTopLevel( const string& aString, const string& aSeparator ) {
+        vector<string> parts;
+        int depth = 0;
+        char quote = 0;
+        size_t start = 0;
+        for( size_t i = 0; i < aString.size(); ++i ) {
+            const char curr = aString[ i ];
+            if( quote ) {
+                quote = curr == quote ? 0 : quote;
+            }
+            else if( curr == '\'' || curr == '"' ) {
+                quote = curr;
+            }
+            else if( curr == '[' || curr == '(' ) {
+                ++depth;
+            }
+            else if( curr == ']' || curr == ')' ) {
+                --depth;
+            }
+            else if( depth == 0 && aString.compare( i, aSeparator.size(), aSeparator ) == 0 ) {
+                parts.push_back( aString.substr( start, i - start ) );
+                start = i + aSeparator.size();
+                i = start - 1;
+            }
+        }
+        parts.push_back( aString.substr( start ) );
+        return parts;
+    }
+
+}
+
+//! Constructor.
+QueryPathPruner::QueryPathPruner():
+mKeepEverything( false ),
+mNumQueries( 0 ),
+mNumSkipped( 0 ),
+mNumWritten( 0 )
+{
+    // The model version is not queried but identifies the run.
+    addXPath( "model-version" );
+}
+
+/*!
+ * \brief Read the xPath of every query in a ModelInterface query file.
+ * \details Both query files such as Main_queries.xml and batch query files may
+ *          be used as only the xPath elements are read.
+ * \param aFileName The query file.
+ * \return Whether the file could be read.
+ */
+bool QueryPathPruner::readQueries( const string& aFileName ) {
+    ifstream queryFile( aFileName.c_str() );
+    if( !queryFile ) {
+        return false;
+    }
+    stringstream contents;
+    contents << queryFile.rdbuf();
+    const string queries = contents.str();
+    for( size_t start = queries.find( "<xPath" ); start != string::npos; start = queries.find( "<xPath", start + 1 ) ) {
+        const size_t textStart = queries.find( '>', start );
+        if( textStart == string::npos ) {
+            break;
+        }
+        if( queries[ textStart - 1 ] == '/' ) {
+            continue;
+        }
+        const size_t textEnd = queries.find( "</xPath>", textStart );
+        if( textEnd == string::npos ) {
+            break;
+        }
+        string xPath = queries.substr( textStart + 1, textEnd - textStart - 1 );
+        const size_t cdataStart = xPath.find( "<![CDATA[" );
+        if( cdataStart != string::npos ) {
+            const size_t cdataEnd = xPath.rfind( "]]>" );
+            xPath = xPath.substr( cdataStart + 9, cdataEnd == string::npos || cdataEnd < cdataStart ?
+                                  string::npos : cdataEnd - cdataStart - 9 );
+        }
+        else {
+            xPath = unescape( xPath );
+        }
+        addXPath( xPath );
+        ++mNumQueries;
+    }
+    return true;
+}
+
+/*!
+ * \brief Reduce a query XPath to the element paths it may touch.
+ * \param aXPath The XPath relative to the scenario, world or a region.
+ */
+void QueryPathPruner::addXPath( const string& aXPath ) {
+    const vector<string> steps = splitTopLevel( trim( removeComments( aXPath ) ), "/" );
+    Pattern pattern;
+    vector<Pattern> childPatterns;
+    bool isDescendant = false;
+    for( size_t i = 0; i < steps.size(); ++i ) {
+        const string step = trim( steps[ i ] );
+        if( step.empty() ) {
+            // A leading slash or the middle of //.
+            isDescendant = i > 0;
+            continue;
+        }
+        const size_t numSteps = pattern.size();
+        const bool isElement = parseStep( step, pattern, childPatterns );
+        if( mKeepEverything ) {
+            if( mUnreducedXPath.empty() ) {
+                mUnreducedXPath = trim( aXPath );
+            }
+            return;
+        }
+        if( !isElement ) {
+            break;
+        }
+        if( pattern.size() > numSteps ) {
+            pattern.back().mIsDescendant = pattern.back().mIsDescendant || isDescendant;
+            isDescendant = false;
+        }
+        else {
+            // A step such as . or descendant-or-self::node() which does not
+            // select an element itself.
+            isDescendant = isDescendant || step.compare( 0, 10, "descendant" ) == 0;
+        }
+    }
+
+    // A query which only touches the text of the level it is relative to
+    // needs nothing below it.
+    if( !pattern.empty() ) {
+        mPatterns.push_back( pattern );
+    }
+    mPatterns.insert( mPatterns.end(), childPatterns.begin(), childPatterns.end() );
+}
+
+/*!
+ * \brief Parse a single location step and add it to a pattern.
+ * \param aStep The step.
+ * \param aPattern The pattern to add the step to.
+ * \param aChildPatterns Patterns for children referred to by predicates.
+ * \return False if this step ends the element steps of the path.
+ */
+bool QueryPathPruner::parseStep( const string& aStep, Pattern& aPattern, vector<Pattern>& aChildPatterns ) {
+    const size_t predicateStart = aStep.find( '[' );
+    string test = trim( aStep.substr( 0, predicateStart ) );
+    Step step;
+    step.mIsDescendant = false;
+
+    // Deal with any axis.
+    const size_t axisEnd = test.find( "::" );
+    if( axisEnd != string::npos ) {
+        const string axis = test.substr( 0, axisEnd );
+        test = test.substr( axisEnd + 2 );
+        if( axis == "descendant" || axis == "descendant-or-self" ) {
+            step.mIsDescendant = true;
+        }
+        else if( axis == "attribute" ) {
+            return false;
+        }
+        else if( axis == "parent" || axis == "following-sibling" || axis == "preceding-sibling" ) {
+            // The parent of the previous step needs its full subtree.
+            if( aPattern.size() < 2 ) {
+                mKeepEverything = true;
+            }
+            else {
+                aPattern.pop_back();
+            }
+            return false;
+        }
+        else if( axis != "child" ) {
+            mKeepEverything = true;
+            return false;
+        }
+    }
+    if( test == ".." ) {
+        if( aPattern.size() < 2 ) {
+            mKeepEverything = true;
+        }
+        else {
+            aPattern.pop_back();
+        }
+        return false;
+    }
+    if( test == "." ) {
+        return true;
+    }
+    if( test.find( '(' ) != string::npos && test != "node()" && test != "text()" && test != "comment()" ) {
+        // Some other expression such as an XQuery function.
+        mKeepEverything = true;
+        return false;
+    }
+    if( test.empty() || test[ 0 ] == '@' || test.find( '(' ) != string::npos ) {
+        // An attribute or node test such as text() or node(), the previous step
+        // already keeps all of its content.
+        if( step.mIsDescendant && test == "node()" ) {
+            // descendant-or-self::node() is the long form of //
+            return true;
+        }
+        return false;
+    }
+    if( test != "*" && find_if( test.begin(), test.end(), []( char aChar ) { return !isNameChar( aChar ); } ) != test.end() ) {
+        mKeepEverything = true;
+        return false;
+    }
+    step.mName = test;
+
+    // Parse each predicate.
+    vector<string> childNames;
+    if( predicateStart != string::npos ) {
+        const vector<string> predicates = splitTopLevel( aStep.substr( predicateStart ), "][" );
+        for( size_t i = 0; i < predicates.size(); ++i ) {
+            string predicate = trim( predicates[ i ] );
+            if( !predicate.empty() && predicate[ 0 ] == '[' ) {
+                predicate.erase( 0, 1 );
+            }
+            if( !predicate.empty() && predicate[ predicate.size() - 1 ] == ']' ) {
+                predicate.erase( predicate.size() - 1 );
+            }
+            string type;
+            if( !parsePredicate( predicate, type, childNames ) ) {
+                mKeepEverything = true;
+                return false;
+            }
+            if( !type.empty() ) {
+                step.mType = type;
+            }
+        }
+    }
+    aPattern.push_back( step );
+
+    for( size_t i = 0; i < childNames.size(); ++i ) {
+        Pattern childPattern( aPattern );
+        Step childStep;
+        childStep.mName = childNames[ i ];
+        childStep.mIsDescendant = false;
+        childPattern.push_back( childStep );
+        aChildPatterns.push_back( childPattern );
+    }
+    return true;
+}
+
+/*!
+ * \brief Find the type required by a predicate and any child elements it
+ *        refers to.
+ * \param aPredicate The predicate without the brackets.
+ * \param aType Set to the required type if the predicate requires one.
+ * \param aChildNames Names of child elements referred to are added to this.
+ * \return False if the predicate uses an axis which can not be reduced.
+ */
+bool QueryPathPruner::parsePredicate( const string& aPredicate, string& aType,
+                                      vector<string>& aChildNames ) const
+{
+    // The type is only certain if it is required by a top level conjunction.
+    if( splitTopLevel( aPredicate, " or " ).size() == 1 ) {
+        const vector<string> terms = splitTopLevel( aPredicate, " and " );
+        for( size_t i = 0; i < terms.size(); ++i ) {
+            const string term = trim( terms[ i ] );
+            const size_t equals = term.find( '=' );
+            if( term.compare( 0, 5, "@type" ) == 0 && equals != string::npos &&
+                trim( term.substr( 5, equals - 5 ) ).empty() )
+            {
+                const string value = trim( term.substr( equals + 1 ) );
+                if( value.size() >= 2 && ( value[ 0 ] == '\'' || value[ 0 ] == '"' ) &&
+                    value[ value.size() - 1 ] == value[ 0 ] )
+                {
+                    aType = value.substr( 1, value.size() - 2 );
+                }
+            }
+        }
+    }
+
+    // Remove string literals before looking for element names.
+    string expr;
+    char quote = 0;
+    for( size_t i = 0; i < aPredicate.size(); ++i ) {
+        if( quote ) {
+            quote = aPredicate[ i ] == quote ? 0 : quote;
+        }
+        else if( aPredicate[ i ] == '\'' || aPredicate[ i ] == '"' ) {
+            quote = aPredicate[ i ];
+            expr += "''";
+        }
+        else {
+            expr += aPredicate[ i ];
+        }
+    }
+    // Paths to ancestors are fine as long as they only read attributes since the
+    // ancestors of anything matched are always written.
+    for( size_t pos = expr.find_first_of( ".:" ); pos != string::npos; pos = expr.find_first_of( ".:", pos + 1 ) ) {
+        size_t axisStart = pos;
+        if( expr.compare( pos, 2, ".." ) == 0 ) {
+            ++pos;
+        }
+        else if( expr.compare( pos, 2, "::" ) == 0 ) {
+            axisStart = expr.find_last_not_of( "abcdefghijklmnopqrstuvwxyz-", pos - 1 );
+            axisStart = axisStart == string::npos ? 0 : axisStart + 1;
+            const string axis = expr.substr( axisStart, pos - axisStart );
+            ++pos;
+            if( axis == "child" || axis == "attribute" || axis == "self" ) {
+                continue;
+            }
+            if( axis != "parent" && axis.compare( 0, 8, "ancestor" ) != 0 ) {
+                return false;
+            }
+        }
+        else {
+            continue;
+        }
+        // Find the end of this path and check that the last step is an attribute.
+        size_t pathEnd = pos + 1;
+        int depth = 0;
+        while( pathEnd < expr.size() && ( depth > 0 || isNameChar( expr[ pathEnd ] ) ||
+               string( "/:*@[" ).find( expr[ pathEnd ] ) != string::npos ) )
+        {
+            depth += expr[ pathEnd ] == '[' ? 1 : expr[ pathEnd ] == ']' ? -1 : 0;
+            ++pathEnd;
+        }
+        const string path = expr.substr( axisStart, pathEnd - axisStart );
+        const size_t lastStep = path.rfind( '/' );
+        if( lastStep == string::npos || path.compare( lastStep + 1, 1, "@" ) != 0 ) {
+            return false;
+        }
+        // Skip the names in the path so they are not taken as children.
+        expr.replace( axisStart, pathEnd - axisStart, pathEnd - axisStart, ' ' );
+        pos = axisStart;
+    }
+
+    const char* keywords[] = { "and", "or", "div", "mod", "eq", "ne", "lt", "le", "gt", "ge" };
+    for( size_t i = 0; i < expr.size(); ) {
+        if( !isalpha( static_cast<unsigned char>( expr[ i ] ) ) && expr[ i ] != '_' ) {
+            ++i;
+            continue;
+        }
+        size_t end = i;
+        while( end < expr.size() && isNameChar( expr[ end ] ) ) {
+            ++end;
+        }
+        const string name = expr.substr( i, end - i );
+        const size_t prev = expr.find_last_not_of( " \t\r\n", i == 0 ? string::npos : i - 1 );
+        const char prevChar = i == 0 || prev == string::npos ? 0 : expr[ prev ];
+        const size_t next = expr.find_first_not_of( " \t\r\n", end );
+        const char nextChar = next == string::npos ? 0 : expr[ next ];
+        i = end;
+
+        if( prevChar == '@' || prevChar == '$' || prevChar == '/' || nextChar == '(' ) {
+            // An attribute, variable, part of a child path or function call.
+            continue;
+        }
+        if( nextChar == ':' ) {
+            // An axis, the element name after it will be checked next.
+            if( name != "child" && name != "attribute" && name != "self" ) {
+                return false;
+            }
+            continue;
+        }
+        if( prevChar == ':' ) {
+            const size_t axisEnd = expr.rfind( "::", prev );
+            const size_t axisStart = expr.find_last_not_of( "abcdefghijklmnopqrstuvwxyz-", axisEnd - 1 );
+            const string axis = expr.substr( axisStart == string::npos ? 0 : axisStart + 1,
+                                             axisEnd - ( axisStart == string::npos ? 0 : axisStart + 1 ) );
+            if( axis == "child" ) {
+                aChildNames.push_back( name );
+            }
+            continue;
+        }
+        if( find( keywords, keywords + sizeof( keywords ) / sizeof( keywords[ 0 ] ), name ) !=
+            keywords + sizeof( keywords ) / sizeof( keywords[ 0 ] ) )
+        {
+            continue;
+        }
+        aChildNames.push_back( name );
+    }
+    return true;
+}
+
+//! Whether an element matches a step.
+bool QueryPathPruner::matches( const Step& aStep, const string& aName, const string& aType ) const {
+    return ( aStep.mName == "*" || aStep.mName == aName ) && ( aStep.mType.empty() || aStep.mType == aType );
+}
+
+/*!
+ * \brief Start an element which the outputter is about to write.
+ * \details Every call must be matched by a call to endElement, including for
+ *          elements which are skipped, so that the open elements are tracked
+ *          correctly.
+ * \param aName The element name.
+ * \param aType The type attribute of the element or empty if it has none.
+ * \return Whether the element should be written, if not nothing within it
+ *         should be written either.
+ */
+bool QueryPathPruner::startElement( const string& aName, const string& aType ) {
+    Element element;
+    element.mIsKept = false;
+    element.mIsSkipped = false;
+    if( mElements.empty() ) {
+        // The root is always written.
+        for( size_t p = 0; p < mPatterns.size(); ++p ) {
+            element.mPositions.push_back( Position( static_cast<int>( p ), 0 ) );
+        }
+        mElements.push_back( element );
+        ++mNumWritten;
+        return true;
+    }
+
+    const Element& parent = mElements.back();
+    if( parent.mIsSkipped || parent.mIsKept ) {
+        element.mIsSkipped = parent.mIsSkipped;
+        element.mIsKept = parent.mIsKept;
+        mElements.push_back( element );
+        mNumWritten += element.mIsKept ? 1 : 0;
+        return element.mIsKept;
+    }
+
+    for( size_t i = 0; i < parent.mPositions.size() && !element.mIsKept; ++i ) {
+        const Position& position = parent.mPositions[ i ];
+        const Step& step = mPatterns[ position.first ][ position.second ];
+        if( step.mIsDescendant ) {
+            element.mPositions.push_back( position );
+        }
+        if( matches( step, aName, aType ) ) {
+            if( position.second + 1 == static_cast<int>( mPatterns[ position.first ].size() ) ) {
+                // Write this subtree in full.
+                element.mIsKept = true;
+            }
+            else {
+                element.mPositions.push_back( Position( position.first, position.second + 1 ) );
+            }
+        }
+    }
+
+    // Queries may be relative to the scenario, world, or a region.
+    if( !element.mIsKept && mElements.size() < 3 ) {
+        for( size_t p = 0; p < mPatterns.size(); ++p ) {
+            element.mPositions.push_back( Position( static_cast<int>( p ), 0 ) );
+        }
+    }
+    if( element.mIsKept ) {
+        element.mPositions.clear();
+    }
+    else if( element.mPositions.empty() ) {
+        element.mIsSkipped = true;
+        ++mNumSkipped;
+    }
+    else {
+        sort( element.mPositions.begin(), element.mPositions.end() );
+        element.mPositions.erase( unique( element.mPositions.begin(), element.mPositions.end() ),
+                                  element.mPositions.end() );
+    }
+    mNumWritten += element.mIsSkipped ? 0 : 1;
+    mElements.push_back( element );
+    return !element.mIsSkipped;
+}
+
+/*!
+ * \brief End the element which was most recently started.
+ * \return Whether the element was written.
+ */
+bool QueryPathPruner::endElement() {
+    assert( !mElements.empty() );
+    const bool isWritten = !mElements.back().mIsSkipped;
+    mElements.pop_back();
+    return isWritten;
+}
+
+/*!
+ * \brief Whether a value of the current element is needed by a query.
+ * \details Values are written as elements without a type and without children
+ *          so they are needed if they complete a query path.
+ * \param aName The element name of the value.
+ * \return Whether the value should be written.
+ */
+bool QueryPathPruner::isItemNeeded( const string& aName ) const {
+    if( mElements.empty() || mElements.back().mIsKept ) {
+        return true;
+    }
+    const Element& parent = mElements.back();
+    for( size_t i = 0; i < parent.mPositions.size(); ++i ) {
+        const Position& position = parent.mPositions[ i ];
+        if( position.second + 1 == static_cast<int>( mPatterns[ position.first ].size() ) &&
+            matches( mPatterns[ position.first ][ position.second ], aName, "" ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
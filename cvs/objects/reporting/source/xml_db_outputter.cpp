@@ -132,8 +132,15 @@
 #include <sstream>
 
 #include <boost/math/tr1.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/pipeline.h>
+#include <tbb/task_scheduler_init.h>
+#endif
 
 #include "reporting/include/xml_db_outputter.h"
+#include "reporting/include/query_path_pruner.h"
 
 extern Scenario* scenario; // for modeltime
 
@@ -180,11 +187,33 @@ XMLDBOutputter::JNIContainer::~JNIContainer() {
 */
 XMLDBOutputter::XMLDBOutputter():
 mTabs( new Tabs ),
-mGDP( 0 )
+mGDP( 0 ),
+mWriteRegionsInParallel( false )
 #if( __HAVE_JAVA__ )
 ,mJNIContainer( createContainer( false ) )
 #endif
 {
+    // Optionally drop any output which the configured queries can not reach.
+    const Configuration* conf = Configuration::getInstance();
+    if( conf->shouldWriteFile( "xmldb-query-filter", false, false ) ) {
+        const string queryFileName = conf->getFile( "xmldb-query-filter", "", false );
+        boost::shared_ptr<QueryPathPruner> pruner( new QueryPathPruner );
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        if( !pruner->readQueries( queryFileName ) ) {
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Could not read queries from " << queryFileName
+                    << ", all output will be written to the XML database." << endl;
+        }
+        else if( !pruner->isPruning() ) {
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Could not determine the output needed by the query " << pruner->getUnreducedXPath()
+                    << ", all output will be written to the XML database." << endl;
+        }
+        else {
+            mPruner = pruner;
+        }
+    }
+
 #if( DEBUG_XML_DB )
     // Have data written to mBuffer go to the debug_db file as well.
     file_sink debugDBSink( "debug_db.xml" );
@@ -200,6 +229,31 @@ mGDP( 0 )
 #else
     mBuffer.push( null_sink() );
 #endif
+
+    mWriteRegionsInParallel = conf->getBool( "xmldb-parallel-regions", true );
+}
+
+/*!
+ * \brief Constructor for an outputter which writes a single region to a string.
+ * \details The region is written at the indentation of aTabs so that the string
+ *          can later be appended to the buffer of the outputter visiting the
+ *          world.
+ * \param aTabs The indentation of the outputter visiting the world.
+ * \param aPruner The pruner of the outputter visiting the world which is copied
+ *        so that the region continues from the world, or null if not pruning.
+ * \param aOutput The string to write the region into.
+ * \see visitRegions
+ */
+XMLDBOutputter::XMLDBOutputter( const Tabs& aTabs, const QueryPathPruner* aPruner, string& aOutput ):
+mTabs( new Tabs( aTabs ) ),
+mGDP( 0 ),
+mPruner( aPruner ? new QueryPathPruner( *aPruner ) : 0 ),
+mWriteRegionsInParallel( false )
+#if( __HAVE_JAVA__ )
+,mJNIContainer( 0 )
+#endif
+{
+    mBuffer.push( back_insert_device<string>( aOutput ) );
 }
 
 /*!
@@ -243,6 +297,13 @@ void XMLDBOutputter::finish() const {
     // Close mBuffer so that no more data can be written.
     close( mBuffer, ios_base::out );
 
+    if( mPruner.get() ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Skipped " << mPruner->getNumSkipped() << " subtrees which the queries do not need and wrote "
+                << mPruner->getNumWritten() << " elements to the XML database." << endl;
+    }
+
 #if( __HAVE_JAVA__ )
     if( !mJNIContainer.get() ) {
         // Failed to start Java, just return as an appropriate error message would
@@ -477,6 +538,9 @@ bool XMLDBOutputter::appendData( const string& aData, const string& aLocation )
 }
 
 void XMLDBOutputter::startVisitScenario( const Scenario* aScenario, const int aPeriod ){
+    // The scenario is the root which is always written.
+    startElement( aScenario->getXMLNameStatic() );
+
     // write heading for XML input file
     mBuffer << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl;
     mBuffer << "<" << aScenario->getXMLNameStatic() << " name=\""
@@ -491,20 +555,77 @@ void XMLDBOutputter::startVisitScenario( const Scenario* aScenario, const int aP
 }
 
 void XMLDBOutputter::endVisitScenario( const Scenario* aScenario, const int aPeriod ){
+    endElement();
+
     // Write the closing scenario tag.
     XMLWriteClosingTag( aScenario->getXMLNameStatic(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitWorld( const World* aWorld, const int aPeriod ){
+    if( !startElement( aWorld->getXMLNameStatic() ) ) {
+        return;
+    }
+
     // Write the opening world tag.
     XMLWriteOpeningTag( aWorld->getXMLNameStatic(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::endVisitWorld( const World* aWorld, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing world tag.
     XMLWriteClosingTag( aWorld->getXMLNameStatic(), mBuffer, mTabs.get() );
 }
 
+/*!
+ * \brief Write the regions concurrently when running in parallel.
+ * \details Each region is written into its own string by a separate outputter
+ *          so that no state is shared between them.  A pipeline then appends
+ *          the strings to mBuffer in the order of the regions, which keeps the
+ *          document identical to one written serially while limiting the number
+ *          of finished regions held in memory.
+ * \param aRegions The regions of the world in order.
+ * \param aPeriod The period being visited.
+ * \return Whether the regions were written.
+ */
+bool XMLDBOutputter::visitRegions( const vector<Region*>& aRegions, const int aPeriod ) {
+#if GCAM_PARALLEL_ENABLED
+    if( !mWriteRegionsInParallel || aRegions.size() < 2 ) {
+        return false;
+    }
+
+    size_t nextRegion = 0;
+    const Tabs& tabs = *mTabs;
+    const QueryPathPruner* pruner = mPruner.get();
+    tbb::parallel_pipeline( tbb::task_scheduler_init::default_num_threads(),
+        tbb::make_filter<void, size_t>( tbb::filter::serial_in_order,
+            [&nextRegion, &aRegions]( tbb::flow_control& aControl ) -> size_t {
+                if( nextRegion == aRegions.size() ) {
+                    aControl.stop();
+                }
+                return nextRegion++;
+            } ) &
+        tbb::make_filter<size_t, string*>( tbb::filter::parallel,
+            [&aRegions, &tabs, pruner, aPeriod]( const size_t aIndex ) -> string* {
+                string* regionXML = new string;
+                XMLDBOutputter regionOutputter( tabs, pruner, *regionXML );
+                aRegions[ aIndex ]->accept( &regionOutputter, aPeriod );
+                regionOutputter.mBuffer.flush();
+                return regionXML;
+            } ) &
+        tbb::make_filter<string*, void>( tbb::filter::serial_in_order,
+            [this]( string* aRegionXML ) {
+                mBuffer.write( aRegionXML->data(), aRegionXML->size() );
+                delete aRegionXML;
+            } ) );
+    return true;
+#else
+    return false;
+#endif
+}
+
 void XMLDBOutputter::startVisitRegion( const Region* aRegion,
                                        const int aPeriod )
 {
@@ -523,6 +644,10 @@ void XMLDBOutputter::startVisitRegionMiniCAM( const RegionMiniCAM* aRegionMiniCA
     assert( !mGDP );
     mGDP = aRegionMiniCAM->mGDP;
 
+    if( !startElement( aRegionMiniCAM->getXMLName(), Region::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // Write the opening region tag and the type of the base class.
     XMLWriteOpeningTag( aRegionMiniCAM->getXMLName(), mBuffer, mTabs.get(),
         aRegionMiniCAM->getName(), 0, Region::getXMLNameStatic() );
@@ -536,11 +661,19 @@ void XMLDBOutputter::endVisitRegionMiniCAM( const RegionMiniCAM* aRegionMiniCAM,
     mCurrentRegion.clear();
     mGDP = 0;
 
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing region tag.
     XMLWriteClosingTag( aRegionMiniCAM->getXMLName(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitRegionCGE( const RegionCGE* aRegionCGE, const int aPeriod ) {
+    if( !startElement( aRegionCGE->getXMLName(), Region::getXMLNameStatic() ) ) {
+        return;
+    }
+
        // Write the opening region tag and the type of the base class.
     XMLWriteOpeningTag( aRegionCGE->getXMLName(), mBuffer, mTabs.get(),
         aRegionCGE->getName(), 0, Region::getXMLNameStatic() );
@@ -551,6 +684,10 @@ void XMLDBOutputter::endVisitRegionCGE( const RegionCGE* aRegionCGE, const int a
     // Clear the region name.
     mCurrentRegion.clear();
 
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing region tag.
     XMLWriteClosingTag( aRegionCGE->getXMLName(), mBuffer, mTabs.get() );
 }
@@ -558,6 +695,10 @@ void XMLDBOutputter::endVisitRegionCGE( const RegionCGE* aRegionCGE, const int a
 void XMLDBOutputter::startVisitResource( const AResource* aResource,
                                          const int aPeriod )
 {
+    if( !startElement( aResource->getXMLName(), "resource" ) ) {
+        return;
+    }
+
     // Write the opening resource tag and the type of the base class.
     XMLWriteOpeningTag( aResource->getXMLName(), mBuffer, mTabs.get(),
         aResource->getName(), 0, "resource" );
@@ -587,6 +728,10 @@ void XMLDBOutputter::startVisitResource( const AResource* aResource,
 void XMLDBOutputter::endVisitResource( const AResource* aResource,
                                        const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the ghgs which put their output into the buffer stack.  We
     // are not too concerned with writing empty tags at the resource
     // level so we are not doing the full parent child buffers as in
@@ -609,6 +754,10 @@ void XMLDBOutputter::endVisitResource( const AResource* aResource,
 void XMLDBOutputter::startVisitSubResource( const SubResource* aSubResource,
                                             const int aPeriod )
 {
+    if( !startElement( aSubResource->getXMLName(), "subresource" ) ) {
+        return;
+    }
+
     // Write the opening subresource tag and the type of the base class.
     XMLWriteOpeningTag( aSubResource->getXMLName(), mBuffer, mTabs.get(),
         aSubResource->getName(), 0, "subresource" );
@@ -624,6 +773,10 @@ void XMLDBOutputter::startVisitSubResource( const SubResource* aSubResource,
 void XMLDBOutputter::endVisitSubResource( const SubResource* aSubResource,
                                           const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing subresource tag.
     XMLWriteClosingTag( aSubResource->getXMLName(), mBuffer, mTabs.get() );
 }
@@ -631,6 +784,10 @@ void XMLDBOutputter::endVisitSubResource( const SubResource* aSubResource,
 void XMLDBOutputter::startVisitSubRenewableResource( const SubRenewableResource* aSubResource,
                                                      const int aPeriod )
 {
+    if( !startElement( aSubResource->getXMLNameStatic(), "subresource" ) ) {
+        return;
+    }
+
     // Write the opening subresource tag and the type of the base class.
     XMLWriteOpeningTag( aSubResource->getXMLNameStatic(), mBuffer, mTabs.get(),
                        aSubResource->getName(), 0, "subresource" );
@@ -647,6 +804,10 @@ void XMLDBOutputter::startVisitSubRenewableResource( const SubRenewableResource*
 void XMLDBOutputter::endVisitSubRenewableResource( const SubRenewableResource* aSubResource,
                                                         const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing subresource tag.
     XMLWriteClosingTag( aSubResource->getXMLNameStatic(), mBuffer, mTabs.get() );
 }
@@ -658,6 +819,10 @@ void XMLDBOutputter::endVisitSubRenewableResource( const SubRenewableResource* a
 *       the subresource or redo grade.
 */
 void XMLDBOutputter::startVisitGrade( const Grade* aGrade, const int aPeriod ){
+    if( !startElement( aGrade->getXMLName() ) ) {
+        return;
+    }
+
     /*! \pre The function should always be called with the all period output. */
     // Write the opening subresource tag and.
     XMLWriteOpeningTag( aGrade->getXMLName(), mBuffer, mTabs.get(), aGrade->getName() );
@@ -675,11 +840,19 @@ void XMLDBOutputter::startVisitGrade( const Grade* aGrade, const int aPeriod ){
 }
 
 void XMLDBOutputter::endVisitGrade( const Grade* aGrade, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing subresource tag.
     XMLWriteClosingTag( aGrade->getXMLName(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitSector( const Sector* aSector, const int aPeriod ){
+    if( !startElement( aSector->getXMLName(), "sector" ) ) {
+        return;
+    }
+
     // Store the sector name and units.
     mCurrentSector = aSector->getName();
     mCurrentPriceUnit = aSector->mPriceUnit;
@@ -707,6 +880,10 @@ void XMLDBOutputter::startVisitSector( const Sector* aSector, const int aPeriod
 }
 
 void XMLDBOutputter::endVisitSector( const Sector* aSector, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing sector tag.
     XMLWriteClosingTag( aSector->getXMLName(), mBuffer, mTabs.get() );
 
@@ -720,6 +897,10 @@ void XMLDBOutputter::endVisitSector( const Sector* aSector, const int aPeriod ){
 void XMLDBOutputter::startVisitSubsector( const Subsector* aSubsector,
                                           const int aPeriod )
 {
+    if( !startElement( aSubsector->getXMLName(), Subsector::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // Write the opening subsector tag and the type of the base class.
     XMLWriteOpeningTag( aSubsector->getXMLName(), mBuffer, mTabs.get(),
         aSubsector->getName(), 0, Subsector::getXMLNameStatic() );
@@ -742,6 +923,10 @@ void XMLDBOutputter::startVisitSubsector( const Subsector* aSubsector,
 void XMLDBOutputter::endVisitSubsector( const Subsector* aSubsector,
                                         const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing subsector tag.
     XMLWriteClosingTag( aSubsector->getXMLName(), mBuffer, mTabs.get() );
 }
@@ -764,6 +949,10 @@ void XMLDBOutputter::endVisitTranSubsector( const TranSubsector* aTranSubsector,
 }
 
 void XMLDBOutputter::startVisitEnergyFinalDemand( const EnergyFinalDemand* aEnergyFinalDemand, const int aPeriod ){
+    if( !startElement( aEnergyFinalDemand->getXMLNameStatic(), "final-demand" ) ) {
+        return;
+    }
+
     // Write the opening finalDemand tag and the type of the base class.
     XMLWriteOpeningTag( aEnergyFinalDemand->getXMLNameStatic(), mBuffer, mTabs.get(),
         aEnergyFinalDemand->getName(), 0, "final-demand" );
@@ -776,6 +965,9 @@ void XMLDBOutputter::startVisitEnergyFinalDemand( const EnergyFinalDemand* aEner
 }
 
 void XMLDBOutputter::endVisitEnergyFinalDemand( const EnergyFinalDemand* aEnergyFinalDemand, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
 
 
     // Write the closing finalDemand tag.
@@ -806,6 +998,10 @@ void XMLDBOutputter::endVisitBaseTechnology( const BaseTechnology* aBaseTech, co
  * \param aPeriod 
  */
 void XMLDBOutputter::startVisitTechnology( const Technology* aTechnology, const int aPeriod ){
+    if( !startElement( aTechnology->getXMLName(), DefaultTechnology::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // Store the pointer to the current technology so that children of technology can access 
     // information on current technology.
     mCurrentTechnology = aTechnology;
@@ -852,6 +1048,10 @@ void XMLDBOutputter::startVisitTechnology( const Technology* aTechnology, const
 void XMLDBOutputter::endVisitTechnology( const Technology* aTechnology,
                                          const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     // Clear the stored technology information.
     mCurrentTechnology = 0; // reset technology pointer to null
     fill( mCurrIndirectEmissions.begin(), mCurrIndirectEmissions.end(), 0.0 );
@@ -883,6 +1083,10 @@ void XMLDBOutputter::endVisitTechnology( const Technology* aTechnology,
 }
 
 void XMLDBOutputter::startVisitTranTechnology( const TranTechnology* aTranTechnology, const int aPeriod ) {
+    if( isSkipping() ) {
+        return;
+    }
+
     // tran startVisitTranTechnology gets visited after startVisitTechnology which implies
     // mBufferStack.top() is the child buffer for technology
     writeItemToBuffer( aTranTechnology->mLoadFactor, "load-factor", 
@@ -897,7 +1101,10 @@ void XMLDBOutputter::startVisitMiniCAMInput( const MiniCAMInput* aInput, const i
     // we use startVisitInput to write out the generic input information, however
     // startVisitInput will never be called by an accept so we do it here
     startVisitInput( aInput, aPeriod );
-        
+    if( isSkipping() ) {
+        return;
+    }
+
     // We want to write the keywords last due to limitations in 
     // XPath we could be searching for them using following-sibling
     // note that mBufferStack.top() is the child buffer for input
@@ -912,6 +1119,10 @@ void XMLDBOutputter::endVisitMiniCAMInput( const MiniCAMInput* aInput, const int
 }
 
 void XMLDBOutputter::startVisitInput( const IInput* aInput, const int aPeriod ) {
+    if( !startElement( aInput->getXMLReportingName(), "input" ) ) {
+        return;
+    }
+
     // write the input tag and it's children in temp buffers so that we can
     // check if anything was really written out and avoid writing blank inputs
     stringstream* parentBuffer = new stringstream();
@@ -1001,6 +1212,10 @@ void XMLDBOutputter::startVisitInput( const IInput* aInput, const int aPeriod )
 }
 
 void XMLDBOutputter::endVisitInput( const IInput* aInput, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the input (open tag, children, and closing tag) to the buffer at
     // the top of the stack only if the child buffer is not empty
     iostream* childBuffer = popBufferStack();
@@ -1022,6 +1237,10 @@ void XMLDBOutputter::endVisitInput( const IInput* aInput, const int aPeriod ) {
 }
 
 void XMLDBOutputter::startVisitOutput( const IOutput* aOutput, const int aPeriod ) {
+    if( !startElement( aOutput->getXMLReportingName(), "output" ) ) {
+        return;
+    }
+
     // write the output tag and it's children in temp buffers so that we can
     // check if anything was really written out and avoid writing blank outputs
     stringstream* parentBuffer = new stringstream();
@@ -1072,6 +1291,10 @@ void XMLDBOutputter::startVisitOutput( const IOutput* aOutput, const int aPeriod
 }
 
 void XMLDBOutputter::endVisitOutput( const IOutput* aOutput, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the output (open tag, children, and closing tag) to the buffer at
     // the top of the stack only if the child buffer is not empty
     iostream* childBuffer = popBufferStack();
@@ -1095,6 +1318,10 @@ void XMLDBOutputter::endVisitOutput( const IOutput* aOutput, const int aPeriod )
 void XMLDBOutputter::startVisitAgProductionTechnology( const AgProductionTechnology* aAgProductionTechnology,
                                                          const int aPeriod )
 {
+    if( isSkipping() ) {
+        return;
+    }
+
     // Write out the non-energy cost assumed to be in same unit as sector price.
     writeItemToBuffer( aAgProductionTechnology->mNonLandVariableCost, "nonLandVariableCost", 
         *mBufferStack.top(), mTabs.get(), -1, "" );
@@ -1112,6 +1339,10 @@ void XMLDBOutputter::endVisitAgProductionTechnology( const AgProductionTechnolog
 }
 
 void XMLDBOutputter::startVisitGHG( const AGHG* aGHG, const int aPeriod ){
+    if( !startElement( aGHG->getXMLName(), "GHG" ) ) {
+        return;
+    }
+
     // write the ghg tag and it's children in temp buffers so that we can
     // check if anything was really written out and avoid writing blank ghgs
     stringstream* parentBuffer = new stringstream();
@@ -1171,6 +1402,10 @@ void XMLDBOutputter::startVisitGHG( const AGHG* aGHG, const int aPeriod ){
 }
 
 void XMLDBOutputter::endVisitGHG( const AGHG* aGHG, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the ghg (open tag, children, and closing tag) to the buffer at
     // the top of the stack only if the child buffer is not empty
     iostream* childBuffer = popBufferStack();
@@ -1194,6 +1429,10 @@ void XMLDBOutputter::endVisitGHG( const AGHG* aGHG, const int aPeriod ){
 void XMLDBOutputter::startVisitMarketplace( const Marketplace* aMarketplace,
                                             const int aPeriod )
 {
+    if( !startElement( Marketplace::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // Write the opening marketplace tag.
     XMLWriteOpeningTag( Marketplace::getXMLNameStatic(), mBuffer, mTabs.get() );
 }
@@ -1201,6 +1440,10 @@ void XMLDBOutputter::startVisitMarketplace( const Marketplace* aMarketplace,
 void XMLDBOutputter::endVisitMarketplace( const Marketplace* aMarketplace,
                                           const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing marketplace tag.
     XMLWriteClosingTag( Marketplace::getXMLNameStatic(), mBuffer, mTabs.get() );
     mCurrentMarket.clear();
@@ -1212,6 +1455,10 @@ void XMLDBOutputter::endVisitMarketplace( const Marketplace* aMarketplace,
 void XMLDBOutputter::startVisitMarket( const Market* aMarket,
                                        const int aPeriod )
 {
+    if( !startElement( Market::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // Write the opening market tag.
     XMLWriteOpeningTag( Market::getXMLNameStatic(), mBuffer, mTabs.get(),
                         aMarket->getName(), aMarket->getYear() );
@@ -1248,6 +1495,10 @@ void XMLDBOutputter::startVisitMarket( const Market* aMarket,
 }
 
 void XMLDBOutputter::endVisitMarket( const Market* aMarket, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing market tag.
     XMLWriteClosingTag( Market::getXMLNameStatic(), mBuffer, mTabs.get() );
 }
@@ -1260,6 +1511,10 @@ void XMLDBOutputter::endVisitMarket( const Market* aMarket, const int aPeriod ){
 void XMLDBOutputter::startVisitClimateModel( const IClimateModel* aClimateModel,
                                              const int aPeriod )
 {
+    if( !startElement( "climate-model" ) ) {
+        return;
+    }
+
     /*! \pre The function should always be called with the all period output. */
     assert( aPeriod == -1 );
     // Write the opening tag.
@@ -1452,6 +1707,10 @@ void XMLDBOutputter::startVisitClimateModel( const IClimateModel* aClimateModel,
 void XMLDBOutputter::endVisitClimateModel( const IClimateModel* aClimateModel,
                                            const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the closing tag.
     XMLWriteClosingTag( "climate-model", mBuffer, mTabs.get() );
 }
@@ -1459,12 +1718,20 @@ void XMLDBOutputter::endVisitClimateModel( const IClimateModel* aClimateModel,
 void XMLDBOutputter::startVisitDemographic( const Demographic* aDemographic,
                                             const int aPeriod )
 {
+    if( !startElement( aDemographic->getXMLName() ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( aDemographic->getXMLName(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::endVisitDemographic( const Demographic* aDemographic,
                                           const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( aDemographic->getXMLName(), mBuffer, mTabs.get() );
 }
 
@@ -1480,33 +1747,61 @@ void XMLDBOutputter::endVisitPopulation( const Population* aPopulation, const in
 }
 
 void XMLDBOutputter::startVisitPopulationMiniCAM( const PopulationMiniCAM* aPopulation, const int aPeriod ){
+    if( !startElement( PopulationMiniCAM::getXMLNameStatic() ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( PopulationMiniCAM::getXMLNameStatic(), mBuffer, mTabs.get(),
                         "", aPopulation->getYear() );
 }
 
 void XMLDBOutputter::endVisitPopulationMiniCAM( const PopulationMiniCAM* aPopulation, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( PopulationMiniCAM::getXMLNameStatic(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitPopulationSGMRate( const PopulationSGMRate* aPopulation, const int aPeriod ){
+    if( !startElement( PopulationSGMRate::getXMLNameStatic() ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( PopulationSGMRate::getXMLNameStatic(), mBuffer, mTabs.get(),
                         "", aPopulation->getYear() );
 }
 
 void XMLDBOutputter::endVisitPopulationSGMRate( const PopulationSGMRate* aPopulation, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( PopulationSGMRate::getXMLNameStatic(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitPopulationSGMFixed( const PopulationSGMFixed* aPopulation, const int aPeriod ){
+    if( !startElement( PopulationSGMFixed::getXMLNameStatic() ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( PopulationSGMFixed::getXMLNameStatic(), mBuffer, mTabs.get(),
                         "", aPopulation->getYear() );
 }
 
 void XMLDBOutputter::endVisitPopulationSGMFixed( const PopulationSGMFixed* aPopulation, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( PopulationSGMFixed::getXMLNameStatic(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitAgeCohort( const AgeCohort* aAgeCohort, const int aPeriod ){
+    if( !startElement( AgeCohort::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // have to write out tag by hand because of the "ageGroup" attribtue
     Tabs* tabs = mTabs.get();
     tabs->writeTabs( mBuffer );
@@ -1516,19 +1811,35 @@ void XMLDBOutputter::startVisitAgeCohort( const AgeCohort* aAgeCohort, const int
 }
 
 void XMLDBOutputter::endVisitAgeCohort( const AgeCohort* aAgeCohort, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( AgeCohort::getXMLNameStatic(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitGender( const Gender* aGender, const int aPeriod ){
+    if( !startElement( aGender->getXMLName() ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( aGender->getXMLName(), mBuffer, mTabs.get() );
     writeItem( "population", "thous", aGender->getPopulation(), 0 );
 }
 
 void XMLDBOutputter::endVisitGender( const Gender* aGender, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( aGender->getXMLName(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitGDP( const GDP* aGDP, const int aPeriod ){
+    if( !startElement( GDP::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // Write the opening gdp tag.
     XMLWriteOpeningTag( GDP::getXMLNameStatic(), mBuffer, mTabs.get() );
 
@@ -1557,11 +1868,19 @@ void XMLDBOutputter::startVisitGDP( const GDP* aGDP, const int aPeriod ){
 }
 
 void XMLDBOutputter::endVisitGDP( const GDP* aGDP, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( GDP::getXMLNameStatic(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitLandNode( const LandNode* aLandNode,
                                          const int aPeriod ){
+    if( !startElement( LandNode::getXMLNameStatic() ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( LandNode::getXMLNameStatic(), mBuffer, mTabs.get(),
                         aLandNode->getName() );
 }
@@ -1569,12 +1888,20 @@ void XMLDBOutputter::startVisitLandNode( const LandNode* aLandNode,
 void XMLDBOutputter::endVisitLandNode( const LandNode* aLandNode,
                                        const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( LandNode::getXMLNameStatic(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitLandLeaf( const LandLeaf* aLandLeaf,
                                          const int aPeriod )
 {
+    if( !startElement( LandLeaf::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // Write the opening LandLeaf tag except we need to decompose the name and write
     // each out as an attribute.
     // TODO: just put this in as a utility such as XMLWriteOpeningTagWithAttributes?
@@ -1610,10 +1937,18 @@ void XMLDBOutputter::startVisitLandLeaf( const LandLeaf* aLandLeaf,
 }
 
 void XMLDBOutputter::endVisitLandLeaf( const LandLeaf* aLandLeaf, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( "LandLeaf", mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitCarbonCalc( const ICarbonCalc* aCarbonCalc, const int aPeriod ){
+    if( !startElement( LandCarbonDensities::getXMLNameStatic() ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( LandCarbonDensities::getXMLNameStatic(), mBuffer, mTabs.get() );
 
     // Loop over the periods to output Carbon information.
@@ -1647,10 +1982,18 @@ void XMLDBOutputter::startVisitCarbonCalc( const ICarbonCalc* aCarbonCalc, const
 }
 
 void XMLDBOutputter::endVisitCarbonCalc( const ICarbonCalc* aCarbonCalc, const int aPeriod ){
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( LandCarbonDensities::getXMLNameStatic(), mBuffer, mTabs.get() );
 } 
 
 void XMLDBOutputter::startVisitExpenditure( const Expenditure* aExpenditure, const int aPeriod ) {
+    if( !startElement( "expenditure" ) ) {
+        return;
+    }
+
     // write the expenditure tag and it's children in temp buffers so that we can
     // check if anything was really written out and avoid writing blank expenditures
     stringstream* parentBuffer = new stringstream();
@@ -1677,6 +2020,10 @@ void XMLDBOutputter::startVisitExpenditure( const Expenditure* aExpenditure, con
 }
 
 void XMLDBOutputter::endVisitExpenditure( const Expenditure* aExpenditure, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the expenditure (open tag, children, and closing tag) to the buffer at
     // the top of the stack only if the child buffer is not empty
     iostream* childBuffer = popBufferStack();
@@ -1713,6 +2060,10 @@ void XMLDBOutputter::endVisitSGMInput( const SGMInput* aInput, const int aPeriod
 }
 
 void XMLDBOutputter::startVisitNodeInput( const NodeInput* aNodeInput, const int aPeriod ) {
+    if( !startElement( NodeInput::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // write the nodeInput tag and it's children in temp buffers so that we can
     // check if anything was really written out and avoid writing blank nodeInputs
     // which will be very often since we are currently only writing aidads paramaters
@@ -1739,6 +2090,10 @@ void XMLDBOutputter::startVisitNodeInput( const NodeInput* aNodeInput, const int
 }
 
 void XMLDBOutputter::endVisitNodeInput( const NodeInput* aNodeInput, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the nodeInput (open tag, children, and closing tag) to the buffer at
     // the top of the stack only if the child buffer is not empty
     iostream* childBuffer = popBufferStack();
@@ -1762,6 +2117,10 @@ void XMLDBOutputter::endVisitNodeInput( const NodeInput* aNodeInput, const int a
 void XMLDBOutputter::startVisitHouseholdConsumer( const HouseholdConsumer* aHouseholdConsumer,
                                                  const int aPeriod )
 {
+    if( !startElement( aHouseholdConsumer->getXMLName(), "baseTechnology" ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( aHouseholdConsumer->getXMLName(), mBuffer, mTabs.get(), aHouseholdConsumer->getName(),
         aHouseholdConsumer->getYear(), "baseTechnology" );
 
@@ -1796,6 +2155,10 @@ void XMLDBOutputter::startVisitHouseholdConsumer( const HouseholdConsumer* aHous
 void XMLDBOutputter::endVisitHouseholdConsumer( const HouseholdConsumer* aHouseholdConsumer,
                                                const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     // the node inputs would have written themselves so we just need to pop the stack
     // and copy the data to mBuffer
     iostream* parentBuffer = popBufferStack();
@@ -1808,6 +2171,10 @@ void XMLDBOutputter::endVisitHouseholdConsumer( const HouseholdConsumer* aHouseh
 }
 
 void XMLDBOutputter::startVisitGovtConsumer( const GovtConsumer* aGovtConsumer, const int aPeriod ) {
+    if( !startElement( aGovtConsumer->getXMLName(), "baseTechnology" ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( aGovtConsumer->getXMLName(), mBuffer, mTabs.get(), aGovtConsumer->getName(),
         aGovtConsumer->getYear(), "baseTechnology" );
 
@@ -1819,31 +2186,55 @@ void XMLDBOutputter::startVisitGovtConsumer( const GovtConsumer* aGovtConsumer,
 }
 
 void XMLDBOutputter::endVisitGovtConsumer( const GovtConsumer* aGovtConsumer, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( aGovtConsumer->getXMLName(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitTradeConsumer( const TradeConsumer* aTradeConsumer, const int aPeriod ) {
+    if( !startElement( aTradeConsumer->getXMLName(), "baseTechnology" ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( aTradeConsumer->getXMLName(), mBuffer, mTabs.get(), aTradeConsumer->getName(),
         aTradeConsumer->getYear(), "baseTechnology" );
 }
 
 void XMLDBOutputter::endVisitTradeConsumer( const TradeConsumer* aTradeConsumer, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( aTradeConsumer->getXMLName(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitInvestConsumer( const InvestConsumer* aInvestConsumer, const int aPeriod ) {
+    if( !startElement( aInvestConsumer->getXMLName(), "baseTechnology" ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( aInvestConsumer->getXMLName(), mBuffer, mTabs.get(), aInvestConsumer->getName(),
         aInvestConsumer->getYear(), "baseTechnology" );
     XMLWriteElement( aInvestConsumer->mCapitalGoodPrice, "capital-good-price", mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::endVisitInvestConsumer( const InvestConsumer* aInvestConsumer, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( aInvestConsumer->getXMLName(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitProductionTechnology( const ProductionTechnology* aProductionTechnology,
                                                     const int aPeriod )
 {
+    if( !startElement( aProductionTechnology->getXMLName(), "baseTechnology" ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( aProductionTechnology->getXMLName(), mBuffer, mTabs.get(), aProductionTechnology->getName(),
         aProductionTechnology->getYear(), "baseTechnology" );
 
@@ -1872,10 +2263,18 @@ void XMLDBOutputter::startVisitProductionTechnology( const ProductionTechnology*
 void XMLDBOutputter::endVisitProductionTechnology( const ProductionTechnology* aProductionTechnology,
                                                   const int aPeriod )
 {
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( aProductionTechnology->getXMLName(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitFactorSupply( const FactorSupply* aFactorSupply, const int aPeriod ) {
+    if( !startElement( FactorSupply::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // put year on this element or on the price?
     XMLWriteOpeningTag( FactorSupply::getXMLNameStatic(), mBuffer, mTabs.get(), aFactorSupply->getName() );
 
@@ -1893,10 +2292,18 @@ void XMLDBOutputter::startVisitFactorSupply( const FactorSupply* aFactorSupply,
 }
 
 void XMLDBOutputter::endVisitFactorSupply( const FactorSupply* aFactorSupply, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( FactorSupply::getXMLNameStatic(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitNationalAccount( const NationalAccount* aNationalAccount, const int aPeriod ) {
+    if( !startElement( NationalAccount::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // national accounts are visited by period so the year attribute can be converted from aPeriod
     const Modeltime* modeltime = scenario->getModeltime();
     XMLWriteOpeningTag( NationalAccount::getXMLNameStatic(), mBuffer, mTabs.get(), "", modeltime->getper_to_yr( aPeriod ) );
@@ -1917,10 +2324,18 @@ void XMLDBOutputter::startVisitNationalAccount( const NationalAccount* aNational
 }
 
 void XMLDBOutputter::endVisitNationalAccount( const NationalAccount* aNationalAccount, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( NationalAccount::getXMLNameStatic(), mBuffer, mTabs.get() ) ;
 }
 
 void XMLDBOutputter::startVisitGCAMConsumer( const GCAMConsumer* aGCAMConsumer, const int aPeriod ) {
+    if( !startElement( aGCAMConsumer->getXMLName() ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( aGCAMConsumer->getXMLName(), mBuffer, mTabs.get(), aGCAMConsumer->getName() );
 
     const Modeltime* modeltime = scenario->getModeltime();
@@ -1929,10 +2344,18 @@ void XMLDBOutputter::startVisitGCAMConsumer( const GCAMConsumer* aGCAMConsumer,
 }
 
 void XMLDBOutputter::endVisitGCAMConsumer( const GCAMConsumer* aGCAMConsumer, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     XMLWriteClosingTag( aGCAMConsumer->getXMLName(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitBuildingNodeInput( const BuildingNodeInput* aBuildingNodeInput, const int aPeriod ) {
+    if( !startElement( BuildingNodeInput::getXMLNameStatic() ) ) {
+        return;
+    }
+
     // write the BuildingNodeInput tag and it's children in temp buffers so that we can
     // check if anything was really written out and avoid writing blank node inputs
     stringstream* parentBuffer = new stringstream();
@@ -1965,6 +2388,10 @@ void XMLDBOutputter::startVisitBuildingNodeInput( const BuildingNodeInput* aBuil
 }
 
 void XMLDBOutputter::endVisitBuildingNodeInput( const BuildingNodeInput* aBuildingNodeInput, const int aPeriod ) {
+    if( !endElement() ) {
+        return;
+    }
+
     // Write the BuildingNodeInput (open tag, children, and closing tag) to the buffer at
     // the top of the stack only if the child buffer is not empty
     iostream* childBuffer = popBufferStack();
@@ -1987,6 +2414,9 @@ void XMLDBOutputter::endVisitBuildingNodeInput( const BuildingNodeInput* aBuildi
 
 void XMLDBOutputter::startVisitBuildingServiceInput( const BuildingServiceInput* aBuildingServiceInput, const int aPeriod ) {
     startVisitInput( aBuildingServiceInput, aPeriod );
+    if( isSkipping() ) {
+        return;
+    }
 
     writeItemToBuffer( aBuildingServiceInput->getSatiationDemandFunction()->mSatiationImpedance,
                        "satiation-impedance", *mBufferStack.top(), mTabs.get(), 1, "unitless" );
@@ -2022,6 +2452,10 @@ void XMLDBOutputter::writeItemToBuffer( const double aValue,
                                         const int aPeriod,
                                         const string& aUnit )
 {
+    if( mPruner.get() && !mPruner->isItemNeeded( aName ) ) {
+        return;
+    }
+
     map<string, string> attributeMap;
     attributeMap[ "unit" ] = aUnit;
     int year = 0;
@@ -2073,6 +2507,10 @@ void XMLDBOutputter::writeItemUsingYear( const string& aName,
                                          const double aValue,
                                          const int aYear )
 {
+    if( mPruner.get() && !mPruner->isItemNeeded( aName ) ) {
+        return;
+    }
+
     map<string, string> attributeMap;
     attributeMap[ "unit" ] = aUnit;
 
@@ -2092,6 +2530,39 @@ bool XMLDBOutputter::isTechnologyOperating( const int aPeriod ){
     return mCurrentTechnology->isOperating( aPeriod );
 }
 
+/*!
+ * \brief Start an element which is about to be written.
+ * \details When the output is being pruned to what the configured queries need
+ *          an element which no query can reach is skipped along with everything
+ *          within it.  The caller must return without writing anything if the
+ *          element is skipped, and each call must be matched by a call to
+ *          endElement.
+ * \param aName The element name.
+ * \param aType The type attribute which is written for the element if any.
+ * \return Whether the element should be written.
+ */
+bool XMLDBOutputter::startElement( const string& aName, const string& aType ) {
+    return !mPruner.get() || mPruner->startElement( aName, aType );
+}
+
+/*!
+ * \brief End the element which was most recently started.
+ * \return Whether the element was written and so needs to be closed.
+ */
+bool XMLDBOutputter::endElement() {
+    return !mPruner.get() || mPruner->endElement();
+}
+
+/*!
+ * \brief Whether the current element is being skipped.
+ * \details Visits which add to the element of their parent rather than writing
+ *          their own use this to skip writing.
+ * \return Whether nothing should be written.
+ */
+bool XMLDBOutputter::isSkipping() const {
+    return mPruner.get() && mPruner->isSkipping();
+}
+
 /**
  * \brief Pops the buffer off of the top of the stack and returns it.
  * \details A convience method so that the pop can be in one line instead of two.
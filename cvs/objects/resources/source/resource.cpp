@@ -436,7 +436,9 @@ void Resource::calcSupply( const string& aRegionName, const GDP* aGDP, const int
 
     for( unsigned int i = 0; i < mGHG.size(); ++i ) {
         // no inputs or capture components
-        mGHG[i]->calcEmission( aRegionName, inputs, mOutputs, aGDP, 0, aPeriod );
+        if( mGHG[i]->isSolutionEmission() ) {
+            mGHG[i]->calcEmission( aRegionName, inputs, mOutputs, aGDP, 0, aPeriod );
+        }
     }
 }
 
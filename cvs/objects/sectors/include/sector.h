@@ -58,6 +58,7 @@
 #include "util/base/include/time_vector.h"
 #include "util/base/include/value.h"
 #include "util/base/include/data_definition_util.h"
+#include "technologies/include/technology_calc_data.h"
 
 // Forward declarations
 class Subsector;
@@ -147,6 +148,12 @@ protected:
     typedef std::vector<object_meta_info_type> object_meta_info_vector_type;
     object_meta_info_vector_type mObjectMetaInfo; //!< Vector of object meta info to pass to mSectorInfo
 
+    //! The share calculation data of the new vintage technologies of all
+    //! subsectors gathered into one block in subsector order.
+    std::vector<TechnologyCalcData> mTechCalcData;
+
+    void initTechCalcData( const int aPeriod );
+
     virtual void toDebugXMLDerived( const int period, std::ostream& aOut, Tabs* aTabs ) const = 0;
     virtual bool XMLDerivedClassParse( const std::string& nodeName, const xercesc::DOMNode* curr ) = 0;
     virtual const std::string& getXMLName() const = 0;
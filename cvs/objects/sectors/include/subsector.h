@@ -74,6 +74,7 @@ class ILandAllocator;
 class Demographics;
 class InterpolationRule;
 class IDiscreteChoice;
+struct TechnologyCalcData;
 
 // Need to forward declare the subclasses as well.
 class TranSubsector;
@@ -158,6 +159,14 @@ protected:
 
     virtual void interpolateShareWeights( const int aPeriod );
     std::map<std::string,int> baseTechNameMap; //!< Map of base technology name to integer position in vector. 
+
+    //! The share calculation data of the new vintage of each technology
+    //! container, in order, held in the sector's contiguous block.  Null if
+    //! the sector did not gather it.
+    const TechnologyCalcData* mTechCalcData;
+
+    //! The period for which mTechCalcData was gathered.
+    int mTechCalcDataPeriod;
     typedef std::vector<BaseTechnology*>::const_iterator CBaseTechIterator;
     typedef std::vector<BaseTechnology*>::iterator BaseTechIterator;
 
@@ -185,6 +194,10 @@ public:
                            const MoreSectorInfo* aMoreSectorInfo,
                            const int aPeriod );
 
+    void appendTechCalcData( const int aPeriod, std::vector<TechnologyCalcData>& aCalcData ) const;
+
+    void setTechCalcData( const TechnologyCalcData* aCalcData, const int aPeriod );
+
     void toDebugXML( const int period, std::ostream& out, Tabs* tabs ) const;
     static const std::string& getXMLNameStatic();
     virtual double getPrice( const GDP* aGDP, const int aPeriod ) const;
@@ -320,6 +320,29 @@ void Sector::initCalc( NationalAccount* aNationalAccount,
     for ( unsigned int i = 0; i < mSubsectors.size(); ++i ){
         mSubsectors[ i ]->initCalc( aNationalAccount, aDemographics, 0, aPeriod );
     }
+
+    initTechCalcData( aPeriod );
+}
+
+/*!
+ * \brief Gather the share calculation data of the technologies of all
+ *        subsectors into a single block.
+ * \details The subsectors index into the block when calculating technology
+ *          shares and prices so that the calculation reads contiguous memory
+ *          rather than following each technology's members.  The block must
+ *          not be reallocated until the next call.
+ * \param aPeriod Model period.
+ */
+void Sector::initTechCalcData( const int aPeriod ) {
+    mTechCalcData.clear();
+    vector<size_t> offsets( mSubsectors.size() );
+    for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
+        offsets[ i ] = mTechCalcData.size();
+        mSubsectors[ i ]->appendTechCalcData( aPeriod, mTechCalcData );
+    }
+    for( unsigned int i = 0; i < mSubsectors.size(); ++i ){
+        mSubsectors[ i ]->setTechCalcData( mTechCalcData.empty() ? 0 : mTechCalcData.data() + offsets[ i ], aPeriod );
+    }
 }
 
 /*! \brief Test to see if calibration worked for this sector
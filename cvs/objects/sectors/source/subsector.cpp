@@ -77,6 +77,7 @@
 #include "util/base/include/interpolation_rule.h"
 #include "functions/include/idiscrete_choice.hpp"
 #include "functions/include/discrete_choice_factory.hpp"
+#include "technologies/include/technology_calc_data.h"
 
 using namespace std;
 using namespace xercesc;
@@ -91,7 +92,9 @@ extern Scenario* scenario;
 * \author Sonny Kim, Steve Smith, Josh Lurz
 */
 Subsector::Subsector( const string& aRegionName, const string& aSectorName ):
-    doCalibration( false )
+    doCalibration( false ),
+    mTechCalcData( 0 ),
+    mTechCalcDataPeriod( -1 )
 {
     mRegionName = aRegionName;
     mSectorName = aSectorName;
@@ -417,6 +420,11 @@ void Subsector::initCalc( NationalAccount* aNationalAccount,
                           const MoreSectorInfo* aMoreSectorInfo,
                           const int aPeriod )
 {
+    // The sector gathers the technology data again once all subsectors are
+    // initialized.
+    mTechCalcData = 0;
+    mTechCalcDataPeriod = -1;
+
     mDiscreteChoiceModel->initCalc( mRegionName, mName, false, aPeriod );
     
     // Initialize all technologies.
@@ -495,6 +503,33 @@ void Subsector::initCalc( NationalAccount* aNationalAccount,
     interpolateShareWeights( aPeriod );
 }
 
+/*!
+ * \brief Append the share calculation data of the new vintage of each
+ *        technology container to the given block.
+ * \details Called by the sector after initCalc so that the data of all of its
+ *          subsectors is gathered into one contiguous block.
+ * \param aPeriod Model period.
+ * \param aCalcData The block to append to.
+ * \sa setTechCalcData
+ */
+void Subsector::appendTechCalcData( const int aPeriod, vector<TechnologyCalcData>& aCalcData ) const {
+    for( CTechIterator techIter = mTechContainers.begin(); techIter != mTechContainers.end(); ++techIter ) {
+        aCalcData.push_back( TechnologyCalcData() );
+        (*techIter)->getNewVintageTechnology( aPeriod )->initCalcData( aPeriod, aCalcData.back() );
+    }
+}
+
+/*!
+ * \brief Set the share calculation data of the technologies for the period.
+ * \param aCalcData The first of this subsector's entries in the sector's block
+ *                  which must not be reallocated during the period.
+ * \param aPeriod Model period.
+ */
+void Subsector::setTechCalcData( const TechnologyCalcData* aCalcData, const int aPeriod ) {
+    mTechCalcData = aCalcData;
+    mTechCalcDataPeriod = aPeriod;
+}
+
 /*! \brief Returns the subsector price.
 * \details Calculates and returns share-weighted total price (subsectorprice)
 *          and cost of fuel (fuelprice). 
@@ -506,8 +541,10 @@ double Subsector::getPrice( const GDP* aGDP, const int aPeriod ) const {
     double subsectorPrice = 0.0; // initialize to 0 for summing
     double sharesum = 0.0;
     const vector<double>& techShares = calcTechShares( aGDP, aPeriod );
+    const bool hasCalcData = mTechCalcData && mTechCalcDataPeriod == aPeriod;
     for ( unsigned int i = 0; i < mTechContainers.size(); ++i ) {
-        double currCost = mTechContainers[i]->getNewVintageTechnology(aPeriod)->getCost( aPeriod );
+        double currCost = hasCalcData ? mTechCalcData[ i ].getCost( aPeriod ) :
+            mTechContainers[i]->getNewVintageTechnology(aPeriod)->getCost( aPeriod );
         // calculate weighted average price for Subsector.
         /*!
          * \note Negative prices may be produced and are valid.
@@ -589,10 +626,28 @@ double Subsector::getAverageFuelPrice( const GDP* aGDP, const int aPeriod ) cons
 const vector<double> Subsector::calcTechShares( const GDP* aGDP, const int aPeriod ) const {
     vector<double> logTechShares ( mTechContainers.size() ); 
 
+    const bool hasCalcData = mTechCalcData && mTechCalcDataPeriod == aPeriod;
+    // The log of the scaled GDP per capita is only needed if a technology has a
+    // fuel preference elasticity, so calculate it on first use.
+    double logScaledGDPPerCap = 0.0;
+    bool hasLogScaledGDPPerCap = false;
     for( unsigned int i = 0; i < mTechContainers.size(); ++i ){
         // determine shares based on Technology costs
-        double lts = mTechContainers[ i ]->getNewVintageTechnology( aPeriod )->
-            calcShare( mDiscreteChoiceModel, aGDP, aPeriod );
+        double lts;
+        if( hasCalcData ) {
+            const TechnologyCalcData& calcData = mTechCalcData[ i ];
+            if( calcData.mHasFuelPrefElasticity && !hasLogScaledGDPPerCap ) {
+                double scaledGdpPerCapita = aGDP->getBestScaledGDPperCap( aPeriod );
+                assert( scaledGdpPerCapita > 0.0 );
+                logScaledGDPPerCap = log( scaledGdpPerCapita );
+                hasLogScaledGDPPerCap = true;
+            }
+            lts = calcData.calcShare( mDiscreteChoiceModel, aGDP, logScaledGDPPerCap, aPeriod );
+        }
+        else {
+            lts = mTechContainers[ i ]->getNewVintageTechnology( aPeriod )->
+                calcShare( mDiscreteChoiceModel, aGDP, aPeriod );
+        }
 
         // Check that Technology shares are valid.
         assert( util::isValidNumber( lts ) || lts == -numeric_limits<double>::infinity() );
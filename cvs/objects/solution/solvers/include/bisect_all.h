@@ -82,6 +82,10 @@ protected:
     //! Max iterations for bracketing
     unsigned int mMaxBracketIterations;
     
+    //! The number of interior points to evaluate concurrently to narrow the
+    //! brackets each iteration, zero to only bisect
+    unsigned int mKSectionPoints;
+    
     //! A filter which will be used to determine which SolutionInfos this solver component
     //! will work on.
     std::auto_ptr<ISolutionInfoFilter> mSolutionInfoFilter;
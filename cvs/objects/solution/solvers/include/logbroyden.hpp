@@ -83,7 +83,7 @@ public:
   LogBroyden(Marketplace *mktplc, World *world, CalcCounter *ccounter, int itmax=250,
              double ftol=1.0e-4) :
       SolverComponent(mktplc,world,ccounter), mMaxIter( itmax ), mFTOL( ftol ),
-      mLogPricep( true ) {}
+      mLogPricep( true ), mStaleColumnTol( 0.0 ), mMaxStaleFraction( 0.5 ) {}
   virtual ~LogBroyden() {}
 
   // SolverComponent methods
@@ -100,7 +100,8 @@ public:
   static const std::string & getXMLNameStatic( void ) {return SOLVER_NAME;}
 
 protected:
-  //! Perform the Broyden's method iterations.
+  //! Perform the Broyden's method iterations.  On success B holds the
+  //! Jacobian approximant the last step was taken with.
   int bsolve(VecFVec<double,double> &F, UBLAS::vector<double> &x, UBLAS::vector<double> &fx,
              UBMATRIX &B, int &neval);
   //! Additional logging for visualizing solver progress.
@@ -125,6 +126,15 @@ protected:
 
   bool mLogPricep;              //<! flag indicating whether we should work in price or log-price
 
+  //! Relative change above which a column of the approximate Jacobian is
+  //! considered stale.  When positive, Jacobian resets only recompute the
+  //! stale columns.  Zero (the default) always recomputes every column.
+  double mStaleColumnTol;
+
+  //! If more than this fraction of the columns are stale the whole Jacobian
+  //! is recomputed instead.
+  double mMaxStaleFraction;
+
   // These next two have to be class variables because we sometimes
   // have multiple logbroyden solvers operating.
   static int mLastPer;                 //<! used to detect when the period has changed, so we can reset mPerIter.
@@ -49,6 +49,8 @@
 #include <memory>
 #include <vector>
 
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
 #include "util/base/include/iparsable.h"
 
 class CalcCounter; 
@@ -90,6 +92,8 @@ public:
 
    virtual const std::string& getXMLName() const = 0;
 
+   void setIterationBudget( const double aFraction );
+
 protected:
    Marketplace* marketplace; //<! The marketplace to solve. 
    World* world; //<! World to call calc on.
@@ -109,8 +113,19 @@ protected:
    };
 
    std::vector<IterationInfo> mPastIters;
+
+   //! Wall clock time at which the current method was started.
+   boost::posix_time::ptime mMethodStart;
+
+   //! The fraction of the configured maximum iterations this component may
+   //! currently use, set by the Solver.
+   double mIterationBudget;
+
    void addIteration( const std::string& aSolName, const double aRED );
+   void recordIteration( const SolutionInfoSet& aSolutionSet, const int aPeriod,
+                         const double aFNorm = -1, const double aStepLength = -1 ) const;
    bool isImproving( const unsigned int aNumIter ) const;
+   unsigned int getIterationLimit( const unsigned int aMaxIterations ) const;
    void startMethod();
 };
 
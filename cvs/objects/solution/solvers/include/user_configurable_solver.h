@@ -40,6 +40,8 @@
 
 #include <vector>
 #include <memory>
+#include <map>
+#include <string>
 #include "solution/solvers/include/solver.h"
 
 /*! 
@@ -53,6 +55,7 @@ class SolverComponent;
 class Marketplace;
 class World;
 class SolutionInfoParamParser;
+class SolutionInfoSet;
 
 /*!
  * \ingroup Objects
@@ -74,6 +77,12 @@ class SolutionInfoParamParser;
  *                      The tolerance used for checking calibrated values when calibrating.
  *              - \c max-model-calcs int UserConfigurableSolver::mMaxModelCalcs
  *                      The maximum total number of iterations to try to find a solution.
+ *              - \c adaptive-sequence bool UserConfigurableSolver::mIsAdaptive
+ *                      Whether to adapt the order and iteration budgets of the solver
+ *                      components in each period to the progress they make.  The
+ *                      learned policy is read from the "solver-policy" file if it
+ *                      is set to be written in the configuration and saved to it
+ *                      once when the solver is destroyed at the end of the run.
  *              - \c (any SolverComponent) vector<SolverComponent*> UserConfigurableSolver::mSolverComponents
  *                      Can be any solver component contained in SolverComponentFactory, each one
  *                      being added in order to the list of solver components to use.
@@ -108,6 +117,61 @@ private:
     
     //! Max total solution iterations
     int mMaxModelCalcs;
+
+    //! Whether to adapt the order and iteration budgets of the solver components
+    //! to the progress they have made.
+    bool mIsAdaptive;
+
+    //! Whether the saved adaptive policy has been read.
+    bool mIsPolicyRead;
+
+    //! The file the adaptive policy is read from and written to, empty if
+    //! the policy should not be saved.
+    std::string mPolicyFileName;
+
+    /*!
+     * \brief The effort and progress made by a solver component in a period.
+     */
+    struct ComponentStats {
+        ComponentStats();
+        double getEfficiency() const;
+
+        //! The number of times the component was run.
+        int mNumRuns;
+
+        //! The number of runs in which the component made progress.
+        int mNumProgress;
+
+        //! The total number of model calcs used.
+        double mCalcs;
+
+        //! The total reduction in the distance from a solution.
+        double mProgress;
+    };
+
+    //! The type of the learned policy: the ComponentStats for each solver
+    //! component by period.
+    typedef std::map<int, std::vector<ComponentStats> > PolicyMap;
+
+    //! The learned policy for adaptive solving.
+    PolicyMap mComponentStats;
+
+    void solveAdaptive( SolutionInfoSet& aSolutionSet, const int aPeriod );
+
+    std::vector<unsigned int> getAdaptiveOrder( const int aPeriod ) const;
+
+    const std::vector<ComponentStats>* getPriorStats( const int aPeriod ) const;
+
+    std::string getComponentSignature() const;
+
+    void readPolicy();
+
+    void writePolicy() const;
+
+    static void readPolicyFile( const std::string& aFileName,
+                                std::map<std::pair<int, std::string>, std::vector<ComponentStats> >& aPolicies );
+
+    static double calcSolutionDistance( const SolutionInfoSet& aSolutionSet );
 };
 
 #endif // _USER_CONFIGURABLE_SOLVER_H_
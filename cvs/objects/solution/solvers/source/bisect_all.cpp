@@ -46,6 +46,7 @@
 #include "solution/solvers/include/solver_component.h"
 #include "solution/solvers/include/bisect_all.h"
 #include "solution/util/include/calc_counter.h"
+#include "solution/util/include/solver_telemetry.h"
 #include "marketplace/include/marketplace.h"
 #include "containers/include/world.h"
 #include "solution/util/include/solution_info.h"
@@ -67,7 +68,8 @@ using namespace xercesc;
 BisectAll::BisectAll( Marketplace* marketplaceIn, World* worldIn, CalcCounter* calcCounterIn ):SolverComponent( marketplaceIn, worldIn, calcCounterIn ),
 mMaxIterations( 30 ),
 mDefaultBracketInterval( 0.4 ),
-mMaxBracketIterations( 40 )
+mMaxBracketIterations( 40 ),
+mKSectionPoints( 0 )
 {
 }
 
@@ -114,6 +116,9 @@ bool BisectAll::XMLParse( const DOMNode* aNode ) {
         else if( nodeName == "max-bracket-iterations" ) {
             mMaxBracketIterations = XMLHelper<unsigned int>::getValue( curr );
         }
+        else if( nodeName == "k-section-points" ) {
+            mKSectionPoints = XMLHelper<unsigned int>::getValue( curr );
+        }
         else if( nodeName == "solution-info-filter" ) {
             mSolutionInfoFilter.reset(
                 SolutionInfoFilterFactory::createSolutionInfoFilterFromString( XMLHelper<string>::getValue( curr ) ) );
@@ -230,7 +235,9 @@ SolverComponent::ReturnCode BisectAll::solve( SolutionInfoSet& aSolutionSet, con
         aSolutionSet.updateSolvable( mSolutionInfoFilter.get() );
 
         // Print solution set information to solver log.
-        solverLog << aSolutionSet << endl;
+        if( SolverTelemetry::getInstance().isTextLogEnabled() ) {
+            solverLog << aSolutionSet << endl;
+        }
 
         // Move brackets, both price and ED, after solving mid-point.  This ensures that
         // both price and ED for each bracket is valid and up to date.
@@ -249,13 +256,28 @@ SolverComponent::ReturnCode BisectAll::solve( SolutionInfoSet& aSolutionSet, con
             }   
         }
 
+        // Narrow the brackets further by evaluating several interior points at
+        // once.  The base state still holds the evaluation at the center which
+        // the trials are calculated relative to.
+        if( mKSectionPoints > 0 && !aSolutionSet.isAllSolved() ) {
+            vector<SolutionInfo*> toNarrow;
+            for ( unsigned int i = 0; i < aSolutionSet.getNumSolvable(); ++i ) {
+                SolutionInfo& currSol = aSolutionSet.getSolvable( i );
+                if ( !currSol.isWithinTolerance() && currSol.isBracketed() ) {
+                    toNarrow.push_back( &currSol );
+                }
+            }
+            SolverLibrary::kSectionBrackets( world, toNarrow, 0, mKSectionPoints, aPeriod );
+        }
+
         if( aSolutionSet.getNumSolvable() > 0 ) {
             const SolutionInfo* maxSol = aSolutionSet.getWorstSolutionInfo();
             addIteration( maxSol->getName(), maxSol->getRelativeED() );
+            recordIteration( aSolutionSet, aPeriod );
             worstMarketLog << "BisectAll-maxRelED: " << *maxSol << endl;
         }
     } // end do loop        
-    while ( ++numIterations <= mMaxIterations 
+    while ( ++numIterations <= getIterationLimit( mMaxIterations ) 
             && !aSolutionSet.isAllSolved() && !areAllBracketsEqual( aSolutionSet ) );
 
     // Set the return code. 
@@ -265,7 +287,7 @@ SolverComponent::ReturnCode BisectAll::solve( SolutionInfoSet& aSolutionSet, con
     
     // Report exit conditions.
     solverLog.setLevel( ILogger::NOTICE );
-    if ( numIterations > mMaxIterations ){
+    if ( numIterations > getIterationLimit( mMaxIterations ) ){
         solverLog << "Exiting BisectionAll due to reaching the maximum number of iterations." << endl;
     }
 	else if( code != SUCCESS ) {
@@ -64,7 +64,8 @@ using namespace xercesc;
 BisectOne::BisectOne( Marketplace* marketplaceIn, World* worldIn, CalcCounter* calcCounterIn ):SolverComponent( marketplaceIn, worldIn, calcCounterIn ),
 mMaxIterations( 30 ),
 mDefaultBracketInterval( 0.4 ),
-mMaxBracketIterations( 40 )
+mMaxBracketIterations( 40 ),
+mKSectionPoints( 0 )
 {
 }
 
@@ -111,6 +112,9 @@ bool BisectOne::XMLParse( const DOMNode* aNode ) {
         else if( nodeName == "max-bracket-iterations" ) {
             mMaxBracketIterations = XMLHelper<unsigned int>::getValue( curr );
         }
+        else if( nodeName == "k-section-points" ) {
+            mKSectionPoints = XMLHelper<unsigned int>::getValue( curr );
+        }
         else if( nodeName == "solution-info-filter" ) {
             mSolutionInfoFilter.reset(
                 SolutionInfoFilterFactory::createSolutionInfoFilterFromString( XMLHelper<string>::getValue( curr ) ) );
@@ -172,6 +176,13 @@ SolverComponent::ReturnCode BisectOne::solve( SolutionInfoSet& aSolutionSet, con
         else {
             worstSol->moveLeftBracketToX();
         }
+        // Narrow the bracket further by evaluating several interior points at
+        // once, only the activities affected by this market need to be
+        // recalculated for each.
+        if( mKSectionPoints > 0 && worstSol->isCurrentlyBracketed() ) {
+            SolverLibrary::kSectionBrackets( world, vector<SolutionInfo*>( 1, worstSol ),
+                                             &worstSol->getDependencies(), mKSectionPoints, aPeriod );
+        }
         // Set new trial value to center
         worstSol->setPriceToCenter();
 
@@ -181,14 +192,15 @@ SolverComponent::ReturnCode BisectOne::solve( SolutionInfoSet& aSolutionSet, con
         // TODO: what is the point in updating
         aSolutionSet.updateSolvable( mSolutionInfoFilter.get() );
         addIteration( worstSol->getName(), worstSol->getRelativeED() );
+        recordIteration( aSolutionSet, aPeriod );
         worstMarketLog << "BisectOne-MaxRelED: "  << *worstSol << endl;
         solverLog << "BisectOneWorst-MaxRelED: " << *worstSol << endl;
     } // end do loop        
-    while ( ( ++numIterations < mMaxIterations ) &&
+    while ( ( ++numIterations < getIterationLimit( mMaxIterations ) ) &&
               !worstSol->isSolved() );
     // Report results.
     solverLog.setLevel( ILogger::NOTICE );
-    if( numIterations >= mMaxIterations ){
+    if( numIterations >= getIterationLimit( mMaxIterations ) ){
         solverLog << "Exiting BisectOne due to reaching max iterations." << endl;
     }
     else {
@@ -191,16 +191,17 @@ SolverComponent::ReturnCode BisectPolicy::solve( SolutionInfoSet& aSolutionSet,
                 world->calc( aPeriod );
                 aSolutionSet.updateSolvable( mSolutionInfoFilter.get() );
                 addIteration( worstSol->getName(), worstSol->getRelativeED() );
+                recordIteration( aSolutionSet, aPeriod );
                 worstMarketLog << "BisectPolicy-MaxRelED: "  << *worstSol << endl;
             } // end do loop        
             while ( isImproving( MAX_ITER_NO_IMPROVEMENT ) &&
-                ( ++numIterations < mMaxIterations ) &&
+                ( ++numIterations < getIterationLimit( mMaxIterations ) ) &&
                 !worstSol->isWithinTolerance() );
         }
     }
     // Report results.
     solverLog.setLevel( ILogger::NOTICE );
-    if( numIterations >= mMaxIterations ){
+    if( numIterations >= getIterationLimit( mMaxIterations ) ){
         solverLog << "Exiting BisectPolicy due to reaching max iterations." << endl;
     }
     else if( !isImproving( MAX_ITER_NO_IMPROVEMENT ) ){
@@ -46,6 +46,7 @@
 #include "solution/solvers/include/solver_component.h"
 #include "solution/solvers/include/log_newton_raphson.h"
 #include "solution/util/include/calc_counter.h"
+#include "solution/util/include/solver_telemetry.h"
 #include "marketplace/include/marketplace.h"
 #include "containers/include/world.h"
 #include "solution/util/include/solution_info_set.h"
@@ -207,12 +208,15 @@ SolverComponent::ReturnCode LogNewtonRaphson::solve( SolutionInfoSet& aSolutionS
             // Add to the iteration list.
             SolutionInfo* currWorstSol = aSolutionSet.getWorstSolutionInfo();
             addIteration( currWorstSol->getName(), currWorstSol->getRelativeED() );
+            recordIteration( aSolutionSet, aPeriod );
 
             worstMarketLog.setLevel( ILogger::NOTICE );
             worstMarketLog << "NR-maxRelED: " << *currWorstSol << endl;
             solverLog.setLevel( ILogger::DEBUG );
             solverLog << "Solution after " << number_of_NR_iteration << " iterations in NewtonRhapson: " << endl;
-            solverLog << aSolutionSet << endl;
+            if( SolverTelemetry::getInstance().isTextLogEnabled() ) {
+                solverLog << aSolutionSet << endl;
+            }
 
             if( aSolutionSet.updateSolvable( mSolutionInfoFilter.get() ) != SolutionInfoSet::UNCHANGED ){
                 size_t newSize = aSolutionSet.getNumSolvable();
@@ -227,7 +231,7 @@ SolverComponent::ReturnCode LogNewtonRaphson::solve( SolutionInfoSet& aSolutionS
         }
         ++number_of_NR_iteration;
     } // end do loop    
-    while ( success && number_of_NR_iteration <= mMaxIterations &&
+    while ( success && number_of_NR_iteration <= getIterationLimit( mMaxIterations ) &&
             !aSolutionSet.isAllSolved() );
     
     // reset the derivatives regardless of if we were successful
@@ -245,8 +249,8 @@ SolverComponent::ReturnCode LogNewtonRaphson::solve( SolutionInfoSet& aSolutionS
     else if( code == SUCCESS && aSolutionSet.isAllSolved() ){
         solverLog << "Newton-Raphson solved all markets successfully." << endl;
     }
-    else if( number_of_NR_iteration > mMaxIterations ){
-        solverLog << "Exiting Newton-Rhapson without solving all markets. Maximum iteration count exceeded: " << mMaxIterations << endl;
+    else if( number_of_NR_iteration > getIterationLimit( mMaxIterations ) ){
+        solverLog << "Exiting Newton-Rhapson without solving all markets. Maximum iteration count exceeded: " << getIterationLimit( mMaxIterations ) << endl;
     }
     else {
         solverLog << "Exiting Newton-Rhapson due to lack of improvement. " << endl;
@@ -42,6 +42,8 @@
 #include <string>
 #include <algorithm>
 #include <iomanip>
+#include <map>
+#include <memory>
 #include <math.h>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
@@ -60,10 +62,12 @@
 #include "util/base/include/xml_helper.h"
 #include "solution/util/include/solution_info_filter_factory.h"
 #include "solution/util/include/solvable_nr_solution_info_filter.h"
+#include "solution/util/include/solver_telemetry.h"
 
 #include "solution/util/include/functor-subs.hpp"
 #include "solution/util/include/linesearch.hpp"
 #include "solution/util/include/fdjac.hpp" 
+#include "solution/util/include/sensitivity_price_forecaster.h"
 #include "solution/util/include/edfun.hpp"
 #include "solution/util/include/ublas-helpers.hpp"
 #include "util/base/include/fltcmp.hpp"
@@ -123,6 +127,94 @@ namespace {
       }
     }
   } 
+
+  /*!
+   * \brief Tracks which columns of the approximate Jacobian have gone stale
+   *        since they were last computed by finite differences.
+   * \details A column is stale if the Broyden updates since its last refresh
+   *          have changed it by more than the tolerance relative to its norm,
+   *          or if the price of any market whose dependencies overlap with the
+   *          column's market has moved by more than the tolerance.  The
+   *          overlap is found from the dependency sets which the
+   *          MarketDependencyFinder assigned to each SolutionInfo.
+   */
+  class StaleColumnTracker {
+  public:
+    StaleColumnTracker( const SolutionInfoSet& aSolnSet, const UBVECTOR& aX ):
+      mUpdateChange( aX.size(), 0.0 ),
+      mRefreshX( aX ),
+      mDeps( aX.size() )
+    {
+      for( size_t j = 0; j < aX.size(); ++j ) {
+        mDeps[ j ] = &aSolnSet.getSolvable( j ).getDependencies();
+        for( auto activity : *mDeps[ j ] ) {
+          mColumnsByActivity[ activity ].push_back( j );
+        }
+      }
+    }
+
+    //! Accumulate the change a Broyden update with the scaled secant residual
+    //! aResidual and step aStep made to each column of aB.
+    void recordUpdate( const UBVECTOR& aResidual, const UBVECTOR& aStep, const UBMATRIX& aB ) {
+      const double residualNorm = sqrt( boost::numeric::ublas::inner_prod( aResidual, aResidual ) );
+      for( size_t j = 0; j < aStep.size(); ++j ) {
+        const double colNorm = boost::numeric::ublas::norm_2( boost::numeric::ublas::column( aB, j ) );
+        mUpdateChange[ j ] += residualNorm * fabs( aStep[ j ] ) / ( colNorm + util::getSmallNumber() );
+      }
+    }
+
+    //! Mark the given columns as freshly computed at aX.
+    void markRefreshed( const std::vector<int>& aCols, const UBVECTOR& aX ) {
+      for( auto j : aCols ) {
+        mUpdateChange[ j ] = 0.0;
+        mRefreshX[ j ] = aX[ j ];
+      }
+    }
+
+    //! Mark every column as freshly computed at aX.
+    void markAllRefreshed( const UBVECTOR& aX ) {
+      std::fill( mUpdateChange.begin(), mUpdateChange.end(), 0.0 );
+      mRefreshX = aX;
+    }
+
+    //! Find the columns which are stale at aX given the tolerance aTol.
+    void findStale( const UBVECTOR& aX, const double aTol, std::vector<int>& aStaleCols ) const {
+      std::vector<bool> isStale( aX.size(), false );
+      for( size_t j = 0; j < aX.size(); ++j ) {
+        if( mUpdateChange[ j ] > aTol ) {
+          isStale[ j ] = true;
+        }
+        if( fabs( aX[ j ] - mRefreshX[ j ] ) > aTol ) {
+          // Every column which shares a dependency with a market that moved
+          // may have been evaluated at a different operating point.
+          for( auto activity : *mDeps[ j ] ) {
+            for( auto k : mColumnsByActivity.find( activity )->second ) {
+              isStale[ k ] = true;
+            }
+          }
+        }
+      }
+      aStaleCols.clear();
+      for( size_t j = 0; j < isStale.size(); ++j ) {
+        if( isStale[ j ] ) {
+          aStaleCols.push_back( j );
+        }
+      }
+    }
+
+  private:
+    //! Accumulated relative change to each column from Broyden updates.
+    std::vector<double> mUpdateChange;
+
+    //! The value of x at which each column was last computed.
+    UBVECTOR mRefreshX;
+
+    //! The activities affected by each column's market.
+    std::vector<const std::vector<IActivity*>*> mDeps;
+
+    //! The columns whose markets affect each activity.
+    std::map<const IActivity*, std::vector<int> > mColumnsByActivity;
+  };
 }
 
 int LogBroyden::mLastPer = 0;
@@ -159,6 +251,12 @@ bool LogBroyden::XMLParse( const DOMNode* aNode ) {
         else if(nodeName == "log-price") {
           mLogPricep = true;    // not strictly necessary, as this is the default.
         }
+        else if( nodeName == "stale-column-tol" ) {
+            mStaleColumnTol = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "max-stale-fraction" ) {
+            mMaxStaleFraction = XMLHelper<double>::getValue( curr );
+        }
         else if( SolutionInfoFilterFactory::hasSolutionInfoFilter( nodeName ) ) {
             mSolutionInfoFilter.reset( SolutionInfoFilterFactory::createAndParseSolutionInfoFilter( nodeName, curr ) );
         }
@@ -320,6 +418,11 @@ SolverComponent::ReturnCode LogBroyden::solve(SolutionInfoSet &solnset, int peri
     if(bstatus == 0) {
         solverLog << "Broyden solution success.\n";
         code = SUCCESS;
+        SensitivityPriceForecaster& forecaster = SensitivityPriceForecaster::getInstance();
+        if( forecaster.isEnabled() ) {
+            forecaster.storeJacobian( period, smkts, F, mLogPricep, x,
+                                      boost::numeric::ublas::matrix<double>( J ) );
+        }
     }
     else if(bstatus == -1) {
         code = FAILURE_ITER_MAX_REACHED;
@@ -353,6 +456,7 @@ SolverComponent::ReturnCode LogBroyden::solve(SolutionInfoSet &solnset, int peri
     // log some final debugging info
     const SolutionInfo* maxred = solnset.getWorstSolutionInfo();
     addIteration(maxred->getName(), maxred->getRelativeED());
+    recordIteration(solnset, period, sqrt(inner_prod(fx,fx)));
     if( mLogPricep ) {
       worstMarketLog << "###Broyden-end-logPrice:  " << *maxred << std::endl;
     }
@@ -395,11 +499,21 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
 
   // market ids and solvable flag for just the solvable markets
   std::vector<int> mktids_solv;
-  cSolInfo->getMarketIDs(mktids_solv,true);
-  std::vector<bool> issolvable_solv(mktids_solv.size(), true);
   // market ids and solvable flag for all markets (solvable and unsolvable)
   std::vector<int> mktids_all;
-  cSolInfo->getMarketIDs(mktids_all, false);
+  if(cSolInfo) {
+    cSolInfo->getMarketIDs(mktids_solv,true);
+    cSolInfo->getMarketIDs(mktids_all, false);
+  }
+  else {
+    // No solution info when F is not the model (e.g. a replay), so just
+    // number the markets in order.
+    for(int i=0; i<F.narg(); ++i) {
+      mktids_solv.push_back(i);
+    }
+    mktids_all = mktids_solv;
+  }
+  std::vector<bool> issolvable_solv(mktids_solv.size(), true);
   std::vector<bool> issolvable_all(mktids_all.size());
   for(unsigned i=0; i<issolvable_solv.size(); ++i) { // solvable markets are at the beginning; set their flag to true
       issolvable_all[i] = true;
@@ -449,13 +563,53 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
     return 0;
   }
 
+  // When enabled, track which columns of B have gone stale so that Jacobian
+  // resets only need to recompute those columns.
+  std::unique_ptr<StaleColumnTracker> staleTracker;
+  if( mStaleColumnTol > 0.0 && cSolInfo ) {
+    staleTracker.reset( new StaleColumnTracker( *cSolInfo, x ) );
+  }
+  std::vector<int> staleCols;
+
+  // Recompute B at (ax, afx).  Only the stale columns are recomputed if
+  // allowed and few enough are stale.  Returns true if that was the case.
+  auto refreshJacobian = [&]( const UBVECTOR& ax, const UBVECTOR& afx, const bool aAllowPartial ) -> bool {
+    if( staleTracker.get() && aAllowPartial ) {
+      staleTracker->findStale( ax, mStaleColumnTol, staleCols );
+      if( !staleCols.empty() && staleCols.size() <= mMaxStaleFraction * ax.size() ) {
+        // B may hold its factorization so start from the saved approximant.
+        B = Btmp;
+        solverLog << "Refreshing " << staleCols.size() << " of " << ax.size()
+                  << " stale Jacobian columns.\n";
+        fdjac(F,ax,afx,staleCols,B);
+        neval += staleCols.size();
+        staleTracker->markRefreshed( staleCols, ax );
+        return true;
+      }
+    }
+    fdjac(F,ax,afx,B);
+    neval += ax.size();
+    if( staleTracker.get() ) {
+      staleTracker->markAllRefreshed( ax );
+    }
+    return false;
+  };
+
   bool lsfail = false;        // flag indicating whether we have had a line-search failure
-  for(int iter=0; iter<mMaxIter; ++iter) {
+  bool lspartial = false;     // flag indicating whether the last line-search failure only refreshed part of B
+  bool resetpartial = false;  // flag indicating whether the last poor progress reset only refreshed part of B
+  // The per-iteration vector dumps may be skipped when solver telemetry is
+  // all that is needed.
+  const bool textLog = SolverTelemetry::getInstance().isTextLogEnabled();
+
+  for(int iter=0; iter<static_cast<int>( getIterationLimit( mMaxIter ) ); ++iter) {
     // log some debug info
     
     solverLog << "Broyden iter= " << iter << "\tneval= " << neval << "\n";
     solverLog << "Internal iteration count ( mPerIter )= " << mPerIter << "\n";
-    cSolInfo->printMarketInfo("Broyden ", calcCounter->getPeriodCount(), singleLog);
+    if( textLog && cSolInfo ) {
+      cSolInfo->printMarketInfo("Broyden ", calcCounter->getPeriodCount(), singleLog);
+    }
     for(int j=0;j<F.narg();++j) {
       // double bjj= B(j,j);
       // jdiag[j] = bjj;
@@ -464,7 +618,9 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
     double jdmax=0.0, jdmin=0.0;
     int jdjmax=0, jdjmin=0;
     locate_vector_minmax(jdiag, jdmax, jdmin, jdjmax, jdjmin);
-    solverLog << "diag( B ):\n" << jdiag << "\n";
+    if( textLog ) {
+      solverLog << "diag( B ):\n" << jdiag << "\n";
+    }
     solverLog << "maxval= " << jdmax << " jmax= " << jdjmax << "  "
               << "minval= " << jdmin << "  jmin= " << jdjmin << "\n";
     
@@ -501,8 +657,10 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
     int nsing = svdInvertSolve(Usv,Ssv,VTsv,dx, solverLog);
 
     solverLog << "\nIteration " << iter << "\nf0= " << f0
-              << "\tnsing= " << nsing
-              << "\nx: " << x << "\nF( x ): " << fx << "\ndx: " << dx << "\n";
+              << "\tnsing= " << nsing << "\n";
+    if( textLog ) {
+      solverLog << "x: " << x << "\nF( x ): " << fx << "\ndx: " << dx << "\n";
+    }
 
 #else /* No USE_LAPACK.  Solve using L-U decomposition */
     int itrial = 0;
@@ -553,12 +711,16 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
       // muddle through to a solution.  If not, then it will
       // eventually stop with a genuinely singular matrix.
     }
-    solverLog << "dx: " << dx << "\n"; 
+    if( textLog ) {
+      solverLog << "dx: " << dx << "\n";
+    }
 #endif /* USE_LAPACK */
 
     // log the proposal step
     solverLog << "Proposal step magnitude dxmag= " << sqrt(inner_prod(dx,dx)) << "\n\n";
-    reportVec("dxprop", dx, mktids_solv, issolvable_solv);    
+    if( textLog ) {
+      reportVec("dxprop", dx, mktids_solv, issolvable_solv);
+    }
 
     
     // dx now holds the newton step.  Execute the line search along
@@ -572,12 +734,12 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
 
       // 1) B is not a descent direction.  If this is the first
       // failure starting from this x value, try a finite difference
-      // jacobian
-      if(!lsfail) {
+      // jacobian.  If that only refreshed the stale columns and still
+      // failed, try again with every column.
+      if(!lsfail || lspartial) {
         solverLog << "**Failed line search. Evaluating fdjac\n";
+        lspartial = refreshJacobian(x, fx, !lsfail);
         lsfail = true;
-        fdjac(F,x,fx,B);
-        neval += x.size();
         ageB = 0;  // reset the age on B
 
         // Log the diagonal of the new jacobian after the failed line search
@@ -598,6 +760,7 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
       if(msf < mFTOL) {
         // basically, we're letting ourselves converge to the sqrt of
         // our intended tolerance.
+        B = Btmp;
         return 0;
       }
 
@@ -615,6 +778,7 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
     else {
       // reset the line search fail flag
       lsfail = false;
+      lspartial = false;
     }
 
     UBVECTOR xstep(xnew-x);    // step in x eventually taken
@@ -624,17 +788,22 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
 
     UBVECTOR fxnew(fx.size());
     fnorm.lastF( fxnew );            // get the last value of big-F
-    solverLog << "\nxnew: " << xnew << "\nfxnew: " << fxnew << "\n";
+    if( textLog ) {
+      solverLog << "\nxnew: " << xnew << "\nfxnew: " << fxnew << "\n";
+    }
     UBVECTOR fxstep(fxnew -fx); // change in F( x ).  We will need this for the secant update
 
     // log the worst market info
-    const SolutionInfo* maxred = cSolInfo->getWorstSolutionInfo();
-    addIteration(maxred->getName(), maxred->getRelativeED());
-    if( mLogPricep ) {
-      worstMarketLog << "Broyden-logPrice:  " << *maxred << "\n";
-    }
-    else {
-      worstMarketLog << "Broyden-linearPrice:  " << *maxred << "\n";
+    if( cSolInfo ) {
+      const SolutionInfo* maxred = cSolInfo->getWorstSolutionInfo();
+      addIteration(maxred->getName(), maxred->getRelativeED());
+      recordIteration(*cSolInfo, mLastPer, sqrt(fnew), sqrt(inner_prod(xstep,xstep)));
+      if( mLogPricep ) {
+        worstMarketLog << "Broyden-logPrice:  " << *maxred << "\n";
+      }
+      else {
+        worstMarketLog << "Broyden-linearPrice:  " << *maxred << "\n";
+      }
     }
 
     // test for convergence
@@ -655,6 +824,7 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
       solverLog << "Solution successful.\n";
       x = xnew;
       fx = fxnew;
+      B = Btmp;                 // return the approximant, not its factorization
       return 0;                 // SUCCESS 
     }
 
@@ -691,6 +861,10 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
       fxstep /= dx2;
       B += outer_prod(fxstep, xstep);
       ageB++;                // increment the age of B
+      resetpartial = false;
+      if( staleTracker.get() ) {
+        staleTracker->recordUpdate(fxstep, xstep, B);
+      }
     }
     else {
       // Progress using the Broyden formula is anemic.  This usually
@@ -698,9 +872,12 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
       // old, try a finite-difference jacobian to get us back on track.
       if(ageB > 0) {
         solverLog << "Insufficient progress with Broyden formula.  Resetting the Jacobian.\n(f0= " << f0 << ", fnew= " << fnew << ")\n";
-        fdjac(F,xnew,fxnew,B);
-        neval += x.size();
-        ageB = 0;
+        // A partial refresh leaves the age alone and if it does not help
+        // the next reset recomputes the whole Jacobian.
+        resetpartial = refreshJacobian(xnew, fxnew, !resetpartial);
+        if( !resetpartial ) {
+          ageB = 0;
+        }
 
         // Log the results of the Jacobian reset
         for(int j=0; j<F.narg(); ++j) {
@@ -720,12 +897,14 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
     }
 
     // log the data trace before we do the update
-    reportVec("x", xnew, mktids_solv, issolvable_solv);
-    reportVec("fx", fxnew, mktids_solv, issolvable_solv);
-    reportVec("deltax", xnew-x, mktids_solv, issolvable_solv);    // xstep may have been modified above
-    reportVec("deltafx", fxnew-fx, mktids_solv, issolvable_solv); // fxstep definitely modified above
-    reportVec("diagB", jdiag, mktids_solv, issolvable_solv);
-    reportPSD(rptvec_all, mktids_all, issolvable_all);                // report price, supply, and demand.  
+    if( textLog ) {
+      reportVec("x", xnew, mktids_solv, issolvable_solv);
+      reportVec("fx", fxnew, mktids_solv, issolvable_solv);
+      reportVec("deltax", xnew-x, mktids_solv, issolvable_solv);    // xstep may have been modified above
+      reportVec("deltafx", fxnew-fx, mktids_solv, issolvable_solv); // fxstep definitely modified above
+      reportVec("diagB", jdiag, mktids_solv, issolvable_solv);
+      reportPSD(rptvec_all, mktids_all, issolvable_all);                // report price, supply, and demand.  
+    }
     mPerIter++;
 
     // update x, fx, f0 for next iteration
@@ -96,6 +96,11 @@ namespace {
   // helper functions for the std::transform algorithm
   double SI2lgprice (const SolutionInfo &si) {return log(si.getPrice());}
   double SI2price (const SolutionInfo &si) {return si.getPrice();}
+
+  // read-only accessor for solutionInfoSet and the period being solved (used
+  // to record iterations)
+  const SolutionInfoSet *cSolInfo=0;
+  int cPeriod=0;
 }
 
 bool LogNRbt::XMLParse( const DOMNode* aNode ) {
@@ -238,8 +243,10 @@ SolverComponent::ReturnCode LogNRbt::solve( SolutionInfoSet& solnset, int period
     }
     
     // call the solver
+    cSolInfo = &solnset;        // make available for recording iterations
+    cPeriod = period;
     int nrstatus = nrsolve(F, x, fx, J, neval);
-
+    cSolInfo = 0;
 
     solverTimer.stop();
 
@@ -325,7 +332,7 @@ int LogNRbt::nrsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx, UBMAT
     // is a more stringent test than our regular convergence test
     return 0;
   
-  for(int iter=0; iter<mMaxIter; ++iter) {
+  for(int iter=0; iter<static_cast<int>( getIterationLimit( mMaxIter ) ); ++iter) {
     solverLog << "NR iter= " << iter << "\tneval= " << neval << "\n";
     axpy_prod(fx,J,gx);         // compute the gradient of F*F (= fx^T * J == J^T * fx)
     // axpy_prod clears gx on entry, so we don't have to do it.
@@ -469,6 +476,13 @@ int LogNRbt::nrsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx, UBMAT
     x  = xnew;
     fnorm.lastF(fx);            // get the last value of big-F
     solverLog << "\nxnew: " << xnew << "\nfxnew: " << fx << "\n";
+
+    // record the iteration
+    if(cSolInfo) {
+      const SolutionInfo* maxred = cSolInfo->getWorstSolutionInfo();
+      addIteration(maxred->getName(), maxred->getRelativeED());
+      recordIteration(*cSolInfo, cPeriod, sqrt(f0), sqrt(inner_prod(xstep,xstep)));
+    }
     
   
     // test for convergence
@@ -167,8 +167,12 @@ SolverComponent::ReturnCode Preconditioner::solve( SolutionInfoSet& aSolutionSet
     ILogger& worstMarketLog = ILogger::getLogger( "worst_market_log" );
     worstMarketLog.setLevel( ILogger::NOTICE );
 
+    // Start the method first so that the starting iteration is not cleared.
+    startMethod();
+
     const SolutionInfo* maxred = aSolutionSet.getWorstSolutionInfo();
     addIteration(maxred->getName(), maxred->getRelativeED());
+    recordIteration(aSolutionSet, aPeriod);
     worstMarketLog << "###Preconditioner-strt: " << *maxred << std::endl;
 
     
@@ -187,9 +191,6 @@ SolverComponent::ReturnCode Preconditioner::solve( SolutionInfoSet& aSolutionSet
     // need to do bracketing first, does this need to be before or after startMethod?
     solverLog << "Solution set before Preconditioning: " << endl << aSolutionSet << endl;
     
-    
-    startMethod();
-    
     worstMarketLog << "Market Name, X, XL, XR, ED, EDL, EDR, RED, bracketed, supply, demand" << endl;
     solverLog << "Preconditioning routine starting" << endl; 
 
@@ -413,12 +414,14 @@ SolverComponent::ReturnCode Preconditioner::solve( SolutionInfoSet& aSolutionSet
         world->calc(aPeriod);
 #endif
     addIteration(maxred->getName(), maxred->getRelativeED());
+    recordIteration(aSolutionSet, aPeriod);
     worstMarketLog << "###Preconditioner-" << pass << ": " << *maxred << std::endl; 
     } // end of loop over two passes
     bisectTimer.stop();
 
     maxred = aSolutionSet.getWorstSolutionInfo();
     addIteration(maxred->getName(), maxred->getRelativeED());
+    recordIteration(aSolutionSet, aPeriod);
     worstMarketLog << "###Preconditioner-end: " << *maxred << std::endl;
     
     // Report exit conditions.  Technically it's possible that the
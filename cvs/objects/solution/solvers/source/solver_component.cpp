@@ -42,9 +42,16 @@
 #include <memory>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include "solution/solvers/include/solver_component.h"
 #include "solution/util/include/calc_counter.h"
+#include "solution/util/include/solution_info_set.h"
+#include "solution/util/include/solution_info.h"
+#include "solution/util/include/solver_telemetry.h"
 
 using namespace std;
 
@@ -55,7 +62,7 @@ using namespace std;
 * \param worldIn The world which will be used for solving.
 * \param calcCounterIn A pointer to the object which tracks calls to world.calc()
 */
-SolverComponent::SolverComponent( Marketplace* marketplaceIn, World* worldIn, CalcCounter* calcCounterIn ): marketplace( marketplaceIn ), world( worldIn ), calcCounter( calcCounterIn ){
+SolverComponent::SolverComponent( Marketplace* marketplaceIn, World* worldIn, CalcCounter* calcCounterIn ): marketplace( marketplaceIn ), world( worldIn ), calcCounter( calcCounterIn ), mIterationBudget( 1.0 ){
 }
 
 //! Default Destructor.
@@ -66,11 +73,87 @@ SolverComponent::~SolverComponent(){
 SolverComponent::IterationInfo::IterationInfo( const std::string& aName, const double aRED )
 :mName( aName ), mRED( aRED ){}
 
+/*!
+ * \brief Limit the iterations this component may use the next time it solves.
+ * \details This allows a Solver to give less effort to a component that has
+ *          not been making progress without changing its configuration.
+ * \param aFraction The fraction of the configured maximum iterations to allow,
+ *        1 restores the full limit.
+ */
+void SolverComponent::setIterationBudget( const double aFraction ) {
+    mIterationBudget = std::min( aFraction, 1.0 );
+}
+
+/*!
+ * \brief Get the maximum iterations to use given the configured maximum and
+ *        the current iteration budget.
+ * \param aMaxIterations The configured maximum iterations.
+ * \return The iteration limit which is always at least one if the configured
+ *         maximum was.
+ */
+unsigned int SolverComponent::getIterationLimit( const unsigned int aMaxIterations ) const {
+    if( mIterationBudget >= 1.0 || aMaxIterations == 0 ) {
+        return aMaxIterations;
+    }
+    return std::max( 1u, static_cast<unsigned int>( ceil( aMaxIterations * mIterationBudget ) ) );
+}
+
 //! Add a solution iteration to the stack.
 void SolverComponent::addIteration( const std::string& aSolName, const double aRED ){
     mPastIters.push_back( IterationInfo( aSolName, aRED ) );
 }
 
+/*!
+ * \brief Record a solution iteration in the solver telemetry.
+ * \details If SolverTelemetry is enabled a record of the iteration is written
+ *          including the serial numbers of the worst markets.  This should be
+ *          called after addIteration for the same iteration.
+ * \param aSolutionSet The markets being solved.
+ * \param aPeriod The model period.
+ * \param aFNorm The norm of the solver's function value if available, if
+ *        negative the norm of the relative excess demands is used.
+ * \param aStepLength The length of the step taken in this iteration, or -1 if
+ *        not applicable.
+ */
+void SolverComponent::recordIteration( const SolutionInfoSet& aSolutionSet, const int aPeriod,
+                                       const double aFNorm, const double aStepLength ) const
+{
+    SolverTelemetry& telemetry = SolverTelemetry::getInstance();
+    const unsigned int numSolvable = aSolutionSet.getNumSolvable();
+    if( !telemetry.isEnabled() || numSolvable == 0 ) {
+        return;
+    }
+
+    SolverTelemetry::Record record;
+    memset( &record, 0, sizeof( record ) );
+    strncpy( record.mComponent, getXMLName().c_str(), SolverTelemetry::NAME_LENGTH - 1 );
+    record.mPeriod = aPeriod;
+    record.mIteration = mPastIters.empty() ? 0 : mPastIters.size() - 1;
+    record.mNumEvals = calcCounter->getPeriodCount();
+    record.mNumSolvable = numSolvable;
+    record.mStepLength = aStepLength;
+    record.mWallTime = ( boost::posix_time::microsec_clock::local_time() - mMethodStart )
+        .total_microseconds() / 1.0e6;
+
+    // Find the worst markets and the norm of the relative excess demands.
+    vector<pair<double, int> > relED( numSolvable );
+    double sumSq = 0;
+    for( unsigned int i = 0; i < numSolvable; ++i ) {
+        const SolutionInfo& currSol = aSolutionSet.getSolvable( i );
+        const double red = currSol.getRelativeED();
+        relED[ i ] = make_pair( fabs( red ), currSol.getSerialNumber() );
+        sumSq += red * red;
+    }
+    record.mFNorm = aFNorm >= 0 ? aFNorm : sqrt( sumSq );
+    const unsigned int numWorst = min<unsigned int>( numSolvable, SolverTelemetry::NUM_WORST_MARKETS );
+    partial_sort( relED.begin(), relED.begin() + numWorst, relED.end(),
+                  greater<pair<double, int> >() );
+    for( int i = 0; i < SolverTelemetry::NUM_WORST_MARKETS; ++i ) {
+        record.mWorstMarkets[ i ] = static_cast<unsigned int>( i ) < numWorst ? relED[ i ].second : -1;
+    }
+    telemetry.record( record );
+}
+
 //! Check for improvement over the last n iterations
 bool SolverComponent::isImproving( const unsigned int aNumIter ) const {
     // Check if there are enough iterations to check.
@@ -99,4 +182,5 @@ void SolverComponent::startMethod(){
     calcCounter->setCurrentMethod( getXMLName() );
     // Clear the stack.
     mPastIters.clear();
+    mMethodStart = boost::posix_time::microsec_clock::local_time();
 }
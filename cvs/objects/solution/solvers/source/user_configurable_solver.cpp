@@ -41,6 +41,20 @@
 #include "util/base/include/definitions.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <cerrno>
+#include <cstring>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 
@@ -50,9 +64,11 @@
 #include "solution/solvers/include/solver_component.h"
 #include "solution/solvers/include/solver_component_factory.h"
 #include "solution/util/include/solution_info_set.h"
+#include "solution/util/include/solution_info.h"
 #include "util/base/include/configuration.h"
 #include "util/logger/include/ilogger.h"
 #include "solution/util/include/calc_counter.h"
+#include "solution/util/include/sensitivity_price_forecaster.h"
 #include "util/base/include/xml_helper.h"
 #include "util/base/include/util.h"
 #include "util/base/include/auto_file.h"
@@ -70,7 +86,9 @@ UserConfigurableSolver::UserConfigurableSolver( Marketplace* aMarketplace, World
     mDefaultSolutionTolerance( 0.001),
     mDefaultSolutionFloor( 0.0001 ),
     mCalibrationTolerance( 0.01 ),
-    mMaxModelCalcs( 2000 )
+    mMaxModelCalcs( 2000 ),
+    mIsAdaptive( false ),
+    mIsPolicyRead( false )
 {
     // get the calc counter from the world
     mCalcCounter = world->getCalcCounter();
@@ -78,6 +96,12 @@ UserConfigurableSolver::UserConfigurableSolver( Marketplace* aMarketplace, World
 
 //! Destructor
 UserConfigurableSolver::~UserConfigurableSolver() {
+    // The policy is written once the run is complete rather than after each
+    // period since the solver may be run again, for instance by the target
+    // finder.
+    if( mIsPolicyRead && !mPolicyFileName.empty() ) {
+        writePolicy();
+    }
     for( CSolverComponentIterator it = mSolverComponents.begin(); it != mSolverComponents.end(); ++it ) {
         delete *it;
     }
@@ -116,6 +140,9 @@ bool UserConfigurableSolver::XMLParse( const DOMNode* aNode ) {
         else if( nodeName == "max-model-calcs" ) {
             mMaxModelCalcs = XMLHelper<int>::getValue( curr );
         }
+        else if( nodeName == "adaptive-sequence" ) {
+            mIsAdaptive = XMLHelper<bool>::getValue( curr );
+        }
         else if( SolverComponentFactory::hasSolverComponent( nodeName ) ) {
             SolverComponent* tempSolverComponent = SolverComponentFactory::createAndParseSolverComponent( nodeName,
                                                                                                           marketplace,
@@ -198,6 +225,12 @@ bool UserConfigurableSolver::solve( const int aPeriod, const SolutionInfoParamPa
         return false;
     }
     
+    // Improve on the extrapolated starting prices using the sensitivities of
+    // the last period if they are available.
+    if( SensitivityPriceForecaster::getInstance().forecastPrices( solution_set, world, marketplace, aPeriod ) ) {
+        solution_set.printMarketInfo( "Sensitivity Forecast", mCalcCounter->getPeriodCount(), singleLog );
+    }
+    
     solverLog << "Number of Markets: " << solution_set.getNumSolvable() << endl;
     solverLog << "Solution Information Initialized: Left and Right values are the same." << endl;
     solverLog.setLevel( ILogger::DEBUG );
@@ -208,24 +241,29 @@ bool UserConfigurableSolver::solve( const int aPeriod, const SolutionInfoParamPa
         (*it)->init();
     }
     
-    // Loop is done at least once.
-    do {
-        solverLog.setLevel( ILogger::NOTICE );
-        solverLog << "Solution() loop. N: " << mCalcCounter->getPeriodCount() << endl;
-        solverLog.setLevel( ILogger::DEBUG );
-        
-        // try each solver component in the order they were read
-        for( SolverComponentIterator it = mSolverComponents.begin(); it != mSolverComponents.end(); ++it ) {
-            // Note we are not checking the return code here since even if a solver component was able to
-            // solve successfully it is not necessarily working on the entire solution set.
-            solverLog << "\n%%%%%%%%%%%%%%%%Solution Set State:\n" << solution_set
-                      << "\n%%%%%%%%%%%%%%%%\n";
-            (*it)->solve( solution_set, aPeriod );
-        }
-        
-        // Determine if the model has solved. 
-    } while ( !solution_set.isAllSolved() &&
-              mCalcCounter->getPeriodCount() < mMaxModelCalcs );
+    if( mIsAdaptive ) {
+        solveAdaptive( solution_set, aPeriod );
+    }
+    else {
+        // Loop is done at least once.
+        do {
+            solverLog.setLevel( ILogger::NOTICE );
+            solverLog << "Solution() loop. N: " << mCalcCounter->getPeriodCount() << endl;
+            solverLog.setLevel( ILogger::DEBUG );
+            
+            // try each solver component in the order they were read
+            for( SolverComponentIterator it = mSolverComponents.begin(); it != mSolverComponents.end(); ++it ) {
+                // Note we are not checking the return code here since even if a solver component was able to
+                // solve successfully it is not necessarily working on the entire solution set.
+                solverLog << "\n%%%%%%%%%%%%%%%%Solution Set State:\n" << solution_set
+                          << "\n%%%%%%%%%%%%%%%%\n";
+                (*it)->solve( solution_set, aPeriod );
+            }
+            
+            // Determine if the model has solved. 
+        } while ( !solution_set.isAllSolved() &&
+                  mCalcCounter->getPeriodCount() < mMaxModelCalcs );
+    }
     
     if( conf->getBool( "CalibrationActive" )
             && !world->isAllCalibrated( aPeriod, mCalibrationTolerance, true ) ) {
@@ -270,3 +308,330 @@ bool UserConfigurableSolver::solve( const int aPeriod, const SolutionInfoParamPa
 
     return false;
 }
+
+//! Constructor
+UserConfigurableSolver::ComponentStats::ComponentStats():
+mNumRuns( 0 ),
+mNumProgress( 0 ),
+mCalcs( 0 ),
+mProgress( 0 )
+{
+}
+
+/*!
+ * \brief The progress made per model calc.
+ * \return The efficiency of the component.
+ */
+double UserConfigurableSolver::ComponentStats::getEfficiency() const {
+    return mProgress / max( mCalcs, 1.0 );
+}
+
+/*!
+ * \brief Solve the markets adapting the sequence of solver components to the
+ *        progress they make.
+ * \details The components are ordered by the progress per model calc they made
+ *          when last solving this period, or the closest earlier period if this
+ *          one has not been solved yet.  Components which made progress come
+ *          first followed by those which have not been tried, with those which
+ *          made no progress last.  Otherwise the configured order is kept.
+ *
+ *          Within the period a component which makes no progress has its
+ *          iteration budget halved for its next run and is skipped after it
+ *          fails to make progress twice in a row.  Such a component is only
+ *          restored if an entire pass makes no progress, at which point all of
+ *          the components are returned to the configured order and full
+ *          budgets.  Note that while any component makes even small progress a
+ *          stalled component remains skipped, so the adaptive sequence may run
+ *          fewer components than the configured one.
+ * \param aSolutionSet The markets to solve.
+ * \param aPeriod The period to solve.
+ */
+void UserConfigurableSolver::solveAdaptive( SolutionInfoSet& aSolutionSet, const int aPeriod ) {
+    ILogger& solverLog = ILogger::getLogger( "solver_log" );
+    if( !mIsPolicyRead ) {
+        readPolicy();
+        mIsPolicyRead = true;
+    }
+
+    vector<unsigned int> order = getAdaptiveOrder( aPeriod );
+
+    // Start components which did not make progress the last time with a reduced
+    // budget.
+    vector<int> numStalled( mSolverComponents.size(), 0 );
+    const vector<ComponentStats>* priorStats = getPriorStats( aPeriod );
+    if( priorStats ) {
+        for( unsigned int i = 0; i < mSolverComponents.size(); ++i ) {
+            if( (*priorStats)[ i ].mNumRuns > 0 && (*priorStats)[ i ].mNumProgress == 0 ) {
+                numStalled[ i ] = 1;
+            }
+        }
+    }
+
+    vector<ComponentStats>& periodStats = mComponentStats[ aPeriod ];
+    periodStats.resize( mSolverComponents.size() );
+
+    solverLog.setLevel( ILogger::NOTICE );
+    solverLog << "Adaptive solver component order:";
+    for( unsigned int i = 0; i < order.size(); ++i ) {
+        solverLog << ' ' << mSolverComponents[ order[ i ] ]->getXMLName();
+    }
+    solverLog << endl;
+
+    // Loop is done at least once.
+    do {
+        solverLog.setLevel( ILogger::NOTICE );
+        solverLog << "Solution() loop. N: " << mCalcCounter->getPeriodCount() << endl;
+        solverLog.setLevel( ILogger::DEBUG );
+
+        bool madeProgress = false;
+        for( unsigned int i = 0; i < order.size() && !aSolutionSet.isAllSolved() &&
+             mCalcCounter->getPeriodCount() < mMaxModelCalcs; ++i )
+        {
+            const unsigned int compIndex = order[ i ];
+            if( numStalled[ compIndex ] >= 2 ) {
+                continue;
+            }
+            SolverComponent* currComponent = mSolverComponents[ compIndex ];
+            currComponent->setIterationBudget( numStalled[ compIndex ] > 0 ? 0.5 : 1.0 );
+
+            solverLog << "\n%%%%%%%%%%%%%%%%Solution Set State:\n" << aSolutionSet
+                      << "\n%%%%%%%%%%%%%%%%\n";
+            const double distanceBefore = calcSolutionDistance( aSolutionSet );
+            const double calcsBefore = mCalcCounter->getPeriodCount();
+            currComponent->solve( aSolutionSet, aPeriod );
+            double progress = distanceBefore - calcSolutionDistance( aSolutionSet );
+            if( !( progress > 0 ) ) {
+                // No progress or invalid excess demands.
+                progress = 0;
+            }
+
+            ComponentStats& currStats = periodStats[ compIndex ];
+            ++currStats.mNumRuns;
+            currStats.mCalcs += mCalcCounter->getPeriodCount() - calcsBefore;
+            currStats.mProgress += progress;
+            // Ignore insignificant changes.
+            if( progress > 1e-4 * distanceBefore ) {
+                ++currStats.mNumProgress;
+                numStalled[ compIndex ] = 0;
+                madeProgress = true;
+            }
+            else {
+                ++numStalled[ compIndex ];
+            }
+        }
+
+        if( !madeProgress && !aSolutionSet.isAllSolved() ) {
+            // Fall back to the configured sequence.
+            solverLog.setLevel( ILogger::NOTICE );
+            solverLog << "No solver component made progress, using the configured order." << endl;
+            fill( numStalled.begin(), numStalled.end(), 0 );
+            for( unsigned int i = 0; i < order.size(); ++i ) {
+                order[ i ] = i;
+            }
+        }
+
+        // Determine if the model has solved.
+    } while ( !aSolutionSet.isAllSolved() &&
+              mCalcCounter->getPeriodCount() < mMaxModelCalcs );
+
+    for( SolverComponentIterator it = mSolverComponents.begin(); it != mSolverComponents.end(); ++it ) {
+        (*it)->setIterationBudget( 1.0 );
+    }
+}
+
+/*!
+ * \brief Get the order in which to try the solver components in the given
+ *        period based on the stats from the closest period solved.
+ * \param aPeriod The period about to be solved.
+ * \return The indices of the solver components in the order to try them.
+ */
+vector<unsigned int> UserConfigurableSolver::getAdaptiveOrder( const int aPeriod ) const {
+    vector<unsigned int> order( mSolverComponents.size() );
+    for( unsigned int i = 0; i < order.size(); ++i ) {
+        order[ i ] = i;
+    }
+    const vector<ComponentStats>* priorStats = getPriorStats( aPeriod );
+    if( !priorStats ) {
+        return order;
+    }
+
+    // Components which made progress are sorted by efficiency, the rest keep
+    // the configured order.
+    auto getRank = [priorStats] ( const unsigned int aIndex ) {
+        const ComponentStats& stats = (*priorStats)[ aIndex ];
+        return stats.mNumProgress > 0 ? 0 : stats.mNumRuns == 0 ? 1 : 2;
+    };
+    stable_sort( order.begin(), order.end(), [priorStats, &getRank] ( const unsigned int aLHS, const unsigned int aRHS ) {
+        const int lhsRank = getRank( aLHS );
+        const int rhsRank = getRank( aRHS );
+        if( lhsRank != rhsRank ) {
+            return lhsRank < rhsRank;
+        }
+        return lhsRank == 0 && (*priorStats)[ aLHS ].getEfficiency() > (*priorStats)[ aRHS ].getEfficiency();
+    } );
+    return order;
+}
+
+/*!
+ * \brief Get the stats learned for the given period or if it has not been
+ *        solved yet the closest earlier period which has.
+ * \param aPeriod The period about to be solved.
+ * \return The stats for each solver component or null if none are available.
+ */
+const vector<UserConfigurableSolver::ComponentStats>* UserConfigurableSolver::getPriorStats( const int aPeriod ) const {
+    PolicyMap::const_iterator iter = mComponentStats.upper_bound( aPeriod );
+    while( iter != mComponentStats.begin() ) {
+        --iter;
+        for( unsigned int i = 0; i < (*iter).second.size(); ++i ) {
+            if( (*iter).second[ i ].mNumRuns > 0 ) {
+                return &(*iter).second;
+            }
+        }
+    }
+    return 0;
+}
+
+/*!
+ * \brief Get a string which identifies the configured solver components so that
+ *        a saved policy is only used with the same configuration.
+ * \return The names of the solver components in order.
+ */
+string UserConfigurableSolver::getComponentSignature() const {
+    string signature;
+    for( CSolverComponentIterator it = mSolverComponents.begin(); it != mSolverComponents.end(); ++it ) {
+        if( !signature.empty() ) {
+            signature += ',';
+        }
+        signature += (*it)->getXMLName();
+    }
+    return signature;
+}
+
+/*!
+ * \brief Read a saved policy for this solver from the "solver-policy" file if
+ *        it is set to be written.
+ * \details The file name is determined here, following append-scenario-name,
+ *          and kept for writePolicy since the scenario may no longer be
+ *          available when the policy is written.
+ */
+void UserConfigurableSolver::readPolicy() {
+    const Configuration* conf = Configuration::getInstance();
+    if( !conf->shouldWriteFile( "solver-policy", false ) ) {
+        return;
+    }
+    mPolicyFileName = conf->getFile( "solver-policy", "solver-policy.txt", false );
+    if( conf->shouldAppendScnToFile( "solver-policy" ) ) {
+        mPolicyFileName = util::appendScenarioToFileName( mPolicyFileName );
+    }
+    map<pair<int, string>, vector<ComponentStats> > policies;
+    readPolicyFile( mPolicyFileName, policies );
+
+    const string signature = getComponentSignature();
+    for( auto currPolicy : policies ) {
+        if( currPolicy.first.second == signature && currPolicy.second.size() == mSolverComponents.size() ) {
+            mComponentStats[ currPolicy.first.first ] = currPolicy.second;
+        }
+    }
+}
+
+/*!
+ * \brief Write the learned policy for this solver to the "solver-policy" file.
+ * \details The policies of solvers with a different configuration or for
+ *          periods not solved by this solver which are already in the file are
+ *          kept.  The policy is written to a temporary file which then replaces
+ *          the policy file so that a reader never sees a partially written one.
+ *          Scenarios run in parallel processes may write the same policy file
+ *          so the read, merge and replace is done holding a lock on a lock file
+ *          next to the policy file, otherwise one process could drop the
+ *          policies written by another.
+ */
+void UserConfigurableSolver::writePolicy() const {
+#if !defined(_WIN32)
+    const string lockFileName = mPolicyFileName + ".lock";
+    const int lockFile = open( lockFileName.c_str(), O_RDWR | O_CREAT, 0644 );
+    if( lockFile == -1 || flock( lockFile, LOCK_EX ) == -1 ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Could not lock the solver policy lock file " << lockFileName << ": "
+                << strerror( errno ) << ", the solver policy was not written." << endl;
+        if( lockFile != -1 ) {
+            close( lockFile );
+        }
+        return;
+    }
+#endif
+    map<pair<int, string>, vector<ComponentStats> > policies;
+    readPolicyFile( mPolicyFileName, policies );
+
+    const string signature = getComponentSignature();
+    for( auto currPolicy : mComponentStats ) {
+        policies[ make_pair( currPolicy.first, signature ) ] = currPolicy.second;
+    }
+
+    const string tempFileName = mPolicyFileName + "." + util::toString( getpid() ) + ".tmp";
+    {
+        AutoOutputFile policyFile( tempFileName );
+        for( auto currPolicy : policies ) {
+            policyFile << currPolicy.first.first << ' ' << currPolicy.first.second << ' '
+                       << currPolicy.second.size() << endl;
+            for( auto currStats : currPolicy.second ) {
+                policyFile << currStats.mNumRuns << ' ' << currStats.mNumProgress << ' '
+                           << currStats.mCalcs << ' ' << currStats.mProgress << endl;
+            }
+        }
+    }
+#if defined(_WIN32)
+    // rename will not replace an existing file on this platform.
+    remove( mPolicyFileName.c_str() );
+#endif
+    if( rename( tempFileName.c_str(), mPolicyFileName.c_str() ) != 0 ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Could not write the solver policy file " << mPolicyFileName << "." << endl;
+        remove( tempFileName.c_str() );
+    }
+#if !defined(_WIN32)
+    // Closing the lock file releases the lock.
+    close( lockFile );
+#endif
+}
+
+/*!
+ * \brief Read all of the policies saved in a policy file.
+ * \details Each policy is a line with the period, the solver component
+ *          signature and the number of components followed by a line of stats
+ *          for each component.  A missing file is not an error.
+ * \param aFileName The policy file to read.
+ * \param aPolicies The policies read by period and signature.
+ */
+void UserConfigurableSolver::readPolicyFile( const string& aFileName,
+                                             map<pair<int, string>, vector<ComponentStats> >& aPolicies )
+{
+    ifstream policyFile( aFileName.c_str() );
+    int period;
+    string signature;
+    unsigned int numComponents;
+    while( policyFile >> period >> signature >> numComponents ) {
+        vector<ComponentStats>& stats = aPolicies[ make_pair( period, signature ) ];
+        stats.resize( numComponents );
+        for( unsigned int i = 0; i < numComponents; ++i ) {
+            policyFile >> stats[ i ].mNumRuns >> stats[ i ].mNumProgress
+                       >> stats[ i ].mCalcs >> stats[ i ].mProgress;
+        }
+    }
+}
+
+/*!
+ * \brief Calculate how far the markets are from being solved.
+ * \details All markets are included, not just those currently solvable, since
+ *          each solver component may filter the markets differently.
+ * \param aSolutionSet The markets being solved.
+ * \return The sum over the markets of the log of one plus the relative excess demand.
+ */
+double UserConfigurableSolver::calcSolutionDistance( const SolutionInfoSet& aSolutionSet ) {
+    double distance = 0;
+    for( unsigned int i = 0; i < aSolutionSet.getNumTotal(); ++i ) {
+        distance += log( 1.0 + fabs( aSolutionSet.getAny( i ).getRelativeED() ) );
+    }
+    return distance;
+}
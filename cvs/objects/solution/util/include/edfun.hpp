@@ -95,6 +95,17 @@ class LogEDFun : public VecFVec<double,double>
   int period;
   bool mLogPricep;               //!< Flag indicating whether inputs are prices or log-prices
 
+  //! Positions of the price, solver demand, and solver supply of each
+  //! market in mkts within the state slots of ManageStateVariables.
+  //! These let us set prices and collect supplies and demands in bulk
+  //! rather than through the Market accessors.
+  std::vector<unsigned int> mPriceIndex;
+  std::vector<unsigned int> mDemandIndex;
+  std::vector<unsigned int> mSupplyIndex;
+
+  //! The type of each market in mkts, which can not change during a solve.
+  std::vector<IMarketType::Type> mMktType;
+
   // diagnostic variables
   std::vector<double> mstate;
 public:
@@ -106,6 +117,11 @@ public:
   virtual double partialSize(int ip) const;
   void scaleInitInputs(UBVECTOR<double> &ax);
 
+  //! The scale of each input, the unscaled input is x[i]*getInputScale()[i]
+  const UBVECTOR<double>& getInputScale() const {return mxscl;}
+  //! The scale of each output, the unscaled output is fx[i]/getOutputScale()[i]
+  const UBVECTOR<double>& getOutputScale() const {return mfxscl;}
+
   // Constants to protect against overflow: 
   static const double PMAX;            //!< Greatest allowable price
   static const double ARGMAX;          //!< log of greatest allowable price
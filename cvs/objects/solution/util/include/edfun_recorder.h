@@ -0,0 +1,138 @@
+#ifndef _EDFUN_RECORDER_H_
+#define _EDFUN_RECORDER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file edfun_recorder.h
+* \ingroup Solution
+* \brief The header file for the EDFunRecorder class.
+*/
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <boost/numeric/ublas/vector.hpp>
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/spin_mutex.h>
+#endif
+
+class SolutionInfo;
+
+/*!
+* \ingroup Solution
+* \brief Records every LogEDFun evaluation so that solvers can be replayed
+*        offline against a surrogate of the model.
+* \details When the "edfun-recording" file is set to be written in the
+*          configuration, each LogEDFun that is created starts a new segment
+*          in the recording and every evaluation it performs is appended to
+*          it.  The file starts with the eight byte tag "GCAMEDF2" followed by
+*          tagged blocks in native byte order:
+*          - HEADER_TAG: period, number of markets, log price flag and then for
+*            each market its serial number, type and name (length then
+*            characters).
+*          - FULL_TAG: the input x followed by the output fx.
+*          - PARTIAL_TAG: the index of the perturbed input, the input x and
+*            the output fx.  The whole input is written since the Jacobian may
+*            be calculated at a point other than the last full evaluation, for
+*            instance after a failed line search.
+*
+*          ReplayEDFun reads these recordings back.
+*/
+class EDFunRecorder {
+public:
+    //! Tag which starts a new segment.
+    static const char HEADER_TAG = 'H';
+
+    //! Tag for a full evaluation.
+    static const char FULL_TAG = 'F';
+
+    //! Tag for a partial derivative evaluation.
+    static const char PARTIAL_TAG = 'P';
+
+    static EDFunRecorder& getInstance();
+
+    //! Whether evaluations should be recorded at all.
+    bool isEnabled() const {
+        return mIsEnabled;
+    }
+
+    void startSegment( const std::vector<SolutionInfo>& aMarkets, const int aPeriod,
+                       const bool aLogPricep );
+
+    void recordFull( const boost::numeric::ublas::vector<double>& aX,
+                     const boost::numeric::ublas::vector<double>& aFX );
+
+    void recordPartial( const int aPartj, const boost::numeric::ublas::vector<double>& aX,
+                        const boost::numeric::ublas::vector<double>& aFX );
+
+    void flush();
+private:
+    EDFunRecorder();
+    ~EDFunRecorder();
+    //! Private undefined copy constructor to prevent copying
+    EDFunRecorder( const EDFunRecorder& aOther );
+    //! Private undefined assignment operator to prevent copying
+    EDFunRecorder& operator=( const EDFunRecorder& aOther );
+
+    template<class T>
+    void write( const T& aValue ) {
+        mFile.write( reinterpret_cast<const char*>( &aValue ), sizeof( T ) );
+    }
+
+    void writeVector( const boost::numeric::ublas::vector<double>& aVec );
+
+    //! Whether the recording file was configured.
+    bool mIsEnabled;
+
+    //! The configured file name.
+    std::string mFileName;
+
+    //! The process which opened mFile, a forked child opens its own file.
+    int mOwnerProcess;
+
+    //! The open recording file.
+    std::ofstream mFile;
+
+#if GCAM_PARALLEL_ENABLED
+    //! Partial derivatives are evaluated concurrently.
+    tbb::spin_mutex mMutex;
+#endif
+};
+
+#endif // _EDFUN_RECORDER_H_
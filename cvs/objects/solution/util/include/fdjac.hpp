@@ -50,6 +50,7 @@
 #include <boost/numeric/ublas/matrix.hpp>
 #include "functor.hpp"
 #include <iostream>
+#include <vector>
 #include "solution/util/include/ublas-helpers.hpp"
 
 #define UBLAS boost::numeric::ublas
@@ -149,13 +150,12 @@ void fdjac(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
 
   Timer& jacTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::JACOBIAN );
   jacTimer.start();
-    if(usepartial) { scenario->getManageStateVariables()->setPartialDeriv(true); }
+    // There is no scenario when F is not the model, as when replaying
+    // recorded evaluations, in which case the columns are computed serially.
+    if(usepartial && scenario) { scenario->getManageStateVariables()->setPartialDeriv(true); }
   
-#if !GCAM_PARALLEL_ENABLED
-  for(size_t j=0; j<x.size(); ++j) {
-    jacol(F, x, fx, j, J, usepartial, diagnostic);
-  }
-#else
+#if GCAM_PARALLEL_ENABLED
+  if(scenario) {
     tbb::task_arena& threadPool = scenario->getManageStateVariables()->mThreadPool;
     tbb::task_group tg;
     threadPool.execute([&](){
@@ -166,7 +166,61 @@ void fdjac(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
         });
     });
     threadPool.execute([&tg](){ tg.wait(); });
+  }
+  else
 #endif
+  {
+    for(size_t j=0; j<x.size(); ++j) {
+      jacol(F, x, fx, j, J, usepartial, diagnostic);
+    }
+  }
+    if(usepartial) { F.partial(-1); }
+
+  jacTimer.stop();
+}
+
+
+/*!
+ * Recompute a subset of the columns of the Jacobian of F at point x.
+ * \details The remaining columns of J are left untouched.  This is useful for
+ *          refreshing the columns of an approximate Jacobian which are known
+ *          to be stale without paying for a model evaluation per market.
+ * \param[in] F: The function to have its Jacobian calculated
+ * \param[in] x: The point at which to calculate the Jacobian
+ * \param[in] fx: F(x)
+ * \param[in] cols: The indices of the columns to recompute
+ * \param[in,out] J: The Jacobian of F
+ * \param[in] usepartial: (optional) use partial model evaluation for partial derivatives
+ */
+template<class FTYPE, class MTRAIT>
+void fdjac(VecFVec<FTYPE,FTYPE> &F, const UBLAS::vector<FTYPE> &x,
+           const UBLAS::vector<FTYPE> &fx, const std::vector<int> &cols,
+           UBLAS::matrix<FTYPE,MTRAIT> &J, bool usepartial=true)
+{
+  Timer& jacTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::JACOBIAN );
+  jacTimer.start();
+    if(usepartial && scenario) { scenario->getManageStateVariables()->setPartialDeriv(true); }
+
+#if GCAM_PARALLEL_ENABLED
+  if(scenario) {
+    tbb::task_arena& threadPool = scenario->getManageStateVariables()->mThreadPool;
+    tbb::task_group tg;
+    threadPool.execute([&](){
+        tg.run([&](){
+            tbb::parallel_for_each( cols, [&]( const int j ) {
+                jacol(F, x, fx, j, J, usepartial);
+            });
+        });
+    });
+    threadPool.execute([&tg](){ tg.wait(); });
+  }
+  else
+#endif
+  {
+    for(size_t i=0; i<cols.size(); ++i) {
+      jacol(F, x, fx, cols[i], J, usepartial);
+    }
+  }
     if(usepartial) { F.partial(-1); }
 
   jacTimer.stop();
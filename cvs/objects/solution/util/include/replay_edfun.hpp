@@ -0,0 +1,151 @@
+#ifndef REPLAY_EDFUN_HPP_
+#define REPLAY_EDFUN_HPP_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+ * \file replay_edfun.hpp
+ * \ingroup Solution
+ * \brief A surrogate for LogEDFun built from recorded model evaluations.
+ */
+
+#include <string>
+#include <vector>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include "solution/util/include/functor.hpp"
+
+#define UBVECTOR boost::numeric::ublas::vector
+
+/*!
+ * \brief The evaluations recorded for a single LogEDFun by the EDFunRecorder.
+ */
+struct EDFunSegment {
+    //! A partial derivative evaluation.
+    struct Partial {
+        //! Index into mFullX of the full evaluation this partial is based on.
+        int mAnchor;
+
+        //! The index of the perturbed input.
+        int mColumn;
+
+        //! The value of the perturbed input.
+        double mXj;
+
+        //! The output vector.
+        UBVECTOR<double> mFX;
+    };
+
+    //! The model period.
+    int mPeriod;
+
+    //! Whether the inputs are log prices.
+    bool mLogPricep;
+
+    //! The market serial numbers in solver order.
+    std::vector<int> mSerialNumbers;
+
+    //! The market types in solver order.
+    std::vector<int> mMarketTypes;
+
+    //! The market names in solver order.
+    std::vector<std::string> mMarketNames;
+
+    //! The inputs of each full evaluation in the order they were made.
+    std::vector<UBVECTOR<double> > mFullX;
+
+    //! The outputs of each full evaluation.
+    std::vector<UBVECTOR<double> > mFullFX;
+
+    //! The partial derivative evaluations.
+    std::vector<Partial> mPartials;
+
+    static bool readSegments( const std::string& aFileName, std::vector<EDFunSegment>& aSegments,
+                              std::string& aError );
+
+    int findBase( const UBVECTOR<double>& aX, const int aColumn, const int aHint ) const;
+};
+
+/*!
+ * \class ReplayEDFun "solution/util/include/replay_edfun.hpp"
+ * \brief Functor which stands in for LogEDFun using a recorded segment.
+ * \details Each full evaluation which was followed by partial derivative
+ *          evaluations becomes an anchor with a finite difference Jacobian.
+ *          Columns which were not evaluated are taken from the closest earlier
+ *          anchor which has them and otherwise default to a unit negative own
+ *          price response.  The function is then approximated by the first
+ *          order expansion F(x) = F(x_k) + J_a (x - x_k) around the closest
+ *          recorded full evaluation x_k, using the Jacobian of the anchor a
+ *          closest to x_k.  Evaluating exactly at a recorded point therefore
+ *          reproduces the recorded output.
+ */
+class ReplayEDFun : public VecFVec<double,double>
+{
+public:
+    ReplayEDFun( const EDFunSegment& aSegment );
+
+    virtual void operator()( const UBVECTOR<double>& ax, UBVECTOR<double>& fx, const int partj = -1 );
+
+    //! The initial guess the solver was given when the segment was recorded.
+    const UBVECTOR<double>& getStartingPoint() const {
+        return mSegment.mFullX.front();
+    }
+
+    //! The number of anchors which have a Jacobian.
+    size_t getNumAnchors() const {
+        return mAnchors.size();
+    }
+
+private:
+    //! The recorded evaluations.
+    const EDFunSegment& mSegment;
+
+    //! Index into mSegment.mFullX of each anchor.
+    std::vector<int> mAnchors;
+
+    //! The Jacobian of each anchor.
+    std::vector<boost::numeric::ublas::matrix<double> > mJacobians;
+
+    //! The anchor to use for each full evaluation.
+    std::vector<int> mAnchorForPoint;
+
+    static double distance2( const UBVECTOR<double>& aX, const UBVECTOR<double>& aY );
+};
+
+#undef UBVECTOR
+
+#endif // REPLAY_EDFUN_HPP_
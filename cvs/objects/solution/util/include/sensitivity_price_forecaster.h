@@ -0,0 +1,122 @@
+#ifndef _SENSITIVITY_PRICE_FORECASTER_H_
+#define _SENSITIVITY_PRICE_FORECASTER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file sensitivity_price_forecaster.h
+* \ingroup Solution
+* \brief The header file for the SensitivityPriceForecaster class.
+*/
+
+#include <string>
+#include <vector>
+#include <map>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+
+class SolutionInfo;
+class SolutionInfoSet;
+class LogEDFun;
+class World;
+class Marketplace;
+
+/*!
+* \ingroup Solution
+* \brief Makes a jointly consistent starting guess for the prices in a new
+*        period from the sensitivities of the last solved period.
+* \details Marketplace::init_to_last guesses the price of each market in a new
+*          period by extrapolating its own price history.  That works poorly
+*          when markets jump between periods, such as when a carbon tax turns on
+*          or a new technology enters, and the solver then spends many
+*          iterations recovering.
+*
+*          When "sensitivity-price-forecast" is enabled in the configuration the
+*          Broyden solver stores the solved prices and its final Jacobian, in
+*          unscaled LogEDFun terms, each time it solves a period.  At the start
+*          of the next period the model is evaluated once at those prices which
+*          measures the effect of the change in exogenous drivers on excess
+*          demands.  A single Newton step with the stored Jacobian then gives
+*          the new guess:
+*              x = x_last - J^-1 * F_new( x_last )
+*          Markets which were not in the stored Jacobian, or for which the step
+*          would give an unreliable price by the same test init_to_last uses,
+*          keep their extrapolated price.
+*/
+class SensitivityPriceForecaster {
+public:
+    static SensitivityPriceForecaster& getInstance();
+
+    //! Whether the forecaster was enabled in the configuration.
+    bool isEnabled() const {
+        return mIsEnabled;
+    }
+
+    void storeJacobian( const int aPeriod, const std::vector<SolutionInfo>& aMarkets,
+                        const LogEDFun& aEDFun, const bool aLogPricep,
+                        const boost::numeric::ublas::vector<double>& aX,
+                        const boost::numeric::ublas::matrix<double>& aJacobian );
+
+    bool forecastPrices( SolutionInfoSet& aSolutionSet, World* aWorld,
+                         Marketplace* aMarketplace, const int aPeriod );
+private:
+    SensitivityPriceForecaster();
+    //! Private undefined copy constructor to prevent copying
+    SensitivityPriceForecaster( const SensitivityPriceForecaster& aOther );
+    //! Private undefined assignment operator to prevent copying
+    SensitivityPriceForecaster& operator=( const SensitivityPriceForecaster& aOther );
+
+    //! Whether the forecaster was enabled in the configuration.
+    bool mIsEnabled;
+
+    //! The period the stored Jacobian was calculated in or -1 if none.
+    int mPeriod;
+
+    //! Whether the stored inputs are log prices.
+    bool mLogPricep;
+
+    //! The index of each stored market by name.
+    std::map<std::string, unsigned int> mMarketIndex;
+
+    //! The solved inputs, prices or log prices, of the stored markets.
+    boost::numeric::ublas::vector<double> mX;
+
+    //! The unscaled Jacobian of LogEDFun at mX.
+    boost::numeric::ublas::matrix<double> mJacobian;
+};
+
+#endif // _SENSITIVITY_PRICE_FORECASTER_H_
@@ -75,6 +75,7 @@ class SolutionInfo {
         SolutionInfo.print( os );
         return os;
     }
+    friend class LogEDFun;
 public:
 #if GCAM_PARALLEL_ENABLED
     SolutionInfo( Market* linkedMarket, const std::vector<IActivity*>& aDependenicies, GcamFlowGraph* aFlowGraph );
@@ -104,6 +105,8 @@ public:
     double getED() const;
     double getEDLeft() const;
     double getEDRight() const;
+    double getXLeft() const;
+    double getXRight() const;
     void expandBracket( const double aAdjFactor );
     double getRelativeED() const;
     bool isWithinTolerance() const;
@@ -115,6 +118,7 @@ public:
     void decreaseX( const double multiplier, const double lowerBound );
     void moveRightBracketToX();
     void moveLeftBracketToX();
+    void setBrackets( const double aXLeft, const double aEDLeft, const double aXRight, const double aEDRight );
     void resetBrackets();
     bool isCurrentlyBracketed() const;
     bool isSolved() const;
@@ -61,6 +61,7 @@ class SolutionInfo;
 class SolutionInfoSet;
 class CalcCounter;
 class ISolutionInfoFilter;
+class IActivity;
 namespace objects {
     class Atom;
 }
@@ -97,6 +98,10 @@ public:
                         const unsigned int aMaxIterations, SolutionInfoSet& aSolSet, CalcCounter* aCalcCounter,
                         const ISolutionInfoFilter* aSolutionInfoFilter, const int aPeriod );
 
+   static bool kSectionBrackets( World* aWorld, const std::vector<SolutionInfo*>& aSolutions,
+                                 const std::vector<IActivity*>* aAffectedNodes,
+                                 const unsigned int aNumPoints, const int aPeriod );
+
 private:
     //! A function object to compare to values and see if they are approximately equal. 
     struct ApproxEqual : public std::unary_function<double, bool> {
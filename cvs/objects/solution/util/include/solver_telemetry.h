@@ -0,0 +1,151 @@
+#ifndef _SOLVER_TELEMETRY_H_
+#define _SOLVER_TELEMETRY_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file solver_telemetry.h
+* \ingroup Solution
+* \brief The header file for the SolverTelemetry class.
+*/
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+/*!
+* \ingroup Solution
+* \brief A compact binary sink for per-iteration solver records.
+* \details When the "solver-telemetry" file is set to be written in the
+*          configuration each SolverComponent iteration appends a fixed size
+*          Record to an in memory buffer which is written out after each
+*          period is solved.  This
+*          avoids formatting strings inside the solver loops and produces a
+*          file which can be loaded directly as a table for analysis across
+*          many runs.  The file starts with the eight byte tag "GCAMSLV1"
+*          followed by the size of a Record as a 32 bit integer and then the
+*          records themselves in native byte order.
+*
+*          The "solver-text-log" configuration flag may be turned off to skip
+*          the most expensive per-iteration dumps in the solver_log when the
+*          telemetry is sufficient.
+*/
+class SolverTelemetry {
+public:
+    //! The number of worst markets stored with each record.
+    static const int NUM_WORST_MARKETS = 3;
+
+    //! The maximum length of the component name stored with each record.
+    static const int NAME_LENGTH = 32;
+
+    //! A single solver iteration.
+    struct Record {
+        //! Name of the SolverComponent, null padded.
+        char mComponent[ NAME_LENGTH ];
+
+        //! Model period being solved.
+        int mPeriod;
+
+        //! Iteration number within the current call to the component.
+        int mIteration;
+
+        //! Number of world.calc evaluations so far in the period.
+        int mNumEvals;
+
+        //! Number of markets being solved.
+        int mNumSolvable;
+
+        //! Norm of the excess demand vector or -1 if not available.
+        double mFNorm;
+
+        //! Length of the step taken or -1 if not available.
+        double mStepLength;
+
+        //! Wall time in seconds since the component started.
+        double mWallTime;
+
+        //! Serial numbers of the markets with the largest relative excess
+        //! demand, worst first, padded with -1.
+        int mWorstMarkets[ NUM_WORST_MARKETS ];
+
+        //! Unused, keeps the record size a multiple of eight bytes.
+        int mPadding;
+    };
+
+    static SolverTelemetry& getInstance();
+
+    //! Whether records should be collected at all.
+    bool isEnabled() const {
+        return mIsEnabled;
+    }
+
+    //! Whether the detailed per-iteration text logging should be written.
+    bool isTextLogEnabled() const {
+        return mIsTextLogEnabled;
+    }
+
+    void record( const Record& aRecord );
+
+    void flush();
+private:
+    SolverTelemetry();
+    ~SolverTelemetry();
+    //! Private undefined copy constructor to prevent copying
+    SolverTelemetry( const SolverTelemetry& aOther );
+    //! Private undefined assignment operator to prevent copying
+    SolverTelemetry& operator=( const SolverTelemetry& aOther );
+
+    //! Whether the telemetry file was configured.
+    bool mIsEnabled;
+
+    //! Whether the detailed text logging is enabled.
+    bool mIsTextLogEnabled;
+
+    //! The configured file name.
+    std::string mFileName;
+
+    //! The process which opened mFile, a forked child opens its own file.
+    int mOwnerProcess;
+
+    //! The open telemetry file.
+    std::ofstream mFile;
+
+    //! Records which have not yet been written.
+    std::vector<Record> mBuffer;
+};
+
+#endif // _SOLVER_TELEMETRY_H_
@@ -42,6 +42,7 @@
 #include "util/logger/include/ilogger.h"
 #include "containers/include/scenario.h"
 #include "util/base/include/manage_state_variables.hpp"
+#include "solution/util/include/edfun_recorder.h"
 
 #include "util/base/include/timer.h"
 
@@ -68,6 +69,22 @@ LogEDFun::LogEDFun(SolutionInfoSet &sisin,
     mxscl.resize(na);
     mfxscl.resize(nr);          // note na==nr
 
+    // look up where each market's state lives so that we can get at it
+    // directly when setting prices and collecting supplies and demands
+    mPriceIndex.resize(na);
+    mDemandIndex.resize(na);
+    mSupplyIndex.resize(na);
+    mMktType.resize(na);
+    const ManageStateVariables* stateVars = scenario->getManageStateVariables();
+    for(int i=0; i<na; ++i) {
+        ManageStateVariables::MarketStateIndices indices =
+            stateVars->getMarketStateIndices(mkts[i].linkedMarket);
+        mPriceIndex[i] = indices.mPrice;
+        mDemandIndex[i] = indices.mDemand;
+        mSupplyIndex[i] = indices.mSupply;
+        mMktType[i] = mkts[i].getType();
+    }
+
     if(!mLogPricep) {
         // linear prices & outputs, so x0 is the price, and fx0 is
         // 1/demand(forecast), for all markets
@@ -104,6 +121,8 @@ LogEDFun::LogEDFun(SolutionInfoSet &sisin,
                 mfxscl[i] = 1.0;
         }
     } 
+
+    EDFunRecorder::getInstance().startSegment(mkts, period, mLogPricep);
 }
 
 /*!
@@ -162,6 +181,11 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, cons
   UBVECTOR<double> x(ax.size()); 
   for(unsigned int i=0; i<x.size(); ++i)
       x[i] = ax[i]*mxscl[i];
+
+  // The state slot the model will read and write for this evaluation.
+  // Prices are set and supplies and demands are collected directly in
+  // it.
+  double* state = scenario->getManageStateVariables()->getActiveState();
   
 
   /**** The way we do this is kind of ugly.  We have two procedures
@@ -188,14 +212,14 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, cons
        *****/
       for(size_t i=0; i<x.size(); ++i) {
         if(x[i] > ARGMAX)
-          mkts[i].setPrice(PMAX);
+          state[mPriceIndex[i]] = PMAX;
         else
-          mkts[i].setPrice(exp(x[i])); // input vector = log(price)
+          state[mPriceIndex[i]] = exp(x[i]); // input vector = log(price)
       }
     }
     else {
       for(size_t i=0; i<x.size(); ++i) {
-        mkts[i].setPrice(x[i]); // input vector = price
+        state[mPriceIndex[i]] = x[i]; // input vector = price
       }
     }
     edfunMiscTimer.stop();
@@ -241,9 +265,9 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, cons
        *****/
       for(size_t i=0; i<x.size(); ++i) {
         if(x[i] > ARGMAX)
-          mkts[i].setPrice(PMAX);
+          state[mPriceIndex[i]] = PMAX;
         else
-          mkts[i].setPrice(exp(x[i])); // input vector = log(price)
+          state[mPriceIndex[i]] = exp(x[i]); // input vector = log(price)
       }
     }
     else {
@@ -251,7 +275,7 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, cons
         // change and the rest were reset from stored values.  In theory
         // those reset prices are the same as in x however there may be some
         // slight differences due to roundoff error.
-        mkts[partj].setPrice(x[partj]);
+        state[mPriceIndex[partj]] = x[partj];
     }
 
     /****
@@ -295,10 +319,10 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, cons
   // store them in fx
   for(size_t i=0; i<mkts.size(); ++i) {
     const double TINY = util::getTinyNumber();
-    if(mLogPricep && mkts[i].getType() == IMarketType::NORMAL) { // LOG CASE (NORMAL markets only)
+    if(mLogPricep && mMktType[i] == IMarketType::NORMAL) { // LOG CASE (NORMAL markets only)
       // for normal markets, output log(demand/supply), if we are using log prices
-      double d = std::max(mkts[i].getDemand(), TINY);
-      double s = std::max(mkts[i].getSupply(), TINY);
+      double d = std::max(state[mDemandIndex[i]], TINY);
+      double s = std::max(state[mSupplyIndex[i]], TINY);
       double p0 = mkts[i].getLowerBoundSupplyPrice();
       double p  = x[i]>=ARGMAX ? PMAX : exp(x[i]);
       double c  = std::max(0.0, p0-p);
@@ -313,9 +337,9 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, cons
       }      
       fx[i] = log(d/s)+c;
     }
-    else if(mkts[i].getType() == IMarketType::NORMAL) { // LINEAR CASE (NORMAL markets only)
-        double d = mkts[i].getDemand();
-        double s = mkts[i].getSupply();
+    else if(mMktType[i] == IMarketType::NORMAL) { // LINEAR CASE (NORMAL markets only)
+        double d = state[mDemandIndex[i]];
+        double s = state[mSupplyIndex[i]];
 
         // generate a correction if the input price is less than the
         // supply curve lower bound.  This is most effective if we transform the
@@ -336,12 +360,12 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, cons
                     << "\n";
         }
     }
-    else if(!mLogPricep && ( mkts[i].getType() == IMarketType::RES  // LINEAR CASE (constraint type markets only)
-            || mkts[i].getType() == IMarketType::TAX
-            || mkts[i].getType() == IMarketType::SUBSIDY ) )
+    else if(!mLogPricep && ( mMktType[i] == IMarketType::RES  // LINEAR CASE (constraint type markets only)
+            || mMktType[i] == IMarketType::TAX
+            || mMktType[i] == IMarketType::SUBSIDY ) )
     {
-        double d = mkts[i].getDemand();
-        double s = mkts[i].getSupply();
+        double d = state[mDemandIndex[i]];
+        double s = state[mSupplyIndex[i]];
 
         // generate a correction if the input price is less than the
         // supply curve lower bound.  This is most effective if we transform the
@@ -364,13 +388,22 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx, cons
     else {                      // Markets that are neither normal nor constraint types.
       // for other types of markets (mostly price, demand, and
       // trial-value), output fractional demand - supply
-        fx[i] = mkts[i].getDemand() - mkts[i].getSupply();
+        fx[i] = state[mDemandIndex[i]] - state[mSupplyIndex[i]];
     }
   }
 
   // Do the scaling for fx
   for(unsigned i=0; i<fx.size(); ++i)
       fx[i] *= mfxscl[i];
+
+  // record the evaluation in solver space for offline replay
+  EDFunRecorder& recorder = EDFunRecorder::getInstance();
+  if(recorder.isEnabled()) {
+      if(partj < 0)
+          recorder.recordFull(ax, fx);
+      else
+          recorder.recordPartial(partj, ax, fx);
+  }
   
   edfunPostTimer.stop();
 
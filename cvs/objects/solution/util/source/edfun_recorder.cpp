@@ -0,0 +1,189 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file edfun_recorder.cpp
+* \ingroup Solution
+* \brief EDFunRecorder class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <cstring>
+#include <sstream>
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "solution/util/include/edfun_recorder.h"
+#include "solution/util/include/solution_info.h"
+#include "util/base/include/configuration.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+
+namespace {
+    //! The process which started the model, set during static initialization.
+    const int sMainProcess = getpid();
+}
+
+//! Get the single instance of the recorder.
+EDFunRecorder& EDFunRecorder::getInstance() {
+    static EDFunRecorder sInstance;
+    return sInstance;
+}
+
+/*!
+ * \brief Constructor.
+ * \details Reads the recording file name and whether it should be written from
+ *          the Configuration.  The file is opened by the first segment.
+ */
+EDFunRecorder::EDFunRecorder():
+mOwnerProcess( -1 )
+{
+    const Configuration* conf = Configuration::getInstance();
+    mFileName = conf->getFile( "edfun-recording", "", false );
+    mIsEnabled = !mFileName.empty() && conf->shouldWriteFile( "edfun-recording", false, false );
+}
+
+//! Destructor.
+EDFunRecorder::~EDFunRecorder() {
+    flush();
+}
+
+/*!
+ * \brief Start a new segment for a LogEDFun which was just created.
+ * \details A process forked by the BatchRunner or server mode writes to its own
+ *          file with the process id appended to the name.
+ * \param aMarkets The markets the LogEDFun will solve in order.
+ * \param aPeriod The model period.
+ * \param aLogPricep Whether the inputs are log prices.
+ */
+void EDFunRecorder::startSegment( const vector<SolutionInfo>& aMarkets, const int aPeriod,
+                                  const bool aLogPricep )
+{
+    if( !mIsEnabled ) {
+        return;
+    }
+
+    const int currProcess = getpid();
+    if( mOwnerProcess != currProcess ) {
+        if( mFile.is_open() ) {
+            mFile.close();
+        }
+        string fileName = mFileName;
+        if( currProcess != sMainProcess ) {
+            stringstream name;
+            name << mFileName << "." << currProcess;
+            fileName = name.str();
+        }
+        mOwnerProcess = currProcess;
+        mFile.open( fileName.c_str(), ios::out | ios::binary | ios::trunc );
+        if( !mFile ) {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Could not open LogEDFun recording file " << fileName
+                    << ", recording is disabled." << endl;
+            mIsEnabled = false;
+            return;
+        }
+        const char tag[] = "GCAMEDF2";
+        mFile.write( tag, strlen( tag ) );
+    }
+
+    write( HEADER_TAG );
+    write( static_cast<int>( aPeriod ) );
+    write( static_cast<int>( aMarkets.size() ) );
+    write( static_cast<int>( aLogPricep ) );
+    for( const SolutionInfo& currMarket : aMarkets ) {
+        write( static_cast<int>( currMarket.getSerialNumber() ) );
+        write( static_cast<int>( currMarket.getType() ) );
+        const string& name = currMarket.getName();
+        write( static_cast<int>( name.size() ) );
+        mFile.write( name.c_str(), name.size() );
+    }
+}
+
+/*!
+ * \brief Record a full evaluation.
+ * \param aX The input vector.
+ * \param aFX The output vector.
+ */
+void EDFunRecorder::recordFull( const boost::numeric::ublas::vector<double>& aX,
+                                const boost::numeric::ublas::vector<double>& aFX )
+{
+    if( !mIsEnabled ) {
+        return;
+    }
+#if GCAM_PARALLEL_ENABLED
+    tbb::spin_mutex::scoped_lock lock( mMutex );
+#endif
+    write( FULL_TAG );
+    writeVector( aX );
+    writeVector( aFX );
+}
+
+/*!
+ * \brief Record a partial derivative evaluation.
+ * \param aPartj The index of the input which was perturbed.
+ * \param aX The input vector including the perturbed input.
+ * \param aFX The output vector.
+ */
+void EDFunRecorder::recordPartial( const int aPartj, const boost::numeric::ublas::vector<double>& aX,
+                                   const boost::numeric::ublas::vector<double>& aFX )
+{
+    if( !mIsEnabled ) {
+        return;
+    }
+#if GCAM_PARALLEL_ENABLED
+    tbb::spin_mutex::scoped_lock lock( mMutex );
+#endif
+    write( PARTIAL_TAG );
+    write( aPartj );
+    writeVector( aX );
+    writeVector( aFX );
+}
+
+//! Write the recorded evaluations out to disk, called after each period.
+void EDFunRecorder::flush() {
+    if( mFile.is_open() ) {
+        mFile.flush();
+    }
+}
+
+//! Write the elements of a vector.
+void EDFunRecorder::writeVector( const boost::numeric::ublas::vector<double>& aVec ) {
+    mFile.write( reinterpret_cast<const char*>( &aVec[ 0 ] ), aVec.size() * sizeof( double ) );
+}
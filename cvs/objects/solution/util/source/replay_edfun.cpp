@@ -0,0 +1,289 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+ * \file replay_edfun.cpp
+ * \ingroup Solution
+ * \brief ReplayEDFun and EDFunSegment source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <fstream>
+#include <cstring>
+#include <limits>
+
+#include "solution/util/include/replay_edfun.hpp"
+#include "solution/util/include/edfun_recorder.h"
+
+#define UBVECTOR boost::numeric::ublas::vector
+
+using namespace std;
+
+namespace {
+    template<class T>
+    bool readValue( istream& aIn, T& aValue ) {
+        return static_cast<bool>( aIn.read( reinterpret_cast<char*>( &aValue ), sizeof( T ) ) );
+    }
+
+    bool readVector( istream& aIn, const int aSize, UBVECTOR<double>& aVec ) {
+        aVec.resize( aSize );
+        return aSize == 0 ||
+            static_cast<bool>( aIn.read( reinterpret_cast<char*>( &aVec[ 0 ] ), aSize * sizeof( double ) ) );
+    }
+}
+
+/*!
+ * \brief Read all of the segments in a file written by the EDFunRecorder.
+ * \details Segments which do not contain any full evaluations are dropped.
+ * \param aFileName The recording to read.
+ * \param aSegments The vector to which segments will be appended.
+ * \param aError Set to a description of the problem if reading fails.
+ * \return Whether the file could be read in its entirety.
+ */
+bool EDFunSegment::readSegments( const string& aFileName, vector<EDFunSegment>& aSegments,
+                                 string& aError )
+{
+    ifstream in( aFileName.c_str(), ios::in | ios::binary );
+    if( !in ) {
+        aError = "could not open " + aFileName;
+        return false;
+    }
+
+    const char expectedTag[] = "GCAMEDF2";
+    char tag[ sizeof( expectedTag ) ] = { 0 };
+    if( !in.read( tag, strlen( expectedTag ) ) || strcmp( tag, expectedTag ) != 0 ) {
+        aError = aFileName + " is not a LogEDFun recording of a supported version";
+        return false;
+    }
+
+    char blockTag;
+    while( readValue( in, blockTag ) ) {
+        if( blockTag == EDFunRecorder::HEADER_TAG ) {
+            if( !aSegments.empty() && aSegments.back().mFullX.empty() ) {
+                aSegments.pop_back();
+            }
+            aSegments.push_back( EDFunSegment() );
+            EDFunSegment& segment = aSegments.back();
+            int size = 0;
+            int logPricep = 0;
+            bool ok = readValue( in, segment.mPeriod ) && readValue( in, size ) &&
+                readValue( in, logPricep );
+            segment.mLogPricep = logPricep != 0;
+            for( int i = 0; ok && i < size; ++i ) {
+                int serial = 0;
+                int type = 0;
+                int nameLength = 0;
+                ok = readValue( in, serial ) && readValue( in, type ) && readValue( in, nameLength );
+                string name( ok ? nameLength : 0, ' ' );
+                ok = ok && ( nameLength == 0 || in.read( &name[ 0 ], nameLength ) );
+                segment.mSerialNumbers.push_back( serial );
+                segment.mMarketTypes.push_back( type );
+                segment.mMarketNames.push_back( name );
+            }
+            if( !ok ) {
+                aError = "truncated segment header";
+                return false;
+            }
+            continue;
+        }
+
+        if( aSegments.empty() ) {
+            aError = "evaluation recorded before any segment header";
+            return false;
+        }
+        EDFunSegment& segment = aSegments.back();
+        const int size = static_cast<int>( segment.mMarketNames.size() );
+        if( blockTag == EDFunRecorder::FULL_TAG ) {
+            segment.mFullX.push_back( UBVECTOR<double>() );
+            segment.mFullFX.push_back( UBVECTOR<double>() );
+            if( !readVector( in, size, segment.mFullX.back() ) ||
+                !readVector( in, size, segment.mFullFX.back() ) )
+            {
+                aError = "truncated full evaluation";
+                return false;
+            }
+        }
+        else if( blockTag == EDFunRecorder::PARTIAL_TAG ) {
+            Partial partial;
+            UBVECTOR<double> x;
+            if( !readValue( in, partial.mColumn ) || !readVector( in, size, x ) ||
+                !readVector( in, size, partial.mFX ) )
+            {
+                aError = "truncated partial evaluation";
+                return false;
+            }
+            // Partials whose base point was never fully evaluated are of no use.
+            if( partial.mColumn >= 0 && partial.mColumn < size ) {
+                partial.mXj = x[ partial.mColumn ];
+                const int lastAnchor = segment.mPartials.empty() ? -1 : segment.mPartials.back().mAnchor;
+                partial.mAnchor = segment.findBase( x, partial.mColumn, lastAnchor );
+                if( partial.mAnchor >= 0 ) {
+                    segment.mPartials.push_back( partial );
+                }
+            }
+        }
+        else {
+            aError = "unknown block in recording";
+            return false;
+        }
+    }
+
+    if( !aSegments.empty() && aSegments.back().mFullX.empty() ) {
+        aSegments.pop_back();
+    }
+    return true;
+}
+
+/*!
+ * \brief Find the full evaluation a partial derivative evaluation was based on.
+ * \details That is the latest full evaluation whose inputs equal those of the
+ *          partial except for the perturbed one.  The inputs are copied by the
+ *          solver so they compare exactly.
+ * \param aX The inputs of the partial derivative evaluation.
+ * \param aColumn The index of the perturbed input.
+ * \param aHint A full evaluation to check first, usually the base of the
+ *              previous partial, or -1.
+ * \return The index into mFullX of the base evaluation or -1 if there is none.
+ */
+int EDFunSegment::findBase( const UBVECTOR<double>& aX, const int aColumn, const int aHint ) const {
+    auto isBase = [&]( const int aIndex ) -> bool {
+        const UBVECTOR<double>& fullX = mFullX[ aIndex ];
+        for( size_t i = 0; i < aX.size(); ++i ) {
+            if( static_cast<int>( i ) != aColumn && fullX[ i ] != aX[ i ] ) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if( aHint >= 0 && isBase( aHint ) ) {
+        return aHint;
+    }
+    for( int index = static_cast<int>( mFullX.size() ) - 1; index >= 0; --index ) {
+        if( isBase( index ) ) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+/*!
+ * \brief Constructor which builds the anchor Jacobians.
+ * \param aSegment The recorded evaluations which must contain at least one full
+ *        evaluation and must outlive this object.
+ */
+ReplayEDFun::ReplayEDFun( const EDFunSegment& aSegment ):
+mSegment( aSegment )
+{
+    na = nr = static_cast<int>( aSegment.mMarketNames.size() );
+    mdiagnostic = false;
+
+    // The default Jacobian, used for columns which were never evaluated.
+    boost::numeric::ublas::matrix<double> J( na, nr );
+    J.clear();
+    for( int j = 0; j < na; ++j ) {
+        J( j, j ) = -1.0;
+    }
+
+    for( size_t p = 0; p < mSegment.mPartials.size(); ++p ) {
+        const EDFunSegment::Partial& partial = mSegment.mPartials[ p ];
+        if( mAnchors.empty() || mAnchors.back() != partial.mAnchor ) {
+            // Start from the previous anchor so that any columns not refreshed carry over.
+            const boost::numeric::ublas::matrix<double> startJ = mJacobians.empty() ? J : mJacobians.back();
+            mAnchors.push_back( partial.mAnchor );
+            mJacobians.push_back( startJ );
+        }
+        const UBVECTOR<double>& x0 = mSegment.mFullX[ partial.mAnchor ];
+        const UBVECTOR<double>& fx0 = mSegment.mFullFX[ partial.mAnchor ];
+        const int j = partial.mColumn;
+        const double h = partial.mXj - x0[ j ];
+        if( h == 0.0 ) {
+            continue;
+        }
+        boost::numeric::ublas::matrix<double>& currJ = mJacobians.back();
+        for( int i = 0; i < nr; ++i ) {
+            currJ( i, j ) = ( partial.mFX[ i ] - fx0[ i ] ) / h;
+        }
+    }
+    if( mAnchors.empty() ) {
+        mAnchors.push_back( 0 );
+        mJacobians.push_back( J );
+    }
+
+    // Match each full evaluation to the anchor closest to it.
+    mAnchorForPoint.resize( mSegment.mFullX.size() );
+    for( size_t k = 0; k < mSegment.mFullX.size(); ++k ) {
+        double best = numeric_limits<double>::max();
+        for( size_t a = 0; a < mAnchors.size(); ++a ) {
+            const double dist = distance2( mSegment.mFullX[ k ], mSegment.mFullX[ mAnchors[ a ] ] );
+            if( dist < best ) {
+                best = dist;
+                mAnchorForPoint[ k ] = static_cast<int>( a );
+            }
+        }
+    }
+}
+
+/*!
+ * \brief Evaluate the surrogate.
+ * \details The partial derivative hint is ignored since every evaluation has
+ *          the same cost.
+ * \param ax The input vector in solver space.
+ * \param fx The output vector.
+ * \param partj Ignored.
+ */
+void ReplayEDFun::operator()( const UBVECTOR<double>& ax, UBVECTOR<double>& fx, const int partj ) {
+    size_t closest = 0;
+    double best = numeric_limits<double>::max();
+    for( size_t k = 0; k < mSegment.mFullX.size(); ++k ) {
+        const double dist = distance2( ax, mSegment.mFullX[ k ] );
+        if( dist < best ) {
+            best = dist;
+            closest = k;
+        }
+    }
+
+    const UBVECTOR<double>& xk = mSegment.mFullX[ closest ];
+    const boost::numeric::ublas::matrix<double>& J = mJacobians[ mAnchorForPoint[ closest ] ];
+    UBVECTOR<double> dx = ax - xk;
+    fx = mSegment.mFullFX[ closest ] + boost::numeric::ublas::prod( J, dx );
+}
+
+//! The squared euclidean distance between two points.
+double ReplayEDFun::distance2( const UBVECTOR<double>& aX, const UBVECTOR<double>& aY ) {
+    double dist = 0.0;
+    for( size_t i = 0; i < aX.size(); ++i ) {
+        const double diff = aX[ i ] - aY[ i ];
+        dist += diff * diff;
+    }
+    return dist;
+}
@@ -0,0 +1,218 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file sensitivity_price_forecaster.cpp
+* \ingroup Solution
+* \brief SensitivityPriceForecaster class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <cmath>
+#include <algorithm>
+#include <boost/numeric/ublas/lu.hpp>
+
+#include "solution/util/include/sensitivity_price_forecaster.h"
+#include "solution/util/include/edfun.hpp"
+#include "solution/util/include/solution_info.h"
+#include "solution/util/include/solution_info_set.h"
+#include "util/base/include/configuration.h"
+#include "util/base/include/util.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+using namespace boost::numeric::ublas;
+
+//! Get the single instance of the forecaster.
+SensitivityPriceForecaster& SensitivityPriceForecaster::getInstance() {
+    static SensitivityPriceForecaster sInstance;
+    return sInstance;
+}
+
+//! Constructor which reads whether the forecaster is enabled.
+SensitivityPriceForecaster::SensitivityPriceForecaster():
+mPeriod( -1 ),
+mLogPricep( true )
+{
+    mIsEnabled = Configuration::getInstance()->getBool( "sensitivity-price-forecast", false, false );
+}
+
+/*!
+ * \brief Store the solution and Jacobian of a solved period for use in
+ *        forecasting the next.
+ * \details The solver works in the scaled space of the given LogEDFun whose
+ *          scales depend on the forecasts of the period they were created in.
+ *          The scales are removed here so that the Jacobian can be used with
+ *          the scales of a later period.
+ * \param aPeriod The period which was solved.
+ * \param aMarkets The markets, in the order of aX.
+ * \param aEDFun The function which was solved.
+ * \param aLogPricep Whether the inputs of aEDFun are log prices.
+ * \param aX The scaled solution.
+ * \param aJacobian The scaled Jacobian at aX.
+ */
+void SensitivityPriceForecaster::storeJacobian( const int aPeriod, const std::vector<SolutionInfo>& aMarkets,
+                                                const LogEDFun& aEDFun, const bool aLogPricep,
+                                                const boost::numeric::ublas::vector<double>& aX,
+                                                const matrix<double>& aJacobian )
+{
+    const boost::numeric::ublas::vector<double>& xscl = aEDFun.getInputScale();
+    const boost::numeric::ublas::vector<double>& fxscl = aEDFun.getOutputScale();
+    const size_t numMarkets = aMarkets.size();
+
+    mPeriod = aPeriod;
+    mLogPricep = aLogPricep;
+    mMarketIndex.clear();
+    mX.resize( numMarkets, false );
+    mJacobian.resize( numMarkets, numMarkets, false );
+    for( size_t i = 0; i < numMarkets; ++i ) {
+        mMarketIndex[ aMarkets[ i ].getName() ] = i;
+        mX[ i ] = aX[ i ] * xscl[ i ];
+        for( size_t j = 0; j < numMarkets; ++j ) {
+            mJacobian( i, j ) = aJacobian( i, j ) / fxscl[ i ] / xscl[ j ];
+        }
+    }
+}
+
+/*!
+ * \brief Replace the extrapolated prices of the markets to solve with a
+ *        forecast from the sensitivities of the previous period.
+ * \details The model is evaluated once at the previous period's solution and
+ *          once more at the forecast so that supplies and demands are
+ *          consistent with the prices the solver starts from.  Nothing is
+ *          changed if there is no Jacobian for the previous period.
+ * \param aSolutionSet The solution set for the period.
+ * \param aWorld The world to evaluate.
+ * \param aMarketplace The marketplace.
+ * \param aPeriod The period about to be solved.
+ * \return Whether a forecast was made.
+ */
+bool SensitivityPriceForecaster::forecastPrices( SolutionInfoSet& aSolutionSet, World* aWorld,
+                                                 Marketplace* aMarketplace, const int aPeriod )
+{
+    if( !mIsEnabled || mPeriod < 0 || mPeriod != aPeriod - 1 ) {
+        return false;
+    }
+
+    const std::vector<SolutionInfo> markets = aSolutionSet.getSolvableSet();
+    const size_t numMarkets = markets.size();
+
+    // Match the markets to solve with those in the stored Jacobian.
+    std::vector<unsigned int> matched;
+    std::vector<unsigned int> storedIndex;
+    for( size_t i = 0; i < numMarkets; ++i ) {
+        map<string, unsigned int>::const_iterator it = mMarketIndex.find( markets[ i ].getName() );
+        if( it != mMarketIndex.end() ) {
+            matched.push_back( i );
+            storedIndex.push_back( it->second );
+        }
+    }
+    if( matched.empty() ) {
+        return false;
+    }
+
+    ILogger& solverLog = ILogger::getLogger( "solver_log" );
+    solverLog.setLevel( ILogger::NOTICE );
+
+    // Start from the extrapolated inputs and replace those we have a solution
+    // for.
+    boost::numeric::ublas::vector<double> extrapolated( numMarkets );
+    for( size_t i = 0; i < numMarkets; ++i ) {
+        extrapolated[ i ] = mLogPricep ? log( max( markets[ i ].getPrice(), util::getTinyNumber() ) )
+                                       : markets[ i ].getPrice();
+    }
+    boost::numeric::ublas::vector<double> x( extrapolated );
+    for( size_t k = 0; k < matched.size(); ++k ) {
+        x[ matched[ k ] ] = mX[ storedIndex[ k ] ];
+    }
+
+    LogEDFun F( aSolutionSet, aWorld, aMarketplace, aPeriod, mLogPricep );
+    const boost::numeric::ublas::vector<double>& xscl = F.getInputScale();
+    const boost::numeric::ublas::vector<double>& fxscl = F.getOutputScale();
+    boost::numeric::ublas::vector<double> xs( numMarkets );
+    boost::numeric::ublas::vector<double> fx( numMarkets );
+    for( size_t i = 0; i < numMarkets; ++i ) {
+        xs[ i ] = x[ i ] / xscl[ i ];
+    }
+    F( xs, fx );
+
+    // Solve J * dx = -F( x_last ) over the matched markets.
+    const size_t numMatched = matched.size();
+    matrix<double> jac( numMatched, numMatched );
+    boost::numeric::ublas::vector<double> dx( numMatched );
+    for( size_t a = 0; a < numMatched; ++a ) {
+        for( size_t b = 0; b < numMatched; ++b ) {
+            jac( a, b ) = mJacobian( storedIndex[ a ], storedIndex[ b ] );
+        }
+        dx[ a ] = -fx[ matched[ a ] ] / fxscl[ matched[ a ] ];
+    }
+    permutation_matrix<size_t> perm( numMatched );
+    const bool isSingular = lu_factorize( jac, perm ) != 0;
+    unsigned int numForecast = 0;
+    if( !isSingular ) {
+        lu_substitute( jac, perm, dx );
+        for( size_t a = 0; a < numMatched; ++a ) {
+            const size_t i = matched[ a ];
+            const double lastPrice = mLogPricep ? exp( x[ i ] ) : x[ i ];
+            const double newX = mLogPricep ? min( x[ i ] + dx[ a ], LogEDFun::ARGMAX ) : x[ i ] + dx[ a ];
+            const double newPrice = mLogPricep ? exp( newX ) : newX;
+            // Only use the forecast if it is reliable, the same test
+            // Marketplace::init_to_last applies to extrapolated prices.
+            if( !util::isValidNumber( newX ) || ( newPrice < 0.0 && lastPrice > 0.0 ) ||
+                fabs( newPrice ) > 5.0 * fabs( lastPrice ) )
+            {
+                x[ i ] = extrapolated[ i ];
+            }
+            else {
+                x[ i ] = newX;
+                ++numForecast;
+            }
+        }
+    }
+    else {
+        solverLog << "Jacobian from period " << mPeriod << " is singular for the markets to solve,"
+                  << " using extrapolated prices." << endl;
+        x = extrapolated;
+    }
+
+    // Evaluate at the starting guess so that supplies and demands are
+    // consistent with it.
+    for( size_t i = 0; i < numMarkets; ++i ) {
+        xs[ i ] = x[ i ] / xscl[ i ];
+    }
+    F( xs, fx );
+
+    solverLog << "Forecast prices from period " << mPeriod << " sensitivities for " << numForecast
+              << " of " << numMarkets << " markets." << endl;
+    return numForecast > 0;
+}
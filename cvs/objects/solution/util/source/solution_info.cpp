@@ -227,6 +227,16 @@ double SolutionInfo::getEDRight() const {
     return EDR;
 }
 
+//! Get the price at the left bracket.
+double SolutionInfo::getXLeft() const {
+    return XL;
+}
+
+//! Get the price at the right bracket.
+double SolutionInfo::getXRight() const {
+    return XR;
+}
+
 /*! \brief Return the name of the SolutionInfo object.
 * \author Josh Lurz
 * \return The name of the market the SolutionInfo is connected to.
@@ -449,6 +459,22 @@ void SolutionInfo::moveLeftBracketToX(){
     EDL = getED();
 }
 
+/*!
+ * \brief Set both brackets to prices and EDs which were evaluated elsewhere.
+ * \details Used when a bracket point was evaluated in a scratch state and so
+ *          getPrice() and getED() no longer reflect it.
+ * \param aXLeft The new left bracket price.
+ * \param aEDLeft The ED at the new left bracket.
+ * \param aXRight The new right bracket price.
+ * \param aEDRight The ED at the new right bracket.
+ */
+void SolutionInfo::setBrackets( const double aXLeft, const double aEDLeft, const double aXRight, const double aEDRight ){
+    XL = aXLeft;
+    EDL = aEDLeft;
+    XR = aXRight;
+    EDR = aEDRight;
+}
+
 //! Reset left and right bracket to X.
 void SolutionInfo::resetBrackets(){
     bracketed = false;
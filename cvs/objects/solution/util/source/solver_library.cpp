@@ -62,9 +62,18 @@
 #include "util/logger/include/ilogger.h"
 #include "solution/util/include/ublas-helpers.hpp"
 #include "containers/include/iactivity.h"
+#include "containers/include/scenario.h"
+#include "util/base/include/manage_state_variables.hpp"
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/task_group.h>
+#include <tbb/parallel_for.h>
+#endif
 
 using namespace std;
 
+extern Scenario* scenario;
+
 #define NO_REGIONAL_DERIVATIVES 0
 
 /*! \brief Calculate and return a relative excess demand.
@@ -466,6 +475,112 @@ bool SolverLibrary::bracket( Marketplace* aMarketplace, World* aWorld, const dou
     return code;
 }
 
+/*!
+ * \brief Narrow the brackets of a set of markets by evaluating several interior
+ *        points between them concurrently.
+ * \details The bracket interval of every given market is split into
+ *          aNumPoints + 1 equal pieces and the model is evaluated once at
+ *          each interior point, with all of the markets set to their
+ *          respective point at the same time.  The evaluations are run in
+ *          parallel, each in its own scratch state slot starting from the
+ *          current "base" state, so that the base state is left exactly as
+ *          it was.  Each market then keeps the adjacent pair of points which
+ *          contains its sign change using the same rule as bisection: the
+ *          first point with ED < 0 becomes the right bracket and the point
+ *          before it the left bracket.
+ *
+ *          Since the trial evaluations are calculated as differences from the
+ *          base state the base state must reflect a full evaluation at the
+ *          current prices when this is called.
+ * \param aWorld World reference.
+ * \param aSolutions The bracketed markets to narrow.
+ * \param aAffectedNodes The activities to calculate for each point or null to
+ *                       calculate the full model.
+ * \param aNumPoints The number of interior points to evaluate.
+ * \param aPeriod Model period.
+ * \return Whether the brackets were narrowed which will be false if
+ *         aNumPoints is zero or the model was not built with parallel
+ *         support.
+ */
+bool SolverLibrary::kSectionBrackets( World* aWorld, const vector<SolutionInfo*>& aSolutions,
+                                      const vector<IActivity*>* aAffectedNodes,
+                                      const unsigned int aNumPoints, const int aPeriod )
+{
+#if GCAM_PARALLEL_ENABLED
+    if( aNumPoints == 0 || aSolutions.empty() ) {
+        return false;
+    }
+
+    const size_t numSols = aSolutions.size();
+    vector<double> left( numSols );
+    vector<double> right( numSols );
+    for( size_t i = 0; i < numSols; ++i ) {
+        left[ i ] = aSolutions[ i ]->getXLeft();
+        right[ i ] = aSolutions[ i ]->getXRight();
+    }
+
+    // Trial prices and EDs indexed by [ point ][ market ], each point is only
+    // written by the task which evaluated it.
+    vector<vector<double> > trialPrices( aNumPoints, vector<double>( numSols ) );
+    vector<vector<double> > trialEDs( aNumPoints, vector<double>( numSols ) );
+
+    ManageStateVariables* stateManager = scenario->getManageStateVariables();
+    stateManager->setPartialDeriv( true );
+    Marketplace::mIsDerivativeCalc = true;
+
+    tbb::task_arena& threadPool = stateManager->mThreadPool;
+    tbb::task_group tg;
+    threadPool.execute( [&]() {
+        tg.run( [&]() {
+            tbb::parallel_for( 0u, aNumPoints, [&]( const unsigned int aPoint ) {
+                stateManager->copyState();
+                const double fraction = static_cast<double>( aPoint + 1 ) / static_cast<double>( aNumPoints + 1 );
+                for( size_t i = 0; i < numSols; ++i ) {
+                    trialPrices[ aPoint ][ i ] = left[ i ] + ( right[ i ] - left[ i ] ) * fraction;
+                    aSolutions[ i ]->setPrice( trialPrices[ aPoint ][ i ] );
+                }
+                // Note each point is calculated in serial as the loop over
+                // points is already parallel.
+                if( aAffectedNodes ) {
+                    aWorld->calc( aPeriod, *aAffectedNodes );
+                }
+                else {
+                    aWorld->calc( aPeriod );
+                }
+                for( size_t i = 0; i < numSols; ++i ) {
+                    trialEDs[ aPoint ][ i ] = aSolutions[ i ]->getED();
+                }
+            } );
+        } );
+    } );
+    threadPool.execute( [&tg]() { tg.wait(); } );
+
+    Marketplace::mIsDerivativeCalc = false;
+    stateManager->setPartialDeriv( false );
+
+    for( size_t i = 0; i < numSols; ++i ) {
+        SolutionInfo* currSol = aSolutions[ i ];
+        double newLeft = currSol->getXLeft();
+        double newEDLeft = currSol->getEDLeft();
+        double newRight = currSol->getXRight();
+        double newEDRight = currSol->getEDRight();
+        for( unsigned int point = 0; point < aNumPoints; ++point ) {
+            if( trialEDs[ point ][ i ] < 0 ) {
+                newRight = trialPrices[ point ][ i ];
+                newEDRight = trialEDs[ point ][ i ];
+                break;
+            }
+            newLeft = trialPrices[ point ][ i ];
+            newEDLeft = trialEDs[ point ][ i ];
+        }
+        currSol->setBrackets( newLeft, newEDLeft, newRight, newEDRight );
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
 /*
  * \brief Function finds bracket interval for a single market.
  * \author Josh Lurz
@@ -0,0 +1,137 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file solver_telemetry.cpp
+* \ingroup Solution
+* \brief SolverTelemetry class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <cstring>
+#include <sstream>
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "solution/util/include/solver_telemetry.h"
+#include "util/base/include/configuration.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+
+namespace {
+    //! The process which started the model, set during static initialization.
+    const int sMainProcess = getpid();
+}
+
+//! Get the single instance of the telemetry sink.
+SolverTelemetry& SolverTelemetry::getInstance() {
+    static SolverTelemetry sInstance;
+    return sInstance;
+}
+
+/*!
+ * \brief Constructor.
+ * \details Reads the telemetry file name, whether it should be written and
+ *          the text log flag from the Configuration.  The file itself is not opened until the first
+ *          records are flushed.
+ */
+SolverTelemetry::SolverTelemetry():
+mOwnerProcess( -1 )
+{
+    const Configuration* conf = Configuration::getInstance();
+    mFileName = conf->getFile( "solver-telemetry", "", false );
+    mIsEnabled = !mFileName.empty() && conf->shouldWriteFile( "solver-telemetry", false, false );
+    mIsTextLogEnabled = conf->getBool( "solver-text-log", true, false );
+}
+
+//! Destructor which writes any remaining records.
+SolverTelemetry::~SolverTelemetry() {
+    flush();
+}
+
+/*!
+ * \brief Add a record to the buffer.
+ * \param aRecord The iteration record.
+ */
+void SolverTelemetry::record( const Record& aRecord ) {
+    mBuffer.push_back( aRecord );
+}
+
+/*!
+ * \brief Write the buffered records to the telemetry file.
+ * \details Called once each period has been solved.  A process forked by the
+ *          BatchRunner or server mode writes to its own file with the process
+ *          id appended to the name.
+ */
+void SolverTelemetry::flush() {
+    if( !mIsEnabled || mBuffer.empty() ) {
+        return;
+    }
+
+    const int currProcess = getpid();
+    if( mOwnerProcess != currProcess ) {
+        if( mFile.is_open() ) {
+            mFile.close();
+        }
+        string fileName = mFileName;
+        if( currProcess != sMainProcess ) {
+            stringstream name;
+            name << mFileName << "." << currProcess;
+            fileName = name.str();
+        }
+        mOwnerProcess = currProcess;
+        mFile.open( fileName.c_str(), ios::out | ios::binary | ios::trunc );
+        if( !mFile ) {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Could not open solver telemetry file " << fileName
+                    << ", telemetry is disabled." << endl;
+            mIsEnabled = false;
+            mBuffer.clear();
+            return;
+        }
+        const char tag[] = "GCAMSLV1";
+        const int recordSize = sizeof( Record );
+        mFile.write( tag, strlen( tag ) );
+        mFile.write( reinterpret_cast<const char*>( &recordSize ), sizeof( recordSize ) );
+    }
+
+    mFile.write( reinterpret_cast<const char*>( &mBuffer[ 0 ] ), mBuffer.size() * sizeof( Record ) );
+    mFile.flush();
+    mBuffer.clear();
+}
@@ -0,0 +1,112 @@
+#ifndef _EMULATED_SECANTER_H_
+#define _EMULATED_SECANTER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+ * \file emulated_secanter.h
+ * \ingroup Objects
+ * \brief The EmulatedSecanter class header file.
+ */
+
+#include <vector>
+#include "target_finder/include/itarget_solver.h"
+
+class ITarget;
+
+/*! \brief Target solver which screens candidate trials with a climate response
+ *         emulator fitted online to the completed trials of the current search.
+ * \details The emulator is a linear response of the target status to the log
+ *          of the trial price, fitted by weighted least squares over every
+ *          trial run so far with the most recent trials weighted the heaviest.
+ *          Before each full model run several candidate prices are generated:
+ *          the secant step through the last two trials, a step of the current
+ *          limit in the direction which reduces the status and, once the
+ *          target has been bracketed, the midpoint of the bracket.  Candidates
+ *          outside the bracket are screened out since the completed trials
+ *          already show the target is not met there.  The emulator then
+ *          predicts the status at each remaining candidate price, screens out
+ *          those it does not predict to improve on the current trial and only
+ *          the one predicted closest to the target is run through the full
+ *          model and climate model.  The step limit grows while each trial
+ *          cuts the remaining error sharply and falls back to doubling when it
+ *          does not.  A solution is only accepted on the status reported by the
+ *          real target so the final answer is always confirmed by a full run.
+ */
+class EmulatedSecanter : public ITargetSolver {
+public:
+    EmulatedSecanter( const ITarget* aTarget,
+                      const double aTolerance,
+                      const double aInitialPrice,
+                      const double aInitialValue,
+                      const double aInitialPriceChange,
+                      const int aYear );
+    
+    // ITargetSolver methods
+    std::pair<double, bool> getNextValue();
+    
+    unsigned int getIterations() const;
+private:
+    //! The target.
+    const ITarget* mTarget;
+    
+    //! The tolerance of the target.
+    const double mTolerance;
+    
+    //! Year in which the emulator is operating.
+    const int mYear;
+    
+    //! The current number of trial values returned.
+    unsigned int mIterations;
+    
+    //! The trial price which is currently being run.
+    double mCurrentPrice;
+    
+    //! The largest factor by which the next trial may differ from the last.
+    double mMaxStep;
+    
+    //! The completed trials as log of the price and the real target status.
+    std::vector<std::pair<double, double> > mObservations;
+    
+    bool fitResponse( double& aIntercept, double& aSlope ) const;
+    
+    bool findBracket( double& aLowLogPrice, double& aHighLogPrice ) const;
+    
+    double proposeNextPrice( const double aStatus );
+};
+
+#endif // _EMULATED_SECANTER_H_
@@ -53,6 +53,7 @@ class Timer;
 class TotalPolicyCostCalculator;
 class SingleScenarioRunner;
 class ITarget;
+class ITargetSolver;
 class Modeltime;
 
 /*! 
@@ -110,6 +111,9 @@ class Modeltime;
  *                   (optional) Set the initial target year to the value of the
  *                   year attribute or the last model year if that attribute is
  *                   not specified.
+ *              - \c use-emulator PolicyTargetRunner::mUseEmulator
+ *                   (optional) Propose trials with the EmulatedSecanter so that
+ *                   fewer full model runs are needed. The default is false.
  *
  * \author Josh Lurz
  * \author Pralit Patel
@@ -202,6 +206,10 @@ private:
     //! solve.
     double mMaxTax;
 
+    //! Whether trials should be proposed by the EmulatedSecanter rather than
+    //! the Secanter.
+    bool mUseEmulator;
+
     void
         calculateHotellingPath( const double aIntialTax,
                                 const double aHotellingRate,
@@ -211,6 +219,13 @@ private:
                                 std::vector<double>& aTaxes );
 
     void setTrialTaxes( const std::vector<double> aTaxes );
+
+    ITargetSolver* createTargetSolver( const ITarget* aPolicyTarget,
+                                       const double aTolerance,
+                                       const double aInitialPrice,
+                                       const double aInitialValue,
+                                       const double aInitialPriceChange,
+                                       const int aYear ) const;
     
     bool solveInitialTarget( std::vector<double>& aTaxes,
                              const ITarget* aPolicyTarget,
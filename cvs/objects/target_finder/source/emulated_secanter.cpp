@@ -0,0 +1,326 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+ * \file emulated_secanter.cpp
+ * \ingroup Objects
+ * \brief EmulatedSecanter class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <cassert>
+#include <cmath>
+#include "util/logger/include/ilogger.h"
+#include "target_finder/include/emulated_secanter.h"
+#include "target_finder/include/itarget.h"
+#include "util/base/include/util.h"
+
+using namespace std;
+
+namespace {
+    //! Weight of each trial relative to the one run after it when fitting.
+    const double TRIAL_WEIGHT_DECAY = 0.5;
+    
+    //! Step limit used when the emulator is not yet trusted.
+    const double MIN_STEP = 2.0;
+    
+    //! The largest step limit the emulator may earn.
+    const double MAX_STEP = 8.0;
+    
+    //! The fraction of the previous status a trial must reduce the error to
+    //! for the emulator to be trusted with a larger step.
+    const double TRUSTED_REDUCTION = 0.25;
+}
+
+/*!
+ * \brief Construct the EmulatedSecanter.
+ * \details The initial points are chosen the same way as in the Secanter.  An
+ *          initial price of zero has no log price and so is not used to fit
+ *          the emulator, which is instead seeded from the first trial.
+ * \param aTarget The policy target.
+ * \param aTolerance Solution tolerance.
+ * \param aInitialPrice The initial guess.
+ * \param aInitialValue The solution status of the initial guess.
+ * \param aInitialPriceChange A percentage change from the initial price to come
+ *                            up with the second initial guess.
+ * \param aYear Year to check the solution status in.
+ */
+EmulatedSecanter::EmulatedSecanter( const ITarget* aTarget,
+                                    const double aTolerance,
+                                    const double aInitialPrice,
+                                    const double aInitialValue,
+                                    const double aInitialPriceChange,
+                                    const int aYear ) :
+mTarget( aTarget ),
+mTolerance( aTolerance ),
+mYear( aYear ),
+mIterations( 0 ),
+mMaxStep( MIN_STEP )
+{
+    if( aInitialPrice != 0 ) {
+        mObservations.push_back( make_pair( log( aInitialPrice ), aInitialValue ) );
+    }
+    
+    if( aInitialPrice == 0 ) {
+        mCurrentPrice = aInitialPriceChange + 1;
+    }
+    else if( fabs( aInitialValue ) < mTolerance ) {
+        // Already at the solution
+        mCurrentPrice = aInitialPrice;
+    }
+    else if( aInitialValue > 0 ) {
+        mCurrentPrice = aInitialPrice * ( aInitialPriceChange + 1 );
+    }
+    else {
+        mCurrentPrice = aInitialPrice / ( aInitialPriceChange + 1 );
+    }
+    ILogger& targetLog = ILogger::getLogger( "target_finder_log" );
+    targetLog.setLevel( ILogger::DEBUG );
+    targetLog << "Constructing an EmulatedSecanter. Initial points: " << mCurrentPrice
+              << "; (" << aInitialPrice << ", " << aInitialValue << ")" << endl;
+}
+
+/*! \brief Get the next trial value and check for solution.
+ * \details Adds the status of the trial which was just run to the emulator,
+ *          refits it and returns the price at which it predicts the target
+ *          will be met.
+ * \return A pair representing the next trial value and whether the PolicyTarget
+ *         is solved.
+ */
+pair<double, bool> EmulatedSecanter::getNextValue() {
+    // Get the status of the current trial from the real climate model.
+    const double targetValue = mTarget->getStatus( mYear );
+    
+    ILogger& targetLog = ILogger::getLogger( "target_finder_log" );
+    targetLog.setLevel( ILogger::WARNING );
+    targetLog << "Current trial status is " << targetValue << endl;
+    
+    bool solved = false;
+    if( mIterations == 0 ) {
+        // This is just the first arbitrary guess which has not yet been run
+        targetLog << "Returning initial guess." << endl;
+    }
+    else if( std::isnan( targetValue ) ) {
+        // The climate model failed, likely due to failure to solve.  The trial
+        // tells the emulator nothing so backtrack towards the last good trial,
+        // or a price of zero if there is none, and stop trusting large steps.
+        const double lastGoodPrice = mObservations.empty() ? 0.0 : exp( mObservations.back().first );
+        mCurrentPrice = ( mCurrentPrice - lastGoodPrice ) / 2.0 + lastGoodPrice;
+        mMaxStep = MIN_STEP;
+    }
+    else if( fabs( targetValue ) < mTolerance ) {
+        solved = true;
+    }
+    else {
+        // Widen the step limit only while the emulator keeps cutting the error.
+        if( !mObservations.empty()
+            && fabs( targetValue ) < TRUSTED_REDUCTION * fabs( mObservations.back().second ) )
+        {
+            mMaxStep = min( mMaxStep * 2.0, MAX_STEP );
+        }
+        else {
+            mMaxStep = MIN_STEP;
+        }
+        mObservations.push_back( make_pair( log( mCurrentPrice ), targetValue ) );
+        mCurrentPrice = proposeNextPrice( targetValue );
+    }
+    
+    // Increment the number of trials.
+    ++mIterations;
+    
+    targetLog.setLevel( ILogger::DEBUG );
+    targetLog << ( solved ? "Found solution. " : "Attempting to solve target. Iteration: " );
+    if( !solved ) {
+        targetLog << mIterations << " ";
+    }
+    targetLog << "Emulator trials: " << mObservations.size() << ", step limit: "
+              << mMaxStep << ", next trial: " << mCurrentPrice << endl;
+    
+    assert( util::isValidNumber( mCurrentPrice ) );
+    assert( mCurrentPrice >= 0 );
+    return make_pair( mCurrentPrice, solved );
+}
+
+/*! \brief Get the current number of iterations performed.
+ * \return The current number of iterations performed.
+ */
+unsigned int EmulatedSecanter::getIterations() const {
+    return mIterations;
+}
+
+/*!
+ * \brief Fit the linear response of the status to the log of the price.
+ * \details Weighted least squares over all completed trials where each trial
+ *          has TRIAL_WEIGHT_DECAY times the weight of the one after it.
+ * \param aIntercept The fitted status at a log price of zero.
+ * \param aSlope The fitted change in status per unit of log price.
+ * \return Whether a usable fit could be made.
+ */
+bool EmulatedSecanter::fitResponse( double& aIntercept, double& aSlope ) const {
+    if( mObservations.size() < 2 ) {
+        return false;
+    }
+    
+    double weight = 1.0;
+    double sumWeight = 0.0;
+    double meanX = 0.0;
+    double meanY = 0.0;
+    for( auto it = mObservations.rbegin(); it != mObservations.rend(); ++it ) {
+        sumWeight += weight;
+        meanX += weight * it->first;
+        meanY += weight * it->second;
+        weight *= TRIAL_WEIGHT_DECAY;
+    }
+    meanX /= sumWeight;
+    meanY /= sumWeight;
+    
+    weight = 1.0;
+    double covXY = 0.0;
+    double varX = 0.0;
+    for( auto it = mObservations.rbegin(); it != mObservations.rend(); ++it ) {
+        const double dx = it->first - meanX;
+        covXY += weight * dx * ( it->second - meanY );
+        varX += weight * dx * dx;
+        weight *= TRIAL_WEIGHT_DECAY;
+    }
+    if( varX <= 0.0 ) {
+        return false;
+    }
+    
+    aSlope = covXY / varX;
+    aIntercept = meanY - aSlope * meanX;
+    // A higher tax must lower the status, any other response is noise.
+    return util::isValidNumber( aSlope ) && aSlope < 0.0;
+}
+
+/*!
+ * \brief Find the tightest bracket of the target among the completed trials.
+ * \details A positive status means the price is too low and a negative one that
+ *          it is too high.
+ * \param aLowLogPrice The highest log price with a positive status.
+ * \param aHighLogPrice The lowest log price with a negative status.
+ * \return Whether the target has been bracketed.
+ */
+bool EmulatedSecanter::findBracket( double& aLowLogPrice, double& aHighLogPrice ) const {
+    bool hasLow = false;
+    bool hasHigh = false;
+    for( auto it = mObservations.begin(); it != mObservations.end(); ++it ) {
+        if( it->second > 0.0 && ( !hasLow || it->first > aLowLogPrice ) ) {
+            aLowLogPrice = it->first;
+            hasLow = true;
+        }
+        else if( it->second < 0.0 && ( !hasHigh || it->first < aHighLogPrice ) ) {
+            aHighLogPrice = it->first;
+            hasHigh = true;
+        }
+    }
+    return hasLow && hasHigh && aLowLogPrice < aHighLogPrice;
+}
+
+/*!
+ * \brief Propose the next trial price by screening candidates with the emulator.
+ * \details Generates the candidate log prices described in the class
+ *          documentation, each limited to mMaxStep from the current trial.
+ *          Candidates outside the bracket of the target are discarded.  The
+ *          emulator's predicted status at each remaining candidate price is
+ *          then used to discard candidates which are not predicted to improve
+ *          on the current status and the candidate with the smallest predicted
+ *          status is returned.  The root of the emulator is not a candidate
+ *          since it would always be predicted to meet the target.  Without a
+ *          usable fit, or if every candidate is screened out, the midpoint of
+ *          the bracket is preferred and otherwise the step in the direction
+ *          which reduces the status.
+ * \param aStatus The real status of the current trial.
+ * \return The next trial price.
+ */
+double EmulatedSecanter::proposeNextPrice( const double aStatus ) {
+    const double currLogPrice = mObservations.back().first;
+    const double maxLogStep = log( mMaxStep );
+    
+    // Generate the candidates, the preferred one without a fit comes first.
+    vector<double> candidates;
+    double lowLogPrice;
+    double highLogPrice;
+    const bool isBracketed = findBracket( lowLogPrice, highLogPrice );
+    if( isBracketed ) {
+        candidates.push_back( ( lowLogPrice + highLogPrice ) / 2.0 );
+    }
+    candidates.push_back( aStatus > 0 ? currLogPrice + maxLogStep : currLogPrice - maxLogStep );
+    if( mObservations.size() >= 2 ) {
+        const pair<double, double>& prev = mObservations[ mObservations.size() - 2 ];
+        const double secantSlope = ( aStatus - prev.second ) / ( currLogPrice - prev.first );
+        if( util::isValidNumber( secantSlope ) && secantSlope < 0.0 ) {
+            candidates.push_back( currLogPrice - aStatus / secantSlope );
+        }
+    }
+    double intercept;
+    double slope;
+    const bool hasFit = fitResponse( intercept, slope );
+    
+    // Screen the candidates and keep the one the emulator predicts is closest
+    // to meeting the target.
+    ILogger& targetLog = ILogger::getLogger( "target_finder_log" );
+    targetLog.setLevel( ILogger::DEBUG );
+    double bestLogPrice = max( min( candidates.front(), currLogPrice + maxLogStep ),
+                               currLogPrice - maxLogStep );
+    bool hasFallback = false;
+    double bestPredicted = -1.0;
+    for( auto it = candidates.begin(); it != candidates.end(); ++it ) {
+        const double candidate = max( min( *it, currLogPrice + maxLogStep ),
+                                      currLogPrice - maxLogStep );
+        if( isBracketed && ( candidate <= lowLogPrice || candidate >= highLogPrice ) ) {
+            targetLog << "Screened out candidate " << exp( candidate ) << " outside of the bracket." << endl;
+            continue;
+        }
+        if( !hasFallback ) {
+            // Used if there is nothing to rank by or every candidate is
+            // screened out by the emulator.
+            bestLogPrice = candidate;
+            hasFallback = true;
+        }
+        if( !hasFit ) {
+            continue;
+        }
+        const double predicted = fabs( intercept + slope * candidate );
+        targetLog << "Candidate " << exp( candidate ) << " has predicted status " << predicted << endl;
+        if( predicted >= fabs( aStatus ) ) {
+            targetLog << "Screened out candidate " << exp( candidate ) << " which is not predicted to improve." << endl;
+            continue;
+        }
+        if( bestPredicted < 0.0 || predicted < bestPredicted ) {
+            bestLogPrice = candidate;
+            bestPredicted = predicted;
+        }
+    }
+    return exp( bestLogPrice );
+}
@@ -50,6 +50,7 @@
 #include "target_finder/include/itarget_solver.h"
 #include "target_finder/include/bisecter.h"
 #include "target_finder/include/secanter.h"
+#include "target_finder/include/emulated_secanter.h"
 #include "target_finder/include/itarget.h"
 #include "containers/include/scenario_runner_factory.h"
 #include "util/base/include/configuration.h"
@@ -77,7 +78,8 @@ mHasParsedConfig( false ),
 mRunID( 0 ),
 mNumForwardLooking( 0 ),
 mNumBackwardsLook( 0 ),
-mMaxTax( 4999 )
+mMaxTax( 4999 ),
+mUseEmulator( false )
 {
 }
 
@@ -163,6 +165,9 @@ bool PolicyTargetRunner::XMLParse( const xercesc::DOMNode* aRoot ){
         else if( nodeName == "initial-tax-guess" ) {
             mInitialTaxGuess = XMLHelper<double>::getValue( curr );
         }
+        else if( nodeName == "use-emulator" ) {
+            mUseEmulator = XMLHelper<bool>::getValue( curr );
+        }
         // Handle unknown nodes.
         else {
             ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -428,7 +433,7 @@ bool PolicyTargetRunner::solveInitialTarget( vector<double>& aTaxes,
     const double INCREASE_INCREMENT = mInitialTaxGuess - 1;
     auto_ptr<ITargetSolver> solver;
     
-    solver.reset( new Secanter( aPolicyTarget,
+    solver.reset( createTargetSolver( aPolicyTarget,
                        aTolerance,
                        initialTax,
                        aPolicyTarget->getStatus( mInitialTargetYear ),
@@ -553,7 +558,7 @@ bool PolicyTargetRunner::solveFutureTarget( vector<double>& aTaxes,
                        aTaxes[ aPeriod ],
                        4.0, // Note the hard coded value is the initial bracket interval
                        currYear ) );*/
-    solver.reset( new Secanter( aPolicyTarget,
+    solver.reset( createTargetSolver( aPolicyTarget,
                        aTolerance,
                        aTaxes[ aPeriod ],
                        aPolicyTarget->getStatus( currYear ),
@@ -669,7 +674,7 @@ bool PolicyTargetRunner::skipFuturePeriod( vector<double>& aTaxes,
                                  aTaxes[ aPeriod ],
                                  4.0, // Note the hard coded value is the initial bracket interval
                                  currYear ) );*/
-    solver.reset( new Secanter( aPolicyTarget,
+    solver.reset( createTargetSolver( aPolicyTarget,
                                 aTolerance,
                                 aTaxes[ aPeriod ],
                                 aPolicyTarget->getStatus( currYear ),
@@ -819,6 +824,27 @@ void PolicyTargetRunner::setTrialTaxes( const vector<double> aTaxes ) {
     mSingleScenario->getInternalScenario()->setTax( &tax );
 }
 
+/*!
+ * \brief Create the solver used to search for a single target.
+ * \details Creates an EmulatedSecanter if the user requested the emulator and a
+ *          Secanter otherwise.  The arguments are passed through to the solver.
+ * \return A new solver which the caller is responsible for deleting.
+ */
+ITargetSolver* PolicyTargetRunner::createTargetSolver( const ITarget* aPolicyTarget,
+                                                       const double aTolerance,
+                                                       const double aInitialPrice,
+                                                       const double aInitialValue,
+                                                       const double aInitialPriceChange,
+                                                       const int aYear ) const
+{
+    if( mUseEmulator ) {
+        return new EmulatedSecanter( aPolicyTarget, aTolerance, aInitialPrice,
+                                     aInitialValue, aInitialPriceChange, aYear );
+    }
+    return new Secanter( aPolicyTarget, aTolerance, aInitialPrice,
+                         aInitialValue, aInitialPriceChange, aYear );
+}
+
 /*!
  * \brief Write a unique identifier into each of several log files
  */
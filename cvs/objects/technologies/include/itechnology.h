@@ -65,6 +65,7 @@ class Demographic;
 class IOutput;
 class IInput;
 class IDiscreteChoice;
+struct TechnologyCalcData;
 
 // Need to forward declare the subclasses as well.
 class Technology;
@@ -144,6 +145,15 @@ public:
     virtual double calcShare( const IDiscreteChoice* aChoiceFn,
                               const GDP* aGDP,
                               int aPeriod ) const = 0;
+
+    /*!
+     * \brief Fill in the data the subsector share and price calculations read
+     *        for this technology in the given period.
+     * \param aPeriod Model period.
+     * \param aData The data to fill in.
+     * \sa TechnologyCalcData
+     */
+    virtual void initCalcData( const int aPeriod, TechnologyCalcData& aData ) const = 0;
     
     virtual void calcCost( const std::string& aRegionName,
                            const std::string& aSectorName,
@@ -48,6 +48,7 @@
 #include <map>
 #include <xercesc/dom/DOMNode.hpp>
 #include "technologies/include/itechnology_container.h"
+#include "util/base/include/xml_fragment.h"
 
 /*! 
  * \ingroup Objects
@@ -72,9 +73,10 @@
  *                        this stub-technology tab may interpolate a technology
  *                        in order to parse then data.
  *          - Elements:
- *              Any XML what so ever.  These elements will be kept around and will
- *              not be parsed until completeInit by the local copy of the global
- *              technology.  This means that parsing error will occur at that time.
+ *              Any XML what so ever.  These elements will be kept around in a
+ *              compact form and will not be parsed until completeInit by the
+ *              local copy of the global technology.  This means that parsing
+ *              error will occur at that time.
  *
  * \author Pralit Patel
  */
@@ -142,10 +144,10 @@ private:
     ITechnologyContainer* mTechnology;
     
     //! The vector of XML modifications to make to the global technology
-    std::vector<const xercesc::DOMNode*> mXMLAdjustments;
+    std::vector<XMLFragment> mXMLAdjustments;
     
     // typdef to help simplify code
-    typedef std::vector<const xercesc::DOMNode*>::const_iterator CXMLIterator;
+    typedef std::vector<XMLFragment>::const_iterator CXMLIterator;
 };
 
 #endif // _STUB_TECHNOLOGY_CONTAINER_H_
@@ -196,6 +196,8 @@ public:
     virtual double calcShare( const IDiscreteChoice* aChoiceFn,
                               const GDP* aGDP,
                               int aPeriod ) const;
+
+    virtual void initCalcData( const int aPeriod, TechnologyCalcData& aData ) const;
     
     virtual void calcCost( const std::string& aRegionName,
                            const std::string& aSectorName,
@@ -0,0 +1,131 @@
+#ifndef _TECHNOLOGY_CALC_DATA_H_
+#define _TECHNOLOGY_CALC_DATA_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file technology_calc_data.h
+* \ingroup Objects
+* \brief The TechnologyCalcData struct header file.
+*/
+
+#include <limits>
+#include "technologies/include/itechnology.h"
+#include "functions/include/idiscrete_choice.hpp"
+#include "util/base/include/value.h"
+
+/*!
+* \ingroup Objects
+* \brief The few fields of a new vintage technology which the subsector share
+*        and price calculations read every iteration.
+* \details A Technology spreads these over its production state, its inputs
+*          and several period vectors so that calculating a subsector's shares
+*          touches many cache lines per technology.  Sector gathers one of these
+*          per technology container of all of its subsectors into a single
+*          contiguous block at initCalc, in subsector order, which the
+*          subsectors then index directly.  Values which may change during
+*          the period are referenced rather than copied.  Since they are
+*          STATE values this reads them from the state of the calculation in
+*          progress, including partial derivative calculations which may run
+*          concurrently or skip recalculating the costs.
+* \sa ITechnology::initCalcData
+*/
+struct TechnologyCalcData {
+    //! The technology, used for anything not in this data.
+    const ITechnology* mTechnology;
+
+    //! The cost of the technology in the period.
+    const Value* mCost;
+
+    //! The share-weight of the technology.
+    const Value* mShareWeight;
+
+    //! Whether the share can be calculated from this data, otherwise
+    //! ITechnology::calcShare must be used.
+    bool mIsShareFromData;
+
+    //! Whether the technology may have a share, that is it is operating new
+    //! investment without fixed output.
+    bool mCanShare;
+
+    //! Whether the technology has a non-zero fuel preference elasticity which
+    //! depends on its input coefficients and so must be recalculated.
+    bool mHasFuelPrefElasticity;
+
+    TechnologyCalcData():
+    mTechnology( 0 ),
+    mCost( 0 ),
+    mShareWeight( 0 ),
+    mIsShareFromData( false ),
+    mCanShare( false ),
+    mHasFuelPrefElasticity( false )
+    {
+    }
+
+    //! Get the cost of the technology.
+    double getCost( const int aPeriod ) const {
+        return mCost ? *mCost : mTechnology->getCost( aPeriod );
+    }
+
+    /*!
+     * \brief Calculate the log of the unnormalized share of the technology.
+     * \details Equivalent to Technology::calcShare.
+     * \param aChoiceFn The discrete choice function of the subsector.
+     * \param aGDP The regional GDP.
+     * \param aLogScaledGDPPerCap The log of the scaled GDP per capita which is
+     *                            only needed with a fuel preference elasticity.
+     * \param aPeriod Model period.
+     * \return The log of the unnormalized share.
+     */
+    double calcShare( const IDiscreteChoice* aChoiceFn, const GDP* aGDP,
+                      const double aLogScaledGDPPerCap, const int aPeriod ) const
+    {
+        if( !mIsShareFromData ) {
+            return mTechnology->calcShare( aChoiceFn, aGDP, aPeriod );
+        }
+        if( !mCanShare ) {
+            return -std::numeric_limits<double>::infinity();
+        }
+        double logshare = aChoiceFn->calcUnnormalizedShare( *mShareWeight, *mCost, aPeriod );
+        if( mHasFuelPrefElasticity ) {
+            logshare += mTechnology->calcFuelPrefElasticity( aPeriod ) * aLogScaledGDPPerCap;
+        }
+        return logshare;
+    }
+};
+
+#endif // _TECHNOLOGY_CALC_DATA_H_
@@ -53,6 +53,7 @@
 #include "util/base/include/ivisitor.h"
 #include "containers/include/market_dependency_finder.h"
 #include "sectors/include/sector_utils.h"
+#include "technologies/include/technology_calc_data.h"
 
 using namespace std;
 using namespace xercesc;
@@ -386,6 +387,18 @@ double AgProductionTechnology::calcShare( const IDiscreteChoice* aChoiceFn,
     return 0.0;
 }
 
+/*!
+ * \brief Fill in the data the subsector share and price calculations read.
+ * \details Ag production technologies override calcShare so the share must
+ *          not be calculated from the data.
+ * \param aPeriod Model period.
+ * \param aData The data to fill in.
+ */
+void AgProductionTechnology::initCalcData( const int aPeriod, TechnologyCalcData& aData ) const {
+    Technology::initCalcData( aPeriod, aData );
+    aData.mIsShareFromData = false;
+}
+
 
 /* agTechnologies are not shared on cost, so this calCost method is overwritten
    by a calculation of technology profit which is passed to the land allocator
@@ -43,6 +43,7 @@
 #include <string>
 #include <cassert>
 #include "technologies/include/empty_technology.h"
+#include "technologies/include/technology_calc_data.h"
 
 using namespace std;
 using namespace xercesc;
@@ -113,6 +114,11 @@ double EmptyTechnology::calcShare( const IDiscreteChoice* aChoiceFn,
     return -numeric_limits<double>::infinity();
 }
 
+void EmptyTechnology::initCalcData( const int aPeriod, TechnologyCalcData& aData ) const {
+    aData = TechnologyCalcData();
+    aData.mTechnology = this;
+}
+
 double EmptyTechnology::getFixedOutput( const string& aRegionName,
                                   const string& aSectorName,
                                   const bool aHasRequiredInput,
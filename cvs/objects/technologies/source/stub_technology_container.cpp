@@ -41,6 +41,7 @@
 #include <string>
 #include <cassert>
 #include <xercesc/dom/DOMNodeList.hpp>
+#include <xercesc/dom/DOMImplementation.hpp>
 
 #include "technologies/include/stub_technology_container.h"
 #include "technologies/include/global_technology_database.h"
@@ -64,8 +65,6 @@ StubTechnologyContainer::StubTechnologyContainer()
 //! Destructor
 StubTechnologyContainer::~StubTechnologyContainer() {
     delete mTechnology;
-    
-    // Note the XML adjustments's memory will be managed by their document.
 }
 
 
@@ -89,11 +88,11 @@ bool StubTechnologyContainer::XMLParse( const DOMNode* aNode ) {
     // get the name attribute.
     mName = XMLHelper<string>::getAttr( aNode, XMLHelper<void>::name() );
     
-    // store the XML for later processing
+    // store a compact copy of the XML for later processing
     /*!
      * \warning This may shift some parsing errors to completeInit.
      */
-    mXMLAdjustments.push_back( XMLHelper<void>::getDOMDocument()->importNode( aNode, true ) );
+    mXMLAdjustments.push_back( XMLFragment( aNode ) );
     
     return true;
 }
@@ -125,27 +124,33 @@ void StubTechnologyContainer::completeInit( const string& aRegionName,
     }
     
     // Make the XML adjustments note that this may produce parsing errors.
+    // The adjustments are recreated in a scratch document which is released
+    // as soon as they have been parsed.
+    DOMDocument* adjustmentDoc = DOMImplementation::getImplementation()->createDocument();
     vector<const DOMNode*> interpolateThenParse;
     // First parse XML that does not require interpolation.
     for( CXMLIterator xmlIter = mXMLAdjustments.begin(); xmlIter != mXMLAdjustments.end(); ++xmlIter ) {
-        if( !XMLHelper<bool>::getAttr( *xmlIter, "allow-interpolate" ) ) {
+        const DOMNode* adjustment = xmlIter->createDOMNode( adjustmentDoc );
+        if( !XMLHelper<bool>::getAttr( adjustment, "allow-interpolate" ) ) {
             // This XML does not need to intperolate
-            mTechnology->XMLParse( *xmlIter );
+            mTechnology->XMLParse( adjustment );
         }
         else {
             // Store this XML until all XML which did not need to parse has
             // finished.
-            interpolateThenParse.push_back( *xmlIter );
+            interpolateThenParse.push_back( adjustment );
         }
     }
-    // now that the XML adjustments are parsed no need to keep them around any longer
-    // Note the XML adjustments's memory will be managed by their document.
-    mXMLAdjustments.clear();
+    // now that the XML adjustments are recreated no need to keep them around any longer
+    vector<XMLFragment>().swap( mXMLAdjustments );
     
     // Next interpolate and parse XML that was tagged to allow interpolation.
-    for( CXMLIterator xmlIter = interpolateThenParse.begin(); xmlIter != interpolateThenParse.end(); ++xmlIter ) {
+    for( vector<const DOMNode*>::const_iterator xmlIter = interpolateThenParse.begin();
+         xmlIter != interpolateThenParse.end(); ++xmlIter )
+    {
         mTechnology->interpolateAndParse( *xmlIter );
     }
+    adjustmentDoc->release();
     
     // Now call complete init on the completed technology.  Note any other interpolations
     // which need to occur will happen here.
@@ -91,6 +91,7 @@
 #include "marketplace/include/marketplace.h"
 
 #include "util/base/include/initialize_tech_vector_helper.hpp"
+#include "technologies/include/technology_calc_data.h"
 
 using namespace std;
 using namespace xercesc;
@@ -820,6 +821,36 @@ double Technology::calcShare( const IDiscreteChoice* aChoiceFn,
     return logshare;
 }
 
+/*!
+ * \brief Fill in the data the subsector share and price calculations read
+ *        for this technology.
+ * \details Whether the technology may have a share and whether it has a fuel
+ *          preference elasticity are fixed for the period once initCalc has
+ *          set the production state, while the cost and share-weight are
+ *          referenced since they may change during the period.
+ * \param aPeriod Model period.
+ * \param aData The data to fill in.
+ * \sa Technology::calcShare
+ */
+void Technology::initCalcData( const int aPeriod, TechnologyCalcData& aData ) const {
+    aData.mTechnology = this;
+    aData.mCost = &mCosts[ aPeriod ];
+    aData.mShareWeight = &mShareWeight;
+    aData.mIsShareFromData = true;
+    aData.mCanShare = mProductionState[ aPeriod ] && mProductionState[ aPeriod ]->isOperating() &&
+                      mProductionState[ aPeriod ]->isNewInvestment() &&
+                      mFixedOutput == IProductionState::fixedOutputDefault();
+
+    // The fuel preference elasticity is only non-zero if an energy input has an
+    // income elasticity.
+    aData.mHasFuelPrefElasticity = false;
+    for( CInputIterator i = mInputs.begin(); i != mInputs.end(); ++i ){
+        if( (*i)->hasTypeFlag( IInput::ENERGY ) && (*i)->getIncomeElasticity( aPeriod ) != 0 ){
+            aData.mHasFuelPrefElasticity = true;
+        }
+    }
+}
+
 /*! \brief Return true if technology is fixed for no output or input
 * 
 * returns true if this technology is set to never produce output or input
@@ -972,9 +1003,13 @@ void Technology::calcEmissionsAndOutputs( const string& aRegionName,
         mOutputs[ i ]->setPhysicalOutput( aPrimaryOutput, aRegionName, mCaptureComponent, aPeriod );
     }
 
-    // calculate emissions for each gas after setting input and output amounts
+    // calculate emissions for each gas after setting input and output amounts,
+    // gases which can not affect the solution are skipped while solving unless
+    // they may be captured and so add to a storage market
     for( unsigned int i = 0; i < mGHG.size(); ++i ) {
-        mGHG[ i ]->calcEmission( aRegionName, mInputs, mOutputs, aGDP, mCaptureComponent, aPeriod );
+        if( mCaptureComponent || mGHG[ i ]->isSolutionEmission() ) {
+            mGHG[ i ]->calcEmission( aRegionName, mInputs, mOutputs, aGDP, mCaptureComponent, aPeriod );
+        }
     }
 }
 
@@ -307,9 +307,11 @@ void UnmanagedLandTechnology::calcEmissionsAndOutputs( const string& aRegionName
     double landArea = mProductLeaf->getLandAllocation( mLandItemName, aPeriod );
     ( *mResourceInput )->setPhysicalDemand( landArea, aRegionName, aPeriod );
 
-    // calculate emissions for each gas
+    // calculate emissions for each gas which may affect the solution
     for ( unsigned int i = 0; i < mGHG.size(); ++i ) {
-        mGHG[ i ]->calcEmission( aRegionName, mInputs , mOutputs, aGDP, mCaptureComponent, aPeriod );
+        if( mCaptureComponent || mGHG[ i ]->isSolutionEmission() ) {
+            mGHG[ i ]->calcEmission( aRegionName, mInputs , mOutputs, aGDP, mCaptureComponent, aPeriod );
+        }
     }
 }
 
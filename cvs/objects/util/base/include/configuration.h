@@ -51,6 +51,7 @@
 #include <map>
 #include <list>
 #include <memory>
+#include <utility>
 #include "util/base/include/iparsable.h"
 
 class Tabs;
@@ -84,6 +85,9 @@ public:
 	int getInt( const std::string& key, const int defaultValue = 0, const bool mustExist = true ) const;
 	double getDouble( const std::string& key, const double defaultValue = 0, const bool mustExist = true ) const;
     const std::list<std::string>& getScenarioComponents() const;
+    const std::list<std::pair<std::string, double> >& getParameterValues() const;
+    void addParameterValue( const std::string& aPath, const double aValue );
+    void appendScnToAllFiles( const std::list<std::string>& aSharedKeys );
 private:
     const std::string mLogFile; //!< The name of the log to use.
     static std::auto_ptr<Configuration> gInstance; //!< The static instance of the Configuration class.
@@ -98,6 +102,8 @@ private:
 	std::map<std::string, int> intMap;  //!< A map of the ints the program uses.
 	std::map<std::string, double> doubleMap;  //!< A map of the doubles the program uses.
     std::list<std::string> scenarioComponents; //!< An ordered list of add-on files. 
+    //! An ordered list of parameter paths and the values to set into them.
+    std::list<std::pair<std::string, double> > mParameterValues;
 	Configuration();
 
 	//! Private undefined constructor to prevent a programmer from creating a second object.
@@ -0,0 +1,143 @@
+#ifndef _COPY_ON_WRITE_H_
+#define _COPY_ON_WRITE_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file copy_on_write.h
+* \ingroup Util
+* \brief The objects::CopyOnWrite class header file.
+* \author Pralit Patel
+*/
+
+#include <memory>
+#include <cassert>
+
+namespace objects {
+    /*!
+     * \brief Copies a parameter block with its copy constructor.
+     */
+    template<class T>
+    struct CopyConstructClone {
+        T* operator()( const T& aValue ) const {
+            return new T( aValue );
+        }
+    };
+
+    /*!
+     * \brief Copies a parameter block with its clone member function, for
+     *        classes which do not define a deep copy constructor.
+     */
+    template<class T>
+    struct CloneMethodClone {
+        T* operator()( const T& aValue ) const {
+            return aValue.clone();
+        }
+    };
+
+    /*!
+     * \ingroup Util
+     * \brief A parameter block which is shared between copies of the object
+     *        holding it until one of those copies changes it.
+     * \details Technologies are cloned for each region from the global technology
+     *          database and again for each vintage so parameters which are only set
+     *          while parsing end up duplicated many thousands of times.  Copies of a
+     *          CopyOnWrite instead share a single reference counted block.  Reading
+     *          never copies while getMutable makes a private copy first if the block
+     *          is shared, so that for instance a regional override of a global
+     *          technology is not seen by the global technology or other regions.
+     * \tparam T The type of the parameter block.
+     * \tparam Clone A functor which creates a deep copy of a T.
+     */
+    template<class T, class Clone = CopyConstructClone<T> >
+    class CopyOnWrite {
+    public:
+        /*!
+         * \brief Constructor.
+         * \param aValue The initial parameter block which this object takes
+         *        ownership of.
+         */
+        explicit CopyOnWrite( T* aValue ):
+        mValue( aValue )
+        {
+            assert( aValue );
+        }
+
+        //! Read only access which never copies.
+        const T& operator*() const {
+            return *mValue;
+        }
+
+        //! Read only access which never copies.
+        const T* operator->() const {
+            return mValue.get();
+        }
+
+        /*!
+         * \brief Get write access, first making a private copy of the
+         *        parameter block if it is shared with any other copy.
+         * \return The parameter block which only this object references.
+         */
+        T& getMutable() {
+            if( mValue.use_count() > 1 ) {
+                mValue.reset( Clone()( *mValue ) );
+            }
+            return *mValue;
+        }
+
+        /*!
+         * \brief Get a mutable pointer to the parameter block without unsharing it.
+         * \details This exists only for the data definitions which require a raw
+         *          pointer.  Writing through it changes every copy.
+         * \return The possibly shared parameter block.
+         */
+        T* getSharedPointer() const {
+            return mValue.get();
+        }
+
+        //! Whether the parameter block is currently shared with another copy.
+        bool isShared() const {
+            return mValue.use_count() > 1;
+        }
+
+    private:
+        //! The parameter block, potentially shared with other copies.
+        std::shared_ptr<T> mValue;
+    };
+}
+
+#endif // _COPY_ON_WRITE_H_
@@ -62,6 +62,8 @@ public:
     virtual void startVisitWorld( const World* aWorld, const int aPeriod ){}
     virtual void endVisitWorld( const World* aWorld, const int aPeriod ){}
 
+    virtual bool visitRegions( const std::vector<Region*>& aRegions, const int aPeriod ){ return false; }
+
     virtual void startVisitRegion( const Region* aRegion, const int aPeriod ){}
     virtual void endVisitRegion( const Region* aRegion, const int aPeriod ){}
 
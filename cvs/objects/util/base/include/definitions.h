@@ -67,6 +67,13 @@
 #define USE_HECTOR 1
 #endif
 
+//! The number of model periods a PeriodVector will store directly within its
+//! enclosing object.  Models which define more periods than this will still
+//! work however their PeriodVectors will be allocated on the heap.
+#ifndef PERIOD_VECTOR_INLINE_SIZE
+#define PERIOD_VECTOR_INLINE_SIZE 22
+#endif
+
 // This allows for memory leak debugging.
 #if defined(_MSC_VER)
 #   ifdef _DEBUG
@@ -45,6 +45,7 @@
 */
 
 #include <string>
+#include <vector>
 
 class World;
 class Region;
@@ -131,6 +132,16 @@ public:
     virtual void startVisitWorld( const World* aWorld, const int aPeriod ) = 0;
     virtual void endVisitWorld( const World* aWorld, const int aPeriod ) = 0;
 
+    /*!
+     * \brief Give the visitor the chance to visit all of the regions of the
+     *        world itself, for instance to visit them concurrently.
+     * \param aRegions The regions of the world in order.
+     * \param aPeriod The period being visited.
+     * \return Whether the regions were visited, if not the world will visit
+     *         them in order.
+     */
+    virtual bool visitRegions( const std::vector<Region*>& aRegions, const int aPeriod ) = 0;
+
     virtual void startVisitRegion( const Region* aRegion, const int aPeriod ) = 0;
     virtual void endVisitRegion( const Region* aRegion, const int aPeriod ) = 0;
 
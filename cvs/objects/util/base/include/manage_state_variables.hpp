@@ -45,13 +45,21 @@
 
 #include <cassert>
 #include <forward_list>
+#include <memory>
 #include <string>
+#include <cstdint>
 #include "util/base/include/definitions.h"
 
 class Value;
+class Market;
 
 #if GCAM_PARALLEL_ENABLED
 #include <tbb/task_arena.h>
+#include <tbb/task_scheduler_observer.h>
+#include <tbb/spin_mutex.h>
+#include <map>
+#include <thread>
+#include <vector>
 #endif
 
 /*!
@@ -70,6 +78,7 @@ class Value;
  * \author Pralit Patel
  */
 class ManageStateVariables {
+    friend struct AssignThreadStateFun;
 public:
     ManageStateVariables( const int aPeriod );
     ~ManageStateVariables();
@@ -78,6 +87,24 @@ public:
     
     void setPartialDeriv( const bool aIsPartialDeriv );
     
+    /*!
+     * \brief The positions of the price, solver demand, and solver supply of a
+     *        market within each state slot.
+     * \details The solver can use these to read and write the market directly
+     *          in the slot returned by getActiveState() instead of going through
+     *          the Market accessors.  Note the supply index may equal the price
+     *          index for markets whose solver supply is their price.
+     */
+    struct MarketStateIndices {
+        unsigned int mPrice;
+        unsigned int mDemand;
+        unsigned int mSupply;
+    };
+    
+    MarketStateIndices getMarketStateIndices( const Market* aMarket ) const;
+    
+    double* getActiveState() const;
+    
 #if GCAM_PARALLEL_ENABLED
     //! A tbb task arena which is the closest tbb comes to a thread pool which we
     //! will insist parallel calculations use so that we can ensure that we have
@@ -87,6 +114,32 @@ public:
 #endif
     
 private:
+#if GCAM_PARALLEL_ENABLED
+    //! When "numa-aware-state" is set, pins each worker in mThreadPool to a CPU
+    //! interleaved across the NUMA nodes.  Declared after mThreadPool so that
+    //! it stops observing before the arena is destroyed.
+    std::unique_ptr<tbb::task_scheduler_observer> mAffinityObserver;
+    
+    //! When NUMA aware, the "scratch" slot each thread was last assigned.
+    std::map<std::thread::id, int> mPreferredSlot;
+    
+    //! When NUMA aware, which "scratch" slots have been assigned to a thread
+    //! in the current partial derivative calculation.
+    std::vector<bool> mIsSlotAssigned;
+    
+    //! Guards mPreferredSlot and mIsSlotAssigned.
+    tbb::spin_mutex mSlotMutex;
+#endif
+    
+    //! Whether the "scratch" slots are allocated and first touched by the
+    //! worker they are assigned to, and kept by that worker when possible, so
+    //! that they live on its NUMA node.  Set from "numa-aware-state".
+    bool mIsNumaAware;
+    
+    //! Whether the state slots are allocated aligned to huge pages and advised
+    //! to use transparent huge pages.  Set from "state-huge-pages".
+    bool mUseHugePages;
+    
     //! The actual home of all state data.  This is a two dimensional array where
     //! the first is by state the second is for each GCAM Data marketed as STATE.
     //! Note the first state is the "base" state and the rest are "scratch" for
@@ -121,8 +174,18 @@ private:
     //! - When we are done with this period copy the "base" state back into each Value.
     std::forward_list<Value*> mStateValues;
     
+    //! A hash of the layout of the state slots which is written to restart
+    //! files so that a file written with a different layout is rejected.
+    uint64_t mLayoutHash;
+    
     void collectState();
     
+    double* allocateStateSlot() const;
+    
+    void freeStateSlot( double* aSlot ) const;
+    
+    void orderSolvableMarketsFirst();
+    
     void resetState();
     
     std::string getRestartFileName() const;
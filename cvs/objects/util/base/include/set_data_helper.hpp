@@ -0,0 +1,140 @@
+#ifndef _SET_DATA_HELPER_HPP_
+#define _SET_DATA_HELPER_HPP_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+ * \file set_data_helper.hpp
+ * \ingroup util
+ * \brief SetDataHelper class header file.
+ */
+
+#include <list>
+#include <string>
+#include <vector>
+#include <utility>
+
+class Scenario;
+class MACControl;
+struct FilterStep;
+
+/*!
+ * \ingroup util
+ * \brief A utility to directly set parameter values in the model given a list
+ *        of paths to the data and the values to set.
+ * \details Each path uses the search string syntax parsed by parseFilterString
+ *          and starts from the Scenario, for instance:
+ *          world/region[NamedFilter,StringEquals,USA]/sector[NamedFilter,StringEquals,electricity]/discrete-choice-function/logit-exponent[YearFilter,IntEquals,2020]
+ *          The paths are parsed into FilterSteps once when added and run then
+ *          uses GCAMFusion to find and set all double and Value data which
+ *          match each of them.  A path which can not be parsed or which does
+ *          not match any data is an error as the run would silently not be
+ *          the one the user asked for.  An ARRAY which is matched without a filter has
+ *          every element set.  This gives the same result as an add-on XML file
+ *          which sets the same values while avoiding the cost of building and
+ *          parsing a DOM and so is well suited to parameter sweeps.
+ *
+ *          Values are meant to be set after all of the XML inputs have been
+ *          parsed and before Scenario::completeInit.  Note that data in a
+ *          objects::TechVintageVector is not sized until completeInit and so
+ *          can not be set by this utility.  A MAC curve is shared between
+ *          copies of a MACControl so a private copy is made before any of its
+ *          points are set.
+ */
+class SetDataHelper {
+public:
+    SetDataHelper( const std::list<std::pair<std::string, double> >& aParameterValues );
+    ~SetDataHelper();
+
+    bool addParameterValue( const std::string& aPath, const double aValue );
+
+    bool parseCSV( const std::string& aFileName );
+
+    bool run( Scenario* aScenario );
+
+    static bool isCSVFile( const std::string& aFileName );
+
+    static bool readCSV( const std::string& aFileName,
+                         std::list<std::pair<std::string, double> >& aParameterValues );
+
+    // GCAMFusion callbacks
+    template<typename DataType>
+    void processData( DataType& aData );
+    template<typename DataType>
+    void pushFilterStep( const DataType& aData );
+    template<typename DataType>
+    void popFilterStep( const DataType& aData );
+
+private:
+    //! A parameter path already parsed into FilterSteps and the value to set.
+    struct ParameterValue {
+        //! The path as given by the user for reporting.
+        std::string mPath;
+
+        //! The parsed path which this struct owns.
+        std::vector<FilterStep*> mFilterSteps;
+
+        //! The value to set into all of the matching data.
+        double mValue;
+    };
+
+    //! The parameters to set in the order they were added.
+    std::vector<ParameterValue*> mParameterValues;
+
+    //! Whether a parameter path could not be parsed.
+    bool mHasInvalidPath;
+
+    //! The value of the parameter currently being set by GCAMFusion.
+    double mCurrValue;
+
+    //! The number of values set for the current parameter.
+    int mNumSet;
+
+    //! The MACControl currently stepped into if any, which must unshare its
+    //! curve before the points in it are set.
+    MACControl* mCurrMACControl;
+
+    template<typename ArrayType>
+    void setArray( ArrayType& aArray );
+
+    // Undefined copy constructor and assignment since this class owns the
+    // FilterSteps.
+    SetDataHelper( const SetDataHelper& );
+    SetDataHelper& operator=( const SetDataHelper& );
+};
+
+#endif // _SET_DATA_HELPER_HPP_
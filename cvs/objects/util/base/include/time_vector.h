@@ -157,6 +157,8 @@ namespace objects {
         iterator last();
         typedef T value_type;
     protected:
+        TimeVectorBase( T* aData, const unsigned int aSize );
+
         //! Dynamic array containing the data.
         T* mData;
 
@@ -183,6 +185,20 @@ namespace objects {
             init( aSize, aDefaultValue );
     }
 
+    /*!
+     * \brief Constructor which adopts storage already set up by a derived class.
+     * \details The storage is assumed to already hold aSize constructed
+     *          values.  A derived class which does not allocate aData with
+     *          new[] must reset mData before this class is destroyed.
+     * \param aData The array of values.
+     * \param aSize Size of the TimeVectorBase.
+     */
+    template<class T>
+        TimeVectorBase<T>::TimeVectorBase( T* aData, const unsigned int aSize )
+        :mData( aData ), mSize( aSize )
+    {
+    }
+
     /*!
      * \brief Destructor which deallocates the array.
      */
@@ -535,14 +551,37 @@ namespace objects {
         using TimeVectorBase<T>::assign;
 
         PeriodVector( const T aDefaultValue = T() );
+        PeriodVector( const PeriodVector& aOther );
+        virtual ~PeriodVector();
+        PeriodVector& operator=( const PeriodVector& aOther );
         virtual T& operator[]( const size_t aIndex );
         virtual const T& operator[]( const size_t aIndex ) const;
     protected:
         // Declare that this class is using the base class data and size.
         using TimeVectorBase<T>::mData;
         using TimeVectorBase<T>::mSize;
+
+        //! Storage for the values kept directly in the enclosing object which
+        //! is used whenever the number of periods fits.
+        T mInlineData[ PERIOD_VECTOR_INLINE_SIZE ];
+
+        static T* getStorage( T* aInlineData, const size_t aSize );
     };
 
+    /*!
+     * \brief Get the storage to use for a vector with the given size.
+     * \details The inline storage is used when it is large enough, otherwise
+     *          a new array is allocated which will be deleted by the
+     *          TimeVectorBase.
+     * \param aInlineData The inline storage of the PeriodVector.
+     * \param aSize The number of values needed.
+     * \return The storage to use.
+     */
+    template<class T>
+        T* PeriodVector<T>::getStorage( T* aInlineData, const size_t aSize ) {
+            return aSize <= PERIOD_VECTOR_INLINE_SIZE ? aInlineData : new T[ aSize ];
+        }
+
     /*!
      * \brief Constructor which sizes the vector to the number of periods in the
      *        model.
@@ -552,11 +591,58 @@ namespace objects {
      */
     template<class T>
         PeriodVector<T>::PeriodVector( const T aDefaultValue )
-        :TimeVectorBase<T>( scenario->getModeltime()->getmaxper(),
-                            aDefaultValue )
+        :TimeVectorBase<T>( getStorage( mInlineData, scenario->getModeltime()->getmaxper() ),
+                            scenario->getModeltime()->getmaxper() )
+    {
+        std::fill( mData, mData + mSize, aDefaultValue );
+    }
+
+    /*!
+     * \brief Copy constructor.
+     * \param aOther PeriodVector to copy.
+     */
+    template<class T>
+        PeriodVector<T>::PeriodVector( const PeriodVector<T>& aOther )
+        :TimeVectorBase<T>( getStorage( mInlineData, aOther.mSize ), aOther.mSize )
     {
+        std::copy( aOther.begin(), aOther.end(), begin() );
     }
 
+    /*!
+     * \brief Destructor.
+     * \details Detaches the inline storage so that the TimeVectorBase only
+     *          deletes storage which was allocated on the heap.
+     */
+    template<class T>
+        PeriodVector<T>::~PeriodVector() {
+            if( mData == mInlineData ) {
+                mData = 0;
+            }
+        }
+
+    /*!
+     * \brief Assignment operator.
+     * \details Values are copied in place, storage is only replaced in the
+     *          unlikely event the sizes differ.
+     * \param aOther PeriodVector to copy.
+     * \return This PeriodVector by reference(for chaining assignment).
+     */
+    template<class T>
+        PeriodVector<T>& PeriodVector<T>::operator=( const PeriodVector<T>& aOther ) {
+            // Check for self-assignment.
+            if( this != &aOther ) {
+                if( mSize != aOther.mSize ) {
+                    if( mData != mInlineData ) {
+                        delete[] mData;
+                    }
+                    mSize = aOther.mSize;
+                    mData = getStorage( mInlineData, mSize );
+                }
+                std::copy( aOther.begin(), aOther.end(), begin() );
+            }
+            return *this;
+        }
+
     /*!
      * \brief Operator which references data in the array.
      * \param aIndex Index of the value to return.
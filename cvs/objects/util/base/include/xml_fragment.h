@@ -0,0 +1,109 @@
+#ifndef _XML_FRAGMENT_H_
+#define _XML_FRAGMENT_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file xml_fragment.h
+* \ingroup Objects
+* \brief The XMLFragment class header file.
+* \author Pralit Patel
+*/
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <xercesc/dom/DOMNode.hpp>
+#include <xercesc/dom/DOMDocument.hpp>
+
+/*! 
+* \ingroup Objects
+* \brief A compact copy of an XML subtree which must be parsed after the
+*        document it came from has been released.
+* \details The nodes are stored in document order with interned element and
+*          attribute names and their attribute values and text held as plain
+*          strings.  This is much smaller than importing the subtree into a
+*          retained DOMDocument and the fragment may be released as soon as it
+*          has been parsed.  Since the model objects parse from DOM nodes the
+*          subtree is recreated in a scratch document with createDOMNode when
+*          it is finally needed.
+*
+* \author Pralit Patel
+*/
+class XMLFragment {
+public:
+    explicit XMLFragment( const xercesc::DOMNode* aNode );
+
+    xercesc::DOMNode* createDOMNode( xercesc::DOMDocument* aDocument ) const;
+
+private:
+    //! A single element or text node of the fragment.
+    struct Node {
+        //! Index of the node name in the interned names.
+        unsigned short mName;
+
+        //! The number of attributes, which are stored after those of the
+        //! preceding nodes.
+        unsigned short mNumAttributes;
+
+        //! The number of nodes in the subtree below this node which
+        //! immediately follow it.
+        unsigned int mNumDescendants;
+    };
+
+    //! Positions in the stored data while recreating the DOM.
+    struct Cursor {
+        size_t mNode;
+        size_t mAttribute;
+        size_t mText;
+    };
+
+    //! The nodes in document order.
+    std::vector<Node> mNodes;
+
+    //! The attribute name indices and values of all element nodes in order.
+    std::vector<std::pair<unsigned short, std::string> > mAttributes;
+
+    //! The contents of all text nodes in order.
+    std::vector<std::string> mText;
+
+    void copyNode( const xercesc::DOMNode* aNode );
+
+    xercesc::DOMNode* createDOMNode( xercesc::DOMDocument* aDocument, Cursor& aCursor ) const;
+};
+
+#endif // _XML_FRAGMENT_H_
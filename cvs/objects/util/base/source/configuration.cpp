@@ -42,6 +42,7 @@
 #include "util/base/include/definitions.h"
 #include <string>
 #include <map>
+#include <algorithm>
 #include <iostream>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
@@ -119,6 +120,9 @@ bool Configuration::XMLParse( const DOMNode* root ) {
 			}
             else if( sectionName == "ScenarioComponents" ){
                 scenarioComponents.push_back( XMLHelper<string>::getValue( currValueNode ) );
+            }
+            else if( sectionName == "ParameterValues" ){
+                mParameterValues.push_back( make_pair( valueName, XMLHelper<double>::getValue( currValueNode ) ) );
             }
 			else {
                 ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -183,6 +187,13 @@ void Configuration::toDebugXML( ostream& out, Tabs* tabs ) const {
 		XMLWriteElement( *scenIter, "Value", out, tabs );
 	}
     XMLWriteClosingTag( "ScenarioComponents", out, tabs );
+
+    // Write ParameterValues.
+    XMLWriteOpeningTag( "ParameterValues", out, tabs );
+	for ( list<pair<string, double> >::const_iterator paramIter = mParameterValues.begin(); paramIter != mParameterValues.end(); ++paramIter ) {
+		XMLWriteElement( paramIter->second, "Value", out, tabs, 0, paramIter->first );
+	}
+    XMLWriteClosingTag( "ParameterValues", out, tabs );
     
     XMLWriteClosingTag( "Configuration", out, tabs );
 }
@@ -267,6 +278,21 @@ bool Configuration::shouldAppendScnToFile( const string& aKey, const bool aDefau
     }
 }
 
+/*!
+ * \brief Set that the scenario name should be post-pended to the filenames of
+ *        all files except the given ones.
+ * \details Used by processes which run scenarios concurrently so that each
+ *          writes its own files.
+ * \param aSharedKeys Keys of the files which are shared by all scenarios.
+ */
+void Configuration::appendScnToAllFiles( const list<string>& aSharedKeys ) {
+    for( map<string,string>::const_iterator fileIter = fileMap.begin(); fileIter != fileMap.end(); ++fileIter ) {
+        if( find( aSharedKeys.begin(), aSharedKeys.end(), fileIter->first ) == aSharedKeys.end() ) {
+            mShouldAppendScnFileMap[ fileIter->first ] = true;
+        }
+    }
+}
+
 /*! 
 * \brief Fetch a string from the Configuration object.
 * 
@@ -398,3 +424,24 @@ double Configuration::getDouble( const string& key, const double defaultValue, c
 const list<string>& Configuration::getScenarioComponents() const {
     return scenarioComponents;
 }
+
+/*!
+* \brief Fetch the list of parameter values to set into each scenario.
+* \details These are read from the ParameterValues section, where each value
+*          is named by the path to the data to set, and from any parameter
+*          values files given on the command line.
+* \return A list of parameter paths and the values to set.
+* \see SetDataHelper
+*/
+const list<pair<string, double> >& Configuration::getParameterValues() const {
+    return mParameterValues;
+}
+
+/*!
+* \brief Add a parameter value to set into each scenario.
+* \param aPath The path to the data to set.
+* \param aValue The value to set.
+*/
+void Configuration::addParameterValue( const string& aPath, const double aValue ) {
+    mParameterValues.push_back( make_pair( aPath, aValue ) );
+}
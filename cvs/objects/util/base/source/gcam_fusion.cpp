@@ -52,7 +52,8 @@
  *            - The second and third element (must exist unless Filter is NoFilter) is a
  *              predicate and the value to match in the predicate.
  * \param aFilterStepStr A string to parse into a FilterStep.
- * \return A new FilterStep parsed from aFilterStepStr using the rules above.
+ * \return A new FilterStep parsed from aFilterStepStr using the rules above or null
+ *         if the filter is not valid.
  */
 FilterStep* parseFilterStepStr( const std::string& aFilterStepStr ) {
     auto openBracketIter = std::find( aFilterStepStr.begin(), aFilterStepStr.end(), '[' );
@@ -65,6 +66,12 @@ FilterStep* parseFilterStepStr( const std::string& aFilterStepStr ) {
         std::string filterStr( openBracketIter + 1, std::find( openBracketIter, aFilterStepStr.end(), ']' ) );
         std::vector<std::string> filterOptions;
         boost::split( filterOptions, filterStr, boost::is_any_of( "," ) );
+        if( filterOptions.size() < 3 ) {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Invalid filter: " << filterStr << std::endl;
+            return 0;
+        }
         // [0] = filter type (name, year, index)
         // [1] = match type
         // [2:] = match type options
@@ -94,6 +101,7 @@ FilterStep* parseFilterStepStr( const std::string& aFilterStepStr ) {
             ILogger& mainLog = ILogger::getLogger( "main_log" );
             mainLog.setLevel( ILogger::WARNING );
             mainLog << "Unknown subclass of AMatchesValue: " << filterOptions[ 1 ] << std::endl;
+            return 0;
         }
         
         FilterStep* filterStep = 0;
@@ -110,6 +118,7 @@ FilterStep* parseFilterStepStr( const std::string& aFilterStepStr ) {
             ILogger& mainLog = ILogger::getLogger( "main_log" );
             mainLog.setLevel( ILogger::WARNING );
             mainLog << "Unknown filter: " << filterOptions[ 0 ] << std::endl;
+            delete matcher;
         }
         return filterStep;
     }
@@ -39,7 +39,18 @@
  */
 
 #include <cstring>
+#include <cstdlib>
 #include <fstream>
+#include <sstream>
+#include <unordered_set>
+#include <map>
+#include <vector>
+#include <thread>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sched.h>
+#include <pthread.h>
+#endif
 
 #include "util/base/include/manage_state_variables.hpp"
 #include "util/base/include/value.h"
@@ -48,9 +59,12 @@
 #include "util/base/include/configuration.h"
 #include "util/base/include/gcam_fusion.hpp"
 #include "util/base/include/gcam_data_containers.h"
+#include "marketplace/include/marketplace.h"
+#include "marketplace/include/market.h"
 
 #if GCAM_PARALLEL_ENABLED
 #include <tbb/concurrent_queue.h>
+#include <tbb/spin_mutex.h>
 #include <tbb/task_scheduler_init.h>
 #endif
 
@@ -58,6 +72,13 @@ using namespace std;
 
 extern Scenario* scenario;
 
+//! Identifies a restart file, the trailing digit is the restart format version.
+#define RESTART_MAGIC 0x32545345524d4143ULL
+
+//! The version of the layout of the state slots.  Increment when the order in
+//! which state is laid out changes so old restart files are rejected.
+#define RESTART_LAYOUT_VERSION 2
+
 // Note we must static initialize static class member variables in a cpp file and
 // since Value is header only and these particular fields are just as related to
 // ManageStateVariables it seems appropriate to initialize them to NULL here.
@@ -70,6 +91,112 @@ double* Value::sBaseCentralValue( 0 );
 #define NUM_STATES 2
 #endif
 
+namespace {
+    //! The alignment used for state slots when huge pages are requested.
+    const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+}
+
+#if GCAM_PARALLEL_ENABLED && defined(__linux__)
+/*!
+ * \brief Pins each worker thread of an arena to a CPU so that the state slot it
+ *        first touches stays on its NUMA node.
+ * \details The CPUs the process may run on are read from the node listing in
+ *          /sys and ordered round robin across the NUMA nodes so that the
+ *          workers and their memory traffic are spread over every socket.  On a
+ *          single node machine, or if the topology can not be read, no threads
+ *          are pinned.
+ */
+class ArenaAffinityObserver : public tbb::task_scheduler_observer {
+public:
+    ArenaAffinityObserver( tbb::task_arena& aArena ):
+    tbb::task_scheduler_observer( aArena )
+    {
+        sched_getaffinity( 0, sizeof( mProcessMask ), &mProcessMask );
+        vector<vector<int> > nodeCPUs;
+        for( int node = 0; ; ++node ) {
+            stringstream fileName;
+            fileName << "/sys/devices/system/node/node" << node << "/cpulist";
+            ifstream cpuList( fileName.str().c_str() );
+            if( !cpuList ) {
+                break;
+            }
+            nodeCPUs.push_back( parseCPUList( cpuList ) );
+        }
+        if( nodeCPUs.size() > 1 ) {
+            for( size_t i = 0; ; ++i ) {
+                bool hasMore = false;
+                for( auto& cpus : nodeCPUs ) {
+                    if( i < cpus.size() ) {
+                        hasMore = true;
+                        mCPUs.push_back( cpus[ i ] );
+                    }
+                }
+                if( !hasMore ) {
+                    break;
+                }
+            }
+        }
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::DEBUG );
+        mainLog << "Found " << nodeCPUs.size() << " NUMA nodes, pinning workers to "
+                << mCPUs.size() << " CPUs." << endl;
+        if( !mCPUs.empty() ) {
+            observe( true );
+        }
+    }
+
+    ~ArenaAffinityObserver() {
+        observe( false );
+    }
+
+    virtual void on_scheduler_entry( bool aIsWorker ) {
+        const int index = tbb::this_task_arena::current_thread_index();
+        if( index >= 0 ) {
+            cpu_set_t mask;
+            CPU_ZERO( &mask );
+            CPU_SET( mCPUs[ index % mCPUs.size() ], &mask );
+            pthread_setaffinity_np( pthread_self(), sizeof( mask ), &mask );
+        }
+    }
+
+    virtual void on_scheduler_exit( bool aIsWorker ) {
+        // Let the thread run anywhere once it leaves the arena, in particular
+        // the main thread.
+        pthread_setaffinity_np( pthread_self(), sizeof( mProcessMask ), &mProcessMask );
+    }
+
+private:
+    //! The CPUs to pin to by arena slot ordered round robin across the nodes.
+    vector<int> mCPUs;
+
+    //! The CPUs the process was allowed to run on.
+    cpu_set_t mProcessMask;
+
+    //! Parse a list such as 0-11,24-35 keeping only the CPUs in mProcessMask.
+    vector<int> parseCPUList( istream& aIn ) const {
+        vector<int> cpus;
+        string range;
+        while( getline( aIn, range, ',' ) ) {
+            int first = 0;
+            int last = 0;
+            const int numRead = sscanf( range.c_str(), "%d-%d", &first, &last );
+            if( numRead < 1 ) {
+                continue;
+            }
+            if( numRead == 1 ) {
+                last = first;
+            }
+            for( int cpu = first; cpu <= last; ++cpu ) {
+                if( cpu < CPU_SETSIZE && CPU_ISSET( cpu, &mProcessMask ) ) {
+                    cpus.push_back( cpu );
+                }
+            }
+        }
+        return cpus;
+    }
+};
+#endif
+
 #if GCAM_PARALLEL_ENABLED
 /*!
  * \brief A helper functor to assign a state slot in ManageStateVariables::mStateData
@@ -79,6 +206,9 @@ double* Value::sBaseCentralValue( 0 );
  *        from with in the Value class.
  */
 struct AssignThreadStateFun {
+    //! The state manager which owns the slots.
+    ManageStateVariables* mParent;
+    
     //! A reference to ManageStateVariables::mStateData.
     double** mArr;
     
@@ -91,7 +221,8 @@ struct AssignThreadStateFun {
     tbb::concurrent_queue<int> mThreadStateIndex;
     
     //! Constructor
-    AssignThreadStateFun( double** aArr, const int aMaxStates ):mArr( aArr ), mMaxStates( aMaxStates ) {
+    AssignThreadStateFun( ManageStateVariables* aParent, double** aArr, const int aMaxStates ):
+    mParent( aParent ), mArr( aArr ), mMaxStates( aMaxStates ) {
         // initialize the state index slots starting from 1 as 0 is always the
         // "base" state.
         for( int i = 1; i < mMaxStates; ++i ) {
@@ -104,10 +235,23 @@ struct AssignThreadStateFun {
      *        storage Value::sCentralValue for the first time.  It will assign a unique
      *        slot into ManageStateVariables::sCentralValue for this thread to use
      *        for the duration of it's calculations.
+     *        When the state is NUMA aware a thread is given the slot it used last
+     *        time if no other thread has been assigned it yet, so that it keeps
+     *        using the memory it first touched.  A slot is allocated here by the
+     *        first thread assigned it.
      * \return The unique slot of state that this thread can be guaranteed to use
      *         free from interference from any other thread.
      */
     double* operator()() {
+        if( mParent->mIsNumaAware ) {
+            const int slot = assignPreferredSlot();
+            // The slot is only ours until the end of this calculation so no lock
+            // is needed to allocate it.
+            if( !mArr[ slot ] ) {
+                mArr[ slot ] = mParent->allocateStateSlot();
+            }
+            return mArr[ slot ];
+        }
         int nextState;
         bool gotState = mThreadStateIndex.try_pop( nextState );
         if( !gotState ) {
@@ -119,6 +263,52 @@ struct AssignThreadStateFun {
         
         return mArr[ nextState ];
     }
+    
+    /*!
+     * \brief Assign this thread a slot no other thread has been assigned in this
+     *        calculation, preferring the one it was assigned previously.
+     * \details Slots are keyed by the thread id rather than the thread's index in
+     *          the arena since a thread may leave and rejoin with another index.
+     *          A thread without a usable slot takes a free one no other thread
+     *          prefers if there is one.
+     * \return The index into mStateData of the assigned slot.
+     */
+    int assignPreferredSlot() {
+        tbb::spin_mutex::scoped_lock lock( mParent->mSlotMutex );
+        vector<bool>& isAssigned = mParent->mIsSlotAssigned;
+        map<thread::id, int>& preferredSlot = mParent->mPreferredSlot;
+        const thread::id threadId = this_thread::get_id();
+        int slot = -1;
+        auto preferredIter = preferredSlot.find( threadId );
+        if( preferredIter != preferredSlot.end() && !isAssigned[ preferredIter->second ] ) {
+            slot = preferredIter->second;
+        }
+        else {
+            vector<bool> isPreferred( mMaxStates, false );
+            for( auto& preferred : preferredSlot ) {
+                isPreferred[ preferred.second ] = true;
+            }
+            for( int i = 1; i < mMaxStates && slot == -1; ++i ) {
+                if( !isAssigned[ i ] && !isPreferred[ i ] ) {
+                    slot = i;
+                }
+            }
+            for( int i = 1; i < mMaxStates && slot == -1; ++i ) {
+                if( !isAssigned[ i ] ) {
+                    slot = i;
+                }
+            }
+        }
+        if( slot == -1 ) {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::SEVERE );
+            mainLog << "Failed to get an unused state to assign to a worker thread." << endl;
+            abort();
+        }
+        isAssigned[ slot ] = true;
+        preferredSlot[ threadId ] = slot;
+        return slot;
+    }
 };
 #endif
 
@@ -129,17 +319,30 @@ struct AssignThreadStateFun {
  * \param aPeriod The model period to manage state in.
  */
 ManageStateVariables::ManageStateVariables( const int aPeriod ):
-#if !GCAM_PARALLEL_ENABLED
-mStateData( new double*[ NUM_STATES ] ),
-#else
+#if GCAM_PARALLEL_ENABLED
 mThreadPool(),
-mStateData( new double*[ NUM_STATES ] ),
 #endif
+mIsNumaAware( false ),
+mUseHugePages( false ),
+mStateData( new double*[ NUM_STATES ] ),
 mPeriodToCollect( aPeriod ),
 mYearToCollect( scenario->getModeltime()->getper_to_yr( aPeriod ) ),
 mCCStartYear( mYearToCollect - scenario->getModeltime()->gettimestep( aPeriod ) + 1 ),
-mNumCollected( 0 )
+mNumCollected( 0 ),
+mLayoutHash( 0 )
 {
+    const Configuration* conf = Configuration::getInstance();
+#if GCAM_PARALLEL_ENABLED
+    mIsNumaAware = conf->getBool( "numa-aware-state", false, false );
+#if defined(__linux__)
+    if( mIsNumaAware ) {
+        mAffinityObserver.reset( new ArenaAffinityObserver( mThreadPool ) );
+    }
+#endif
+#endif
+#if defined(__linux__)
+    mUseHugePages = conf->getBool( "state-huge-pages", false, false );
+#endif
     collectState();
 }
 
@@ -150,7 +353,7 @@ mNumCollected( 0 )
 ManageStateVariables::~ManageStateVariables() {
     resetState();
     for( size_t stateInd = 0; stateInd < NUM_STATES; ++stateInd ) {
-        delete[] mStateData[ stateInd ];
+        freeStateSlot( mStateData[ stateInd ] );
     }
     delete[] mStateData;
 #if !GCAM_PARALLEL_ENABLED
@@ -188,9 +391,12 @@ void ManageStateVariables::collectState() {
     ILogger& mainLog = ILogger::getLogger( "main_log" );
     mainLog.setLevel( ILogger::DEBUG );
     mainLog << "Number of active state values: " << mNumCollected << endl;
-    // Allocate space for each active state value for each state slot.
+    orderSolvableMarketsFirst();
+    // Allocate space for each active state value for each state slot.  When
+    // NUMA aware the "scratch" slots are instead allocated by the worker
+    // threads that use them.
     for( size_t stateInd = 0; stateInd < NUM_STATES; ++stateInd ) {
-        mStateData[ stateInd ] = new double[ mNumCollected ];
+        mStateData[ stateInd ] = stateInd == 0 || !mIsNumaAware ? allocateStateSlot() : 0;
     }
     
     // We can now initialize the static Value references into mStateData for fast
@@ -220,6 +426,84 @@ void ManageStateVariables::collectState() {
     }
 }
 
+/*!
+ * \brief Reorder the collected state so that the prices, solver demands, and
+ *        solver supplies of the markets which are solvable in this period occupy
+ *        contiguous blocks at the front of each state slot.
+ * \details The solver moves exactly these values in and out of the model on every
+ *          evaluation.  Packing them together keeps that gather / scatter within a
+ *          few cache lines rather than spread throughout the state arrays.  The
+ *          relative order of all other state is unchanged.
+ */
+void ManageStateVariables::orderSolvableMarketsFirst() {
+    vector<Value*> prices;
+    vector<Value*> demands;
+    vector<Value*> supplies;
+    const vector<Market*> markets = scenario->getMarketplace()->getMarketsToSolve( mPeriodToCollect );
+    for( auto market : markets ) {
+        if( market->isSolvable() ) {
+            prices.push_back( &market->mPrice );
+            demands.push_back( &market->mDemand );
+            // Some markets report their price as the solver supply in which case
+            // the price slot is already accounted for.
+            Value* supply = const_cast<Value*>( &market->getSolverSupplyState() );
+            if( supply != &market->mPrice ) {
+                supplies.push_back( supply );
+            }
+        }
+    }
+    vector<Value*> solvableState( prices );
+    solvableState.insert( solvableState.end(), demands.begin(), demands.end() );
+    solvableState.insert( solvableState.end(), supplies.begin(), supplies.end() );
+    
+    // Hash the layout version, the names of the solvable markets, and the size
+    // of each block so that restart files can check they were written with the
+    // same layout.  This is a simple FNV-1a hash.
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+    mLayoutHash = 14695981039346656037ULL;
+    auto hashValue = [this, FNV_PRIME] ( const uint64_t aValue ) {
+        for( int byte = 0; byte < 8; ++byte ) {
+            mLayoutHash = ( mLayoutHash ^ ( ( aValue >> ( byte * 8 ) ) & 0xff ) ) * FNV_PRIME;
+        }
+    };
+    hashValue( RESTART_LAYOUT_VERSION );
+    for( auto market : markets ) {
+        if( market->isSolvable() ) {
+            for( auto currChar : market->getName() ) {
+                mLayoutHash = ( mLayoutHash ^ static_cast<unsigned char>( currChar ) ) * FNV_PRIME;
+            }
+        }
+    }
+    hashValue( prices.size() );
+    hashValue( demands.size() );
+    hashValue( supplies.size() );
+    
+    // Only values which were actually collected as active state may be moved.
+    unordered_set<Value*> candidates( solvableState.begin(), solvableState.end() );
+    unordered_set<Value*> found;
+    vector<Value*> remaining;
+    remaining.reserve( mNumCollected );
+    for( auto currValue : mStateValues ) {
+        if( candidates.find( currValue ) != candidates.end() ) {
+            found.insert( currValue );
+        }
+        else {
+            remaining.push_back( currValue );
+        }
+    }
+    
+    vector<Value*> newOrder;
+    newOrder.reserve( mNumCollected );
+    for( auto currValue : solvableState ) {
+        if( found.find( currValue ) != found.end() ) {
+            newOrder.push_back( currValue );
+        }
+    }
+    newOrder.insert( newOrder.end(), remaining.begin(), remaining.end() );
+    assert( newOrder.size() == mNumCollected );
+    mStateValues.assign( newOrder.begin(), newOrder.end() );
+}
+
 /*!
  * \brief Copy the "base" state back into each corresponding Value object before
  *        we move on from this model period and release the state memory.
@@ -245,6 +529,43 @@ void ManageStateVariables::resetState() {
     }
 }
 
+/*!
+ * \brief Allocate a single state slot large enough for all collected state.
+ * \details The memory is not touched here so that under a first-touch policy
+ *          its pages are placed on the NUMA node of the thread which first
+ *          writes to it.  If mUseHugePages is set the slot is aligned to and
+ *          advised to use transparent huge pages.
+ * \return The new slot which must be released with freeStateSlot.
+ */
+double* ManageStateVariables::allocateStateSlot() const {
+    const size_t numBytes = max<size_t>( mNumCollected, 1 ) * sizeof( double );
+#if defined(__linux__)
+    if( mUseHugePages ) {
+        // Round up to whole huge pages so the advice only covers this slot.
+        const size_t numHugeBytes = ( numBytes + HUGE_PAGE_SIZE - 1 ) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        void* slot = 0;
+        if( posix_memalign( &slot, HUGE_PAGE_SIZE, numHugeBytes ) != 0 ) {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::SEVERE );
+            mainLog << "Failed to allocate " << numBytes << " bytes of state." << endl;
+            abort();
+        }
+        // The advice is only a hint, failure just means normal pages are used.
+        madvise( slot, numHugeBytes, MADV_HUGEPAGE );
+        return static_cast<double*>( slot );
+    }
+#endif
+    return static_cast<double*>( malloc( numBytes ) );
+}
+
+/*!
+ * \brief Release a slot allocated by allocateStateSlot.
+ * \param aSlot The slot to release which may be null.
+ */
+void ManageStateVariables::freeStateSlot( double* aSlot ) const {
+    free( aSlot );
+}
+
 /*!
  * \brief Copies the "base" state over the "scratch" space.
  * \details This method is typically called before starting a partial derivative
@@ -278,11 +599,52 @@ void ManageStateVariables::setPartialDeriv( const bool aIsPartialDeriv ) {
     else {
         // Use the AssignThreadStateFun helper functor to uniquely assign a state
         // slot to each worker thread.
-        Value::sCentralValue = Value::CentralValueType( AssignThreadStateFun( mStateData, NUM_STATES ) );
+        if( mIsNumaAware ) {
+            mIsSlotAssigned.assign( NUM_STATES, false );
+        }
+        Value::sCentralValue = Value::CentralValueType( AssignThreadStateFun( this, mStateData, NUM_STATES ) );
     }
 #endif
 }
 
+/*!
+ * \brief Get the positions of the given market's price, solver demand, and solver
+ *        supply within each state slot.
+ * \param aMarket A market of the period this instance manages.
+ * \return The indices of the market's state.
+ * \pre The market's price, demand, and supply were collected as active state.
+ */
+ManageStateVariables::MarketStateIndices ManageStateVariables::getMarketStateIndices( const Market* aMarket ) const {
+    const Value& supply = aMarket->getSolverSupplyState();
+    if( !aMarket->mPrice.mIsStateCopy || !aMarket->mDemand.mIsStateCopy || !supply.mIsStateCopy ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "The state of market " << aMarket->getName() << " was not collected for period "
+                << mPeriodToCollect << "." << endl;
+        abort();
+    }
+    MarketStateIndices indices;
+    indices.mPrice = aMarket->mPrice.mCentralValueIndex;
+    indices.mDemand = aMarket->mDemand.mCentralValueIndex;
+    indices.mSupply = supply.mCentralValueIndex;
+    return indices;
+}
+
+/*!
+ * \brief Get the state slot that Value objects currently read and write.
+ * \details This is the "base" state unless a partial derivative is being
+ *          calculated in which case it is the "scratch" space of the calling
+ *          thread.
+ * \return The currently active state slot.
+ */
+double* ManageStateVariables::getActiveState() const {
+#if !GCAM_PARALLEL_ENABLED
+    return Value::sCentralValue;
+#else
+    return Value::sCentralValue.local();
+#endif
+}
+
 /*!
  * \brief Generate the appropriate restart file name to use.
  * \details This method will append the model period this instance was created
@@ -303,7 +665,9 @@ string ManageStateVariables::getRestartFileName() const {
  * \brief Load a restart file from disk directly into the "base" state.
  * \warning Very little error checking is done to ensure the state read in was generated
  *          from the exact same scenario.  All we can do in terms of error checking is
- *          check that the size of the data coming in is exactly the same size as mNumCollected.
+ *          check that the file was written with the same state layout, including the
+ *          solvable markets which are placed first, and that the size of the data
+ *          coming in is exactly the same size as mNumCollected.
  * \sa ManageStateVariables::getRestartFileName
  * \sa ManageStateVariables::saveRestartFile
  */
@@ -319,6 +683,18 @@ void ManageStateVariables::loadRestartFile() {
         abort();
     }
     
+    uint64_t magic = 0;
+    uint64_t layoutHash = 0;
+    restartFile.read( reinterpret_cast<char*>( &magic ), sizeof( uint64_t ) );
+    restartFile.read( reinterpret_cast<char*>( &layoutHash ), sizeof( uint64_t ) );
+    if( !restartFile || magic != RESTART_MAGIC || layoutHash != mLayoutHash ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Restart file: " << restartFileName << " was written with a different state layout"
+                << " and must be regenerated." << endl;
+        abort();
+    }
+    
     size_t numStatesInRestart;
     restartFile.read( reinterpret_cast<char*>( &numStatesInRestart ), sizeof( size_t ) );
     if( numStatesInRestart != mNumCollected ) {
@@ -334,7 +710,7 @@ void ManageStateVariables::loadRestartFile() {
     if( !restartFile ) {
         ILogger& mainLog = ILogger::getLogger( "main_log" );
         mainLog.setLevel( ILogger::SEVERE );
-        mainLog << "Restart file: " << restartFileName << " has fewer states than expected, read: " << static_cast<size_t>( (restartFile.gcount() - sizeof(size_t)) / sizeof(double))
+        mainLog << "Restart file: " << restartFileName << " has fewer states than expected, read: " << static_cast<size_t>( restartFile.gcount() / sizeof(double))
                 << ", expected: " << numStatesInRestart << endl;
         abort();
     }
@@ -350,8 +726,10 @@ void ManageStateVariables::loadRestartFile() {
 
 /*!
  * \brief Dump the contents of the "base" state array into a binary restart file.
- * \details The first value written is mNumCollected (size written: size_t) to help with do some error checking
- *          when we try to read it back in.  Then we just write the entire content of mStateData[0]
+ * \details The file starts with RESTART_MAGIC and mLayoutHash (size written: 2 * uint64_t) so that
+ *          files written with a different state layout are rejected.  Next mNumCollected
+ *          (size written: size_t) to help with do some error checking when we try to read it
+ *          back in.  Then we just write the entire content of mStateData[0]
  *          (size written: double * mNumCollected).
  * \sa ManageStateVariables::getRestartFileName
  */
@@ -369,6 +747,11 @@ void ManageStateVariables::saveRestartFile() {
         abort();
     }
     
+    // write the header identifying the state layout
+    uint64_t magic = RESTART_MAGIC;
+    restartFile.write( reinterpret_cast<char*>( &magic ), sizeof( uint64_t ) );
+    restartFile.write( reinterpret_cast<char*>( &mLayoutHash ), sizeof( uint64_t ) );
+    
     // first write the total number of entries that should be expected to help with error
     // checking on read in
     restartFile.write( reinterpret_cast<char*>( &mNumCollected ), sizeof( size_t ) );
@@ -0,0 +1,302 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+ * \file set_data_helper.cpp
+ * \ingroup util
+ * \brief SetDataHelper class source file.
+ */
+
+#include <fstream>
+
+#include "util/base/include/definitions.h"
+#include "util/base/include/set_data_helper.hpp"
+#include "util/base/include/value.h"
+#include "util/base/include/gcam_fusion.hpp"
+#include "util/base/include/gcam_data_containers.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+
+/*!
+ * \brief Constructor which parses the given parameter paths.
+ * \param aParameterValues A list of parameter paths and the value to set.
+ */
+SetDataHelper::SetDataHelper( const list<pair<string, double> >& aParameterValues ):
+mHasInvalidPath( false ),
+mCurrValue( 0 ),
+mNumSet( 0 ),
+mCurrMACControl( 0 )
+{
+    for( auto currParam : aParameterValues ) {
+        addParameterValue( currParam.first, currParam.second );
+    }
+}
+
+//! Destructor
+SetDataHelper::~SetDataHelper() {
+    for( auto param : mParameterValues ) {
+        for( auto filterStep : param->mFilterSteps ) {
+            delete filterStep;
+        }
+        delete param;
+    }
+}
+
+/*!
+ * \brief Parse a parameter path into FilterSteps and add it to the parameters
+ *        to set.
+ * \details A path which can not be parsed is reported and not added, run will
+ *          then also report the failure.
+ * \param aPath The path to the data to set.
+ * \param aValue The value to set.
+ * \return Whether the path could be parsed.
+ */
+bool SetDataHelper::addParameterValue( const string& aPath, const double aValue ) {
+    ParameterValue* param = new ParameterValue();
+    param->mPath = aPath;
+    param->mValue = aValue;
+    try {
+        param->mFilterSteps = parseFilterString( aPath );
+    }
+    catch( const boost::bad_lexical_cast& ) {
+        // an int filter was given a value which is not a number
+        param->mFilterSteps.push_back( 0 );
+    }
+    if( param->mFilterSteps.empty() || find( param->mFilterSteps.begin(), param->mFilterSteps.end(), static_cast<FilterStep*>( 0 ) ) != param->mFilterSteps.end() ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Could not parse parameter path " << aPath << "." << endl;
+        for( auto filterStep : param->mFilterSteps ) {
+            delete filterStep;
+        }
+        delete param;
+        mHasInvalidPath = true;
+        return false;
+    }
+    mParameterValues.push_back( param );
+    return true;
+}
+
+/*!
+ * \brief Read the parameters in a CSV file and add them to the parameters to set.
+ * \param aFileName The CSV file name.
+ * \return Whether the file could be read and all of its paths parsed.
+ * \see readCSV
+ */
+bool SetDataHelper::parseCSV( const string& aFileName ) {
+    list<pair<string, double> > parameterValues;
+    bool success = readCSV( aFileName, parameterValues );
+    for( auto currParam : parameterValues ) {
+        success &= addParameterValue( currParam.first, currParam.second );
+    }
+    return success;
+}
+
+/*!
+ * \brief Set all of the parameters into the given scenario.
+ * \details The parameters are set in the order they were added so that later
+ *          parameters take precedence where they overlap.  An error is given
+ *          for any parameter that did not match any data.
+ * \param aScenario The scenario to set the parameters into.
+ * \return Whether every parameter path was parsed and set at least once.
+ */
+bool SetDataHelper::run( Scenario* aScenario ) {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    bool success = !mHasInvalidPath;
+    for( auto param : mParameterValues ) {
+        mCurrValue = param->mValue;
+        mNumSet = 0;
+        GCAMFusion<SetDataHelper, true, true, true> setData( *this, param->mFilterSteps );
+        setData.startFilter( aScenario );
+
+        if( mNumSet == 0 ) {
+            mainLog.setLevel( ILogger::ERROR );
+            mainLog << "Parameter " << param->mPath << " did not match any data." << endl;
+            success = false;
+        }
+        else {
+            mainLog.setLevel( ILogger::DEBUG );
+            mainLog << "Set " << mNumSet << " values of parameter " << param->mPath
+                    << " to " << param->mValue << "." << endl;
+        }
+    }
+    return success;
+}
+
+/*!
+ * \brief Whether the given file name should be read as a CSV of parameter values
+ *        instead of an XML input file.
+ * \param aFileName The file name to check.
+ * \return True if the file name ends with .csv.
+ */
+bool SetDataHelper::isCSVFile( const string& aFileName ) {
+    return boost::iends_with( aFileName, ".csv" );
+}
+
+/*!
+ * \brief Read parameter paths and values from a CSV file.
+ * \details Each line is a parameter path and the value to set separated by a
+ *          comma.  Since the paths may contain commas the value is taken from
+ *          the last comma on the line.  Blank lines and those starting with #
+ *          are skipped as is a first line whose value is not a number so that
+ *          the file may have a header.
+ * \param aFileName The CSV file name.
+ * \param aParameterValues The list to which the parameters will be appended.
+ * \return Whether the file could be read.
+ */
+bool SetDataHelper::readCSV( const string& aFileName, list<pair<string, double> >& aParameterValues ) {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    ifstream inputFile( aFileName.c_str() );
+    if( !inputFile.is_open() ) {
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Could not open parameter values file " << aFileName << "." << endl;
+        return false;
+    }
+
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Reading parameter values from " << aFileName << "." << endl;
+    string line;
+    bool isFirstLine = true;
+    while( getline( inputFile, line ) ) {
+        boost::trim( line );
+        if( line.empty() || line[ 0 ] == '#' ) {
+            continue;
+        }
+        const size_t sepPos = line.rfind( ',' );
+        string path = sepPos == string::npos ? line : line.substr( 0, sepPos );
+        string valueStr = sepPos == string::npos ? string() : line.substr( sepPos + 1 );
+        boost::trim( path );
+        boost::trim( valueStr );
+        try {
+            aParameterValues.push_back( make_pair( path, boost::lexical_cast<double>( valueStr ) ) );
+        }
+        catch( const boost::bad_lexical_cast& ) {
+            if( !isFirstLine ) {
+                mainLog.setLevel( ILogger::WARNING );
+                mainLog << "Skipping invalid line in " << aFileName << ": " << line << endl;
+            }
+        }
+        isFirstLine = false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Set every element of an array to the current value.
+ * \param aArray The array to set.
+ */
+template<typename ArrayType>
+void SetDataHelper::setArray( ArrayType& aArray ) {
+    for( auto iter = aArray.begin(); iter != aArray.end(); ++iter ) {
+        processData( *iter );
+    }
+}
+
+template<typename DataType>
+void SetDataHelper::processData( DataType& aData ) {
+    // ignore data that is not numerical
+}
+
+template<>
+void SetDataHelper::processData<double>( double& aData ) {
+    aData = mCurrValue;
+    ++mNumSet;
+}
+
+template<>
+void SetDataHelper::processData<Value>( Value& aData ) {
+    aData = mCurrValue;
+    ++mNumSet;
+}
+
+template<>
+void SetDataHelper::processData<vector<double> >( vector<double>& aData ) {
+    setArray( aData );
+}
+
+template<>
+void SetDataHelper::processData<vector<Value> >( vector<Value>& aData ) {
+    setArray( aData );
+}
+
+template<>
+void SetDataHelper::processData<objects::PeriodVector<double> >( objects::PeriodVector<double>& aData ) {
+    setArray( aData );
+}
+
+template<>
+void SetDataHelper::processData<objects::PeriodVector<Value> >( objects::PeriodVector<Value>& aData ) {
+    setArray( aData );
+}
+
+template<>
+void SetDataHelper::processData<objects::YearVector<double> >( objects::YearVector<double>& aData ) {
+    setArray( aData );
+}
+
+template<>
+void SetDataHelper::processData<objects::YearVector<Value> >( objects::YearVector<Value>& aData ) {
+    setArray( aData );
+}
+
+template<typename DataType>
+void SetDataHelper::pushFilterStep( const DataType& aData ) {
+    // ignore most steps
+}
+
+template<typename DataType>
+void SetDataHelper::popFilterStep( const DataType& aData ) {
+    // ignore most steps
+}
+
+template<>
+void SetDataHelper::pushFilterStep<AEmissionsControl*>( AEmissionsControl* const& aData ) {
+    // Keep track of the control which owns any MAC curve stepped into next.
+    mCurrMACControl = dynamic_cast<MACControl*>( aData );
+}
+
+template<>
+void SetDataHelper::popFilterStep<AEmissionsControl*>( AEmissionsControl* const& aData ) {
+    mCurrMACControl = 0;
+}
+
+template<>
+void SetDataHelper::pushFilterStep<PointSetCurve*>( PointSetCurve* const& aData ) {
+    // The MAC curve is shared between copies of a MACControl so have the
+    // control make a private copy before any of its points are set.  This
+    // updates the curve pointer GCAMFusion is about to step into.
+    if( mCurrMACControl ) {
+        mCurrMACControl->getMutableMacCurve();
+    }
+}
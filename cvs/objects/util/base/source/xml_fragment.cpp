@@ -0,0 +1,210 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file xml_fragment.cpp
+* \ingroup Objects
+* \brief XMLFragment class source file.
+* \author Pralit Patel
+*/
+
+#include "util/base/include/definitions.h"
+#include <map>
+#include <cassert>
+#include <xercesc/dom/DOMNodeList.hpp>
+#include <xercesc/dom/DOMNamedNodeMap.hpp>
+#include <xercesc/dom/DOMElement.hpp>
+#include <xercesc/dom/DOMText.hpp>
+#include <xercesc/util/XMLString.hpp>
+
+#include "util/base/include/xml_fragment.h"
+#include "util/base/include/xml_helper.h"
+
+using namespace std;
+using namespace xercesc;
+
+namespace {
+    /*!
+     * \brief The names of elements and attributes seen in any fragment.
+     * \details Fragments typically repeat the same few dozen names many
+     *          thousands of times so they are stored once and referred to
+     *          by index.
+     */
+    class NameTable {
+    public:
+        unsigned short getIndex( const string& aName ) {
+            map<string, unsigned short>::const_iterator iter = mIndices.find( aName );
+            if( iter != mIndices.end() ) {
+                return iter->second;
+            }
+            assert( mNames.size() < 0xFFFF );
+            const unsigned short index = static_cast<unsigned short>( mNames.size() );
+            mIndices[ aName ] = index;
+            mNames.push_back( aName );
+            return index;
+        }
+
+        const string& getName( const unsigned short aIndex ) const {
+            return mNames[ aIndex ];
+        }
+
+        static NameTable& getInstance() {
+            static NameTable instance;
+            return instance;
+        }
+
+    private:
+        vector<string> mNames;
+        map<string, unsigned short> mIndices;
+    };
+
+    /*!
+     * \brief Holds a string transcoded for xerces for the duration of a scope.
+     */
+    class TranscodedString {
+    public:
+        explicit TranscodedString( const string& aString ):
+        mString( XMLString::transcode( aString.c_str() ) )
+        {
+        }
+
+        ~TranscodedString() {
+            XMLString::release( &mString );
+        }
+
+        const XMLCh* get() const {
+            return mString;
+        }
+
+    private:
+        XMLCh* mString;
+
+        TranscodedString( const TranscodedString& );
+        TranscodedString& operator=( const TranscodedString& );
+    };
+}
+
+/*!
+ * \brief Constructor which copies the subtree rooted at aNode.
+ * \param aNode The element to copy.
+ */
+XMLFragment::XMLFragment( const DOMNode* aNode ) {
+    /*! \pre Make sure we were passed a valid node. */
+    assert( aNode );
+    copyNode( aNode );
+}
+
+/*!
+ * \brief Append aNode and its subtree to the stored nodes.
+ * \param aNode The node to copy.
+ */
+void XMLFragment::copyNode( const DOMNode* aNode ) {
+    NameTable& names = NameTable::getInstance();
+    const size_t nodeIndex = mNodes.size();
+    Node node;
+    node.mNumAttributes = 0;
+    node.mNumDescendants = 0;
+
+    // Text and CDATA are both recreated as text which parses identically.
+    if( aNode->getNodeType() != DOMNode::ELEMENT_NODE ) {
+        node.mName = names.getIndex( XMLHelper<void>::text() );
+        mText.push_back( XMLHelper<string>::safeTranscode( aNode->getNodeValue() ) );
+        mNodes.push_back( node );
+        return;
+    }
+
+    node.mName = names.getIndex( XMLHelper<string>::safeTranscode( aNode->getNodeName() ) );
+    const DOMNamedNodeMap* attributes = aNode->getAttributes();
+    for( XMLSize_t i = 0; attributes && i < attributes->getLength(); ++i ) {
+        const DOMNode* attribute = attributes->item( i );
+        mAttributes.push_back( make_pair(
+            names.getIndex( XMLHelper<string>::safeTranscode( attribute->getNodeName() ) ),
+            XMLHelper<string>::safeTranscode( attribute->getNodeValue() ) ) );
+        ++node.mNumAttributes;
+    }
+    mNodes.push_back( node );
+
+    const DOMNodeList* children = aNode->getChildNodes();
+    for( XMLSize_t i = 0; i < children->getLength(); ++i ) {
+        const DOMNode* child = children->item( i );
+        const short childType = child->getNodeType();
+        if( childType == DOMNode::ELEMENT_NODE || childType == DOMNode::TEXT_NODE ||
+            childType == DOMNode::CDATA_SECTION_NODE )
+        {
+            copyNode( child );
+        }
+    }
+    mNodes[ nodeIndex ].mNumDescendants = static_cast<unsigned int>( mNodes.size() - nodeIndex - 1 );
+}
+
+/*!
+ * \brief Recreate the fragment as a DOM subtree.
+ * \param aDocument The document which will own the created nodes.  The caller
+ *        is responsible for releasing it once the nodes are no longer needed.
+ * \return The root of the recreated subtree.
+ */
+DOMNode* XMLFragment::createDOMNode( DOMDocument* aDocument ) const {
+    Cursor cursor = { 0, 0, 0 };
+    return createDOMNode( aDocument, cursor );
+}
+
+/*!
+ * \brief Recreate the node at the cursor and its subtree.
+ * \param aDocument The document which will own the created nodes.
+ * \param aCursor The positions of the node to create which will be advanced
+ *        past its subtree.
+ * \return The created node.
+ */
+DOMNode* XMLFragment::createDOMNode( DOMDocument* aDocument, Cursor& aCursor ) const {
+    const NameTable& names = NameTable::getInstance();
+    const Node& node = mNodes[ aCursor.mNode++ ];
+    const string& nodeName = names.getName( node.mName );
+    if( nodeName == XMLHelper<void>::text() ) {
+        TranscodedString text( mText[ aCursor.mText++ ] );
+        return aDocument->createTextNode( text.get() );
+    }
+
+    TranscodedString elementName( nodeName );
+    DOMElement* element = aDocument->createElement( elementName.get() );
+    for( unsigned short i = 0; i < node.mNumAttributes; ++i, ++aCursor.mAttribute ) {
+        TranscodedString attributeName( names.getName( mAttributes[ aCursor.mAttribute ].first ) );
+        TranscodedString attributeValue( mAttributes[ aCursor.mAttribute ].second );
+        element->setAttribute( attributeName.get(), attributeValue.get() );
+    }
+
+    const size_t subtreeEnd = aCursor.mNode + node.mNumDescendants;
+    while( aCursor.mNode < subtreeEnd ) {
+        element->appendChild( createDOMNode( aDocument, aCursor ) );
+    }
+    return element;
+}
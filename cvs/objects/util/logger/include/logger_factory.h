@@ -69,6 +69,7 @@ public:
     static Logger& getLogger( const std::string& aLogName );
     static void toDebugXML( std::ostream& aOut, Tabs* aTabs );
     static void logNewScenarioStarting( const std::string& aScenarioName );
+    static void flushLoggers();
 private:
     static std::map<std::string,Logger*> mLoggers; //!< Map of logger names to loggers.
     static void XMLParse( const xercesc::DOMNode* aRoot );
@@ -117,6 +117,17 @@ Logger& LoggerFactory::getLogger( const string& aLoggerName ) {
 	}
 }
 
+/*!
+ * \brief Write any output buffered by the loggers to their files.
+ * \details This must be called before forking so that the buffered output is
+ *          not written by both processes.
+ */
+void LoggerFactory::flushLoggers() {
+	for( map<string,Logger*>::const_iterator logIter = mLoggers.begin(); logIter != mLoggers.end(); ++logIter ){
+		logIter->second->flushFile();
+	}
+}
+
 //! Cleans up the logger.
 void LoggerFactory::cleanUp() {
 	for( map<string,Logger*>::iterator logIter = mLoggers.begin(); logIter != mLoggers.end(); logIter++ ){
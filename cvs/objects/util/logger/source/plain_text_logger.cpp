@@ -73,6 +73,11 @@ void PlainTextLogger::close(){
     mLogFile.close();
 }
 
+//! Writes any buffered output to the file.
+void PlainTextLogger::flushFile(){
+    mLogFile.flush();
+}
+
 //! Logs a single message.
 void PlainTextLogger::logCompleteMessage( const string& aMessage ){
     // Decide whether to print the message
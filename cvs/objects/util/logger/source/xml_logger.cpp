@@ -78,6 +78,11 @@ void XMLLogger::close(){
 	mLogFile.close();
 }
 
+//! Writes any buffered output to the file.
+void XMLLogger::flushFile(){
+	mLogFile.flush();
+}
+
 //! Logs a single message.
 void XMLLogger::logCompleteMessage( const string& aMessage ){
 	// Decide whether to print the message